@@ -0,0 +1,361 @@
+#include <fcntl.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../server/server_auction.hpp"
+#include "../server/server_user.hpp"
+
+// Times the AuctionManager calls the AS makes the most, against an AS-DB
+// generated with the given numbers of users, auctions and bids per auction:
+//   auction_manager [-u users] [-a auctions] [-b bids] [-p passes] [-d dir]
+// Every call is made once per user or auction with a cold AS, which has none
+// of the AS-DB in memory nor in the page cache, and then for a few more passes
+// with a warm one. Every call runs in a process of its own, so it is cold when
+// it starts, and is run once more under ptrace to count its system calls. The
+// page cache is only dropped for the files, so the directories stay cached,
+// and it is not dropped at all if the AS-DB is on a tmpfs.
+
+#define BENCH_START_VALUE 100 // of every auction, the bids are above it
+#define BENCH_TIME_ACTIVE 99999
+
+static uint32_t users = 100;
+static uint32_t auctions = 100; // at most AUCTION_ID_MAX
+static uint32_t bidsPerAuction = 10;
+static uint32_t passes = 3; // warm ones, after the cold one
+
+// bids placed on every auction, by the children that are done too
+static uint32_t bidsPlaced;
+
+static AuctionManager auctionManager;
+static UserManager userManager;
+
+static std::string userID(uint32_t user) {
+  return std::to_string(100000 + user);
+}
+
+static std::string auctionID(uint32_t auction) {
+  return intToStringWithZeros((int)auction + 1, AUCTION_ID_LENGTH);
+}
+
+/**
+ * @brief Gets the user who places a bid on an auction, who is never its
+ * owner, as the owner of auction a is user a % users.
+ *
+ * @param auction the auction
+ * @param bid the number of bids placed on the auction before
+ * @return the user
+ */
+static uint32_t bidderOf(uint32_t auction, uint32_t bid) {
+  return (auction + 1 + bid % (users - 1)) % users;
+}
+
+/**
+ * @brief Creates the AS-DB in the working directory, as the AS would, and
+ * fills it through the AuctionManager.
+ */
+static void generateDB() {
+  create_new_directory(AS_DIR);
+  create_new_directory(USER_DIR);
+  create_new_directory(AUCTION_DIR);
+  create_new_directory(ARCHIVE_DIR);
+  write_to_file(AUCTION_DIR + SLASH + NEXT_AUCTION_FILE, "1\n");
+
+  for (uint32_t user = 0; user < users; user++) {
+    userManager.registerUser(userID(user), "password");
+  }
+  for (uint32_t auction = 0; auction < auctions; auction++) {
+    create_new_directory("upload");
+    write_to_file("upload/asset.png", std::string(1024, 'a'));
+    auctionManager.openAuction(userID(auction % users), "auction",
+                               BENCH_START_VALUE, BENCH_TIME_ACTIVE,
+                               "asset.png", "upload/asset.png");
+    for (uint32_t bid = 0; bid < bidsPerAuction; bid++) {
+      auctionManager.bidOnAuction(userID(bidderOf(auction, bid)), "password",
+                                  auctionID(auction),
+                                  BENCH_START_VALUE + 1 + bid);
+    }
+  }
+}
+
+/**
+ * @brief Drops the files of the AS-DB from the page cache.
+ */
+static void evictDB() {
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(AS_DIR)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    int fd = open(entry.path().c_str(), O_RDONLY);
+    if (fd == -1) {
+      continue;
+    }
+    fdatasync(fd); // dirty pages are not dropped
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+struct Operation {
+  const char *name;
+  uint32_t *keys; // the users or auctions it is called for in every pass
+  void (*call)(uint32_t key, uint32_t pass);
+};
+
+static uint32_t once = 1;
+
+static const Operation OPERATIONS[] = {
+    {"listAuctions", &once,
+     [](uint32_t, uint32_t) { auctionManager.listAuctions(); }},
+    {"listUserAuctions", &users,
+     [](uint32_t user, uint32_t) {
+       auctionManager.listUserAuctions(userID(user));
+     }},
+    {"getAuctionsBiddedByUser", &users,
+     [](uint32_t user, uint32_t) {
+       auctionManager.getAuctionsBiddedByUser(userID(user));
+     }},
+    {"getAuctionRecord", &auctions,
+     [](uint32_t auction, uint32_t) {
+       auctionManager.getAuctionRecord(auctionID(auction));
+     }},
+    {"getLargestBid", &auctions,
+     [](uint32_t auction, uint32_t) {
+       auctionManager.getLargestBid(auctionID(auction));
+     }},
+    // last, as it adds a bid to every auction in every pass
+    {"bidOnAuction", &auctions,
+     [](uint32_t auction, uint32_t pass) {
+       uint32_t bid = bidsPlaced + pass;
+       auctionManager.bidOnAuction(userID(bidderOf(auction, bid)), "password",
+                                   auctionID(auction),
+                                   BENCH_START_VALUE + 1 + bid);
+     }},
+};
+
+/**
+ * @brief Marks the end of a phase for the tracer, with a system call that
+ * nothing else makes.
+ */
+static void mark() { syscall(SYS_getppid); }
+
+/**
+ * @brief Calls an operation once cold and then warm, in a child process.
+ *
+ * @param operation the operation
+ * @param seconds where to store the seconds the cold and warm calls took
+ */
+static void callOperation(const Operation &operation, double seconds[2]) {
+  evictDB();
+  mark();
+  for (uint32_t pass = 0; pass <= passes; pass++) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t key = 0; key < *operation.keys; key++) {
+      operation.call(key, pass);
+    }
+    auto end = std::chrono::steady_clock::now();
+    seconds[pass == 0 ? 0 : 1] +=
+        std::chrono::duration<double>(end - start).count();
+    if (pass == 0) {
+      mark();
+    }
+  }
+  mark();
+}
+
+/**
+ * @brief Counts the system calls of an operation, cold and warm, by tracing
+ * a child process that calls it.
+ *
+ * @param operation the operation
+ * @param syscalls where to store the system calls per cold and warm call
+ * @return false if the child could not be traced
+ */
+static bool countSyscalls(const Operation &operation, double syscalls[2]) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (ptrace(PTRACE_TRACEME, 0, nullptr, nullptr) == -1) {
+      _exit(EXIT_FAILURE);
+    }
+    raise(SIGSTOP); // until the tracer is ready
+    passes = 1;     // every warm pass makes the same calls, and tracing is slow
+    double seconds[2] = {0, 0};
+    try {
+      callOperation(operation, seconds);
+    } catch (std::exception &e) {
+      _exit(EXIT_FAILURE);
+    }
+    _exit(EXIT_SUCCESS);
+  }
+
+  bidsPlaced += 2; // as it was given one warm pass
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFSTOPPED(status)) {
+    return false;
+  }
+  ptrace(PTRACE_SETOPTIONS, pid, nullptr,
+         PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL);
+
+  uint64_t count = 0;
+  std::vector<uint64_t> marks;
+  int signal = 0;
+  while (ptrace(PTRACE_SYSCALL, pid, nullptr, signal) == 0 &&
+         waitpid(pid, &status, 0) == pid && WIFSTOPPED(status)) {
+    signal = 0;
+    if (WSTOPSIG(status) != (SIGTRAP | 0x80)) {
+      signal = WSTOPSIG(status); // not ours, so it is delivered
+      continue;
+    }
+    struct __ptrace_syscall_info info;
+    if (ptrace(PTRACE_GET_SYSCALL_INFO, pid, sizeof(info), &info) > 0 &&
+        info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+      count++;
+      if (info.entry.nr == SYS_getppid) {
+        marks.push_back(count);
+      }
+    }
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || marks.size() != 3) {
+    return false;
+  }
+  // the marks themselves are left out
+  syscalls[0] = (double)(marks[1] - marks[0] - 1) / *operation.keys;
+  syscalls[1] = (double)(marks[2] - marks[1] - 1) / *operation.keys;
+  return true;
+}
+
+/**
+ * @brief Times an operation, cold and warm, in a child process, and prints
+ * its results.
+ *
+ * @param operation the operation
+ * @return false if the operation failed
+ */
+static bool run(const Operation &operation) {
+  double syscalls[2] = {0, 0};
+  bool counted = countSyscalls(operation, syscalls);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    double seconds[2] = {0, 0};
+    try {
+      callOperation(operation, seconds);
+    } catch (std::exception &e) {
+      std::cerr << operation.name << " failed: " << e.what() << std::endl;
+      _exit(EXIT_FAILURE);
+    }
+
+    double calls[2] = {(double)*operation.keys,
+                       (double)*operation.keys * passes};
+    std::cout << std::left << std::setw(24) << operation.name << std::right
+              << std::fixed;
+    for (int i = 0; i < 2; i++) {
+      std::cout << (i == 0 ? "  cold: " : "  warm: ") << std::setprecision(0)
+                << std::setw(9) << calls[i] / seconds[i] << " ops/s ";
+      if (counted) {
+        std::cout << std::setprecision(1) << std::setw(7)
+                  << syscalls[i] << " syscalls/op";
+      } else {
+        std::cout << "      ? syscalls/op";
+      }
+    }
+    std::cout << std::endl;
+    _exit(EXIT_SUCCESS);
+  }
+
+  bidsPlaced += passes + 1;
+  int status;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char *argv[]) {
+  std::string dir = ".";
+  int opt;
+  while ((opt = getopt(argc, argv, "u:a:b:p:d:")) != -1) {
+    switch (opt) {
+    case 'u':
+      users = (uint32_t)std::stoul(optarg);
+      break;
+    case 'a':
+      auctions = (uint32_t)std::stoul(optarg);
+      break;
+    case 'b':
+      bidsPerAuction = (uint32_t)std::stoul(optarg);
+      break;
+    case 'p':
+      passes = (uint32_t)std::stoul(optarg);
+      break;
+    case 'd':
+      dir = optarg;
+      break;
+    default:
+      std::cerr << "Usage: " << argv[0]
+                << " [-u users] [-a auctions] [-b bids] [-p passes] [-d dir]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  // the bids stay below a million, the largest value they can have
+  if (users < 2 || auctions < 1 || auctions > AUCTION_ID_MAX || passes < 1 ||
+      passes > 10000 || bidsPerAuction > 900000) {
+    std::cerr << "There must be at least 2 users, 1 to " << AUCTION_ID_MAX
+              << " auctions, at most 900000 bids per auction and 1 to 10000 "
+                 "passes"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string scratch = dir + "/auction_bench.XXXXXX";
+  if (mkdtemp(scratch.data()) == nullptr || chdir(scratch.c_str()) == -1) {
+    std::cerr << "Failed to create " << scratch << std::endl;
+    return EXIT_FAILURE;
+  }
+  scratch = std::filesystem::current_path(); // removed from anywhere
+
+  bidsPlaced = bidsPerAuction;
+  // generated by a child, so this process never has any of it in memory
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    try {
+      generateDB();
+    } catch (std::exception &e) {
+      std::cerr << "Failed to generate the AS-DB: " << e.what() << std::endl;
+      _exit(EXIT_FAILURE);
+    }
+    _exit(EXIT_SUCCESS);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  auto end = std::chrono::steady_clock::now();
+
+  if (ok) {
+    std::cout << "AS-DB of " << users << " users, " << auctions
+              << " auctions and " << bidsPerAuction
+              << " bids per auction, generated in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     end - start)
+                     .count()
+              << " ms" << std::endl;
+    for (const auto &operation : OPERATIONS) {
+      ok = run(operation) && ok;
+    }
+  }
+
+  std::filesystem::remove_all(scratch);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
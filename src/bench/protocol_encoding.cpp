@@ -0,0 +1,181 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "../utils/protocol.hpp"
+
+// Compares the text and the binary encodings of UDP packets, timing whole
+// exchanges: the client serializing a request, the AS parsing it and
+// serializing the reply, and the client parsing the reply.
+
+#define BENCH_ITERATIONS 200000
+
+static PacketBuffer requestWire;
+static PacketBuffer replyWire;
+
+/**
+ * @brief Parses a request the way the AS does, in the given encoding.
+ *
+ * @param request the request to fill
+ * @param bytes the received bytes
+ * @param encoding the encoding of the bytes
+ */
+template <typename Request>
+static void serverRead(Request &request, std::string_view bytes,
+                       PacketEncoding encoding) {
+  if (encoding == BINARY_ENCODING) {
+    bytes = read_binary_frame(bytes);
+    bytes.remove_prefix(PACKET_ID_LEN);
+    request.deserializeBinary(bytes);
+  } else {
+    bytes.remove_prefix(PACKET_ID_LEN);
+    request.deserialize(bytes);
+  }
+}
+
+/**
+ * @brief Parses a reply the way the client does, in the given encoding.
+ *
+ * @param reply the reply to fill
+ * @param bytes the received bytes
+ * @param encoding the encoding of the bytes
+ */
+static void clientRead(UdpPacket &reply, std::string_view bytes,
+                       PacketEncoding encoding) {
+  if (encoding == BINARY_ENCODING) {
+    reply.deserializeBinary(read_binary_frame(bytes));
+  } else {
+    std::stringstream stream;
+    stream.write(bytes.data(), (std::streamsize)bytes.length());
+    reply.deserialize(stream);
+  }
+}
+
+/**
+ * @brief Exchanges a login request and its reply.
+ *
+ * @param encoding the encoding to use
+ * @return the number of bytes sent both ways
+ */
+static size_t login(PacketEncoding encoding) {
+  LoginRequest request;
+  request.userID = "123456";
+  request.password = "password";
+  requestWire.clear();
+  encode_packet(request, requestWire, encoding);
+
+  LoginRequest received;
+  serverRead(received, requestWire.view(), encoding);
+  LoginResponse response;
+  response.status = LoginResponse::OK;
+  replyWire.clear();
+  encode_packet(response, replyWire, encoding);
+
+  LoginResponse reply;
+  clientRead(reply, replyWire.view(), encoding);
+  return requestWire.length() + replyWire.length();
+}
+
+/**
+ * @brief Exchanges a list auctions request and its reply, with 100 auctions.
+ *
+ * @param encoding the encoding to use
+ * @return the number of bytes sent both ways
+ */
+static size_t listAuctions(PacketEncoding encoding) {
+  static ListAuctionsResponse sample;
+  if (sample.auctions.empty()) {
+    sample.status = ListAuctionsResponse::OK;
+    for (int i = 1; i <= 100; i++) {
+      sample.auctions.push_back(
+          std::make_pair(intToStringWithZeros(i, AUCTION_ID_LENGTH), i % 2));
+    }
+  }
+
+  ListAuctionsRequest request;
+  requestWire.clear();
+  encode_packet(request, requestWire, encoding);
+
+  ListAuctionsRequest received;
+  serverRead(received, requestWire.view(), encoding);
+  replyWire.clear();
+  encode_packet(sample, replyWire, encoding);
+
+  ListAuctionsResponse reply;
+  clientRead(reply, replyWire.view(), encoding);
+  return requestWire.length() + replyWire.length();
+}
+
+/**
+ * @brief Exchanges a show record request and its reply, with 20 bids.
+ *
+ * @param encoding the encoding to use
+ * @return the number of bytes sent both ways
+ */
+static size_t showRecord(PacketEncoding encoding) {
+  static ShowRecordResponse sample;
+  if (sample.bids.empty()) {
+    sample.status = ShowRecordResponse::OK;
+    sample.hostUID = "123456";
+    sample.auctionName = "auction";
+    sample.assetFileName = "asset.jpg";
+    sample.startValue = 100;
+    sample.startDate = "2023-12-01 12:00:00";
+    sample.timeActive = 3600;
+    for (uint32_t i = 0; i < 20; i++) {
+      sample.bids.push_back(std::make_tuple("654321", 200 - i,
+                                            "2023-12-01 12:30:00", 1800 + i));
+    }
+    sample.end = std::make_pair("2023-12-01 13:00:00", 3600);
+  }
+
+  ShowRecordRequest request;
+  request.auctionID = "001";
+  requestWire.clear();
+  encode_packet(request, requestWire, encoding);
+
+  ShowRecordRequest received;
+  serverRead(received, requestWire.view(), encoding);
+  replyWire.clear();
+  encode_packet(sample, replyWire, encoding);
+
+  ShowRecordResponse reply;
+  clientRead(reply, replyWire.view(), encoding);
+  return requestWire.length() + replyWire.length();
+}
+
+/**
+ * @brief Runs an exchange in both encodings and prints their results.
+ *
+ * @param name the name of the exchange
+ * @param exchange the exchange to run
+ */
+static void run(const char *name, size_t (*exchange)(PacketEncoding)) {
+  const PacketEncoding encodings[] = {TEXT_ENCODING, BINARY_ENCODING};
+  for (PacketEncoding encoding : encodings) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+      bytes = exchange(encoding);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end - start)
+                    .count();
+    std::cout << name << (encoding == TEXT_ENCODING ? " text:   " : " binary: ")
+              << ns / BENCH_ITERATIONS << " ns/request, " << bytes
+              << " bytes/request" << std::endl;
+  }
+}
+
+int main() {
+  run("login      ", login);
+  run("list       ", listAuctions);
+  run("show record", showRecord);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,576 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../utils/protocol.hpp"
+
+// Feeds corpora of valid and malformed packets through every parser and
+// serializer of the protocol, reporting the time and the heap allocations per
+// packet. The valid packets are generated from the packet classes, and the
+// malformed ones are fuzzed from them, all from a fixed seed so every run
+// parses the same bytes. TCP packets are parsed from a socket pair, as the
+// AS and the user application read them. The packets that carry a file, OPA
+// and RSA, and the streamed RTS listing are left out.
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t size) noexcept {
+  (void)size;
+  std::free(ptr);
+}
+
+#define CORPUS_SIZE 1000 // packets generated of every kind
+#define CORPUS_PASSES 20 // times every corpus is parsed
+
+static std::mt19937 rng(2023);
+
+/**
+ * @brief Gets a random number in a range.
+ *
+ * @param min the smallest number
+ * @param max the largest number
+ * @return the number
+ */
+static uint32_t randomInt(uint32_t min, uint32_t max) {
+  return std::uniform_int_distribution<uint32_t>(min, max)(rng);
+}
+
+/**
+ * @brief Gets a random string made of the given characters.
+ *
+ * @param length the length of the string
+ * @param chars the characters to pick from
+ * @return the string
+ */
+static std::string randomString(size_t length, std::string_view chars) {
+  std::string str;
+  for (size_t i = 0; i < length; i++) {
+    str += chars[randomInt(0, (uint32_t)chars.length() - 1)];
+  }
+  return str;
+}
+
+static const std::string_view DIGITS = "0123456789";
+static const std::string_view ALNUM =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static std::string randomUserID() {
+  return randomString(USER_ID_LENGTH, DIGITS);
+}
+
+static std::string randomAuctionID() {
+  return intToStringWithZeros((int)randomInt(1, AUCTION_ID_MAX),
+                              AUCTION_ID_LENGTH);
+}
+
+static std::string randomPassword() {
+  return randomString(PASSWORD_LENGTH, ALNUM);
+}
+
+static std::string randomDateTime() {
+  std::stringstream stream;
+  stream << "2023-" << std::setw(2) << std::setfill('0') << randomInt(1, 12)
+         << "-" << std::setw(2) << randomInt(1, 28) << " " << std::setw(2)
+         << randomInt(0, 23) << ":" << std::setw(2) << randomInt(0, 59) << ":"
+         << std::setw(2) << randomInt(0, 59);
+  return stream.str();
+}
+
+static std::vector<std::pair<std::string, uint8_t>> randomAuctions() {
+  std::vector<std::pair<std::string, uint8_t>> auctions;
+  uint32_t count = randomInt(1, LIST_PAGE_SIZE);
+  for (uint32_t i = 1; i <= count; i++) {
+    auctions.push_back(std::make_pair(
+        intToStringWithZeros((int)i, AUCTION_ID_LENGTH), randomInt(0, 1)));
+  }
+  return auctions;
+}
+
+static std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+randomBids() {
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
+  uint32_t count = randomInt(0, TOP_BIDS_MAX);
+  for (uint32_t i = 0; i < count; i++) {
+    bids.push_back(std::make_tuple(randomUserID(), randomInt(1, 999999),
+                                   randomDateTime(), randomInt(0, 99999)));
+  }
+  return bids;
+}
+
+static std::pair<std::string, uint32_t> randomEnd() {
+  if (randomInt(0, 1) == 0) {
+    return std::make_pair("", 0);
+  }
+  return std::make_pair(randomDateTime(), randomInt(0, 99999));
+}
+
+/**
+ * @brief Corrupts a packet, the way a faulty or hostile peer could.
+ *
+ * @param packet the packet to corrupt
+ * @return the corrupted packet
+ */
+static std::string mutate(std::string packet) {
+  size_t pos = randomInt(0, (uint32_t)packet.length() - 1);
+  switch (randomInt(0, 5)) {
+  case 0: // truncated
+    packet.resize(pos);
+    break;
+  case 1: // a byte replaced
+    packet[pos] = (char)randomInt(0, 255);
+    break;
+  case 2: // a byte inserted
+    packet.insert(pos, 1, (char)randomInt(0, 255));
+    break;
+  case 3: // a byte removed
+    packet.erase(pos, 1);
+    break;
+  case 4: // an extra field
+    packet.insert(pos, " " + randomString(randomInt(1, 8), ALNUM));
+    break;
+  default: // a space or newline somewhere else
+    packet[pos] = randomInt(0, 1) ? ' ' : '\n';
+    break;
+  }
+  return packet;
+}
+
+/**
+ * @brief The results of going over a corpus.
+ */
+struct CorpusResult {
+  double ns;          // per packet
+  double allocations; // per packet
+  size_t rejected;    // packets of the corpus that were not accepted
+};
+
+/**
+ * @brief Times a function over every packet of a corpus.
+ *
+ * @param corpusSize the number of packets in the corpus
+ * @param run the function to time, given the index of a packet and returning
+ * whether it was accepted
+ * @return the results
+ */
+template <typename Run>
+static CorpusResult timeCorpus(size_t corpusSize, Run run) {
+  size_t rejected = 0;
+  uint64_t allocationsBefore = allocations;
+  auto start = std::chrono::steady_clock::now();
+
+  for (int pass = 0; pass < CORPUS_PASSES; pass++) {
+    for (size_t i = 0; i < corpusSize; i++) {
+      if (!run(i)) {
+        rejected++;
+      }
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  double packets = (double)(corpusSize * CORPUS_PASSES);
+  double ns =
+      (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  return CorpusResult{ns / packets,
+                      (double)(allocations - allocationsBefore) / packets,
+                      rejected / CORPUS_PASSES};
+}
+
+/**
+ * @brief Prints a row of results.
+ *
+ * @param name the packet ID
+ * @param path the parser or serializer that was timed
+ * @param result the results
+ * @param showRejected whether the path can reject packets
+ */
+static void report(std::string_view name, std::string_view path,
+                   CorpusResult result, bool showRejected) {
+  std::cout << name << "  " << std::left << std::setw(26) << path << std::right
+            << std::fixed << std::setprecision(1) << std::setw(10) << result.ns
+            << " ns/packet" << std::setw(8) << std::setprecision(2)
+            << result.allocations << " allocations/packet";
+  if (showRejected) {
+    std::cout << "  " << result.rejected << "/" << CORPUS_SIZE << " rejected";
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * @brief Parses a UDP packet the way its receiver does.
+ *
+ * Requests are parsed like the AS does, in place and after their ID, and
+ * replies like the user application does, through a stringstream.
+ *
+ * @param bytes the received bytes
+ * @param encoding the encoding of the bytes
+ * @return whether the packet was accepted
+ */
+template <typename Packet, bool isRequest>
+static bool parseUdp(std::string_view bytes, PacketEncoding encoding) {
+  Packet packet;
+  UdpPacket &base = packet; // some classes only override it privately
+  try {
+    if (encoding == BINARY_ENCODING) {
+      bytes = read_binary_frame(bytes);
+      if constexpr (isRequest) {
+        if (bytes.substr(0, PACKET_ID_LEN) != Packet::ID) {
+          return false;
+        }
+        bytes.remove_prefix(PACKET_ID_LEN);
+      }
+      base.deserializeBinary(bytes);
+    } else if constexpr (isRequest) {
+      if (bytes.substr(0, PACKET_ID_LEN) != Packet::ID) {
+        return false;
+      }
+      bytes.remove_prefix(PACKET_ID_LEN);
+      packet.deserialize(bytes);
+    } else {
+      std::stringstream stream;
+      stream.write(bytes.data(), (std::streamsize)bytes.length());
+      packet.deserialize(stream);
+    }
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Benchmarks the serializer and the parser of a UDP packet, in both
+ * encodings.
+ *
+ * @param generate makes a random packet
+ */
+template <typename Packet, bool isRequest>
+static void benchUdp(Packet (*generate)()) {
+  std::vector<Packet> samples;
+  for (int i = 0; i < CORPUS_SIZE; i++) {
+    samples.push_back(generate());
+  }
+
+  const PacketEncoding encodings[] = {TEXT_ENCODING, BINARY_ENCODING};
+  for (PacketEncoding encoding : encodings) {
+    std::string encodingName = encoding == TEXT_ENCODING ? "text" : "binary";
+    PacketBuffer buffer;
+
+    CorpusResult serialized = timeCorpus(CORPUS_SIZE, [&](size_t i) {
+      buffer.clear();
+      encode_packet(samples[i], buffer, encoding);
+      return true;
+    });
+    report(Packet::ID, encodingName + " serialize", serialized, false);
+
+    std::vector<std::string> valid;
+    std::vector<std::string> malformed;
+    for (auto &sample : samples) {
+      buffer.clear();
+      encode_packet(sample, buffer, encoding);
+      valid.push_back(std::string(buffer.view()));
+      malformed.push_back(mutate(valid.back()));
+    }
+
+    CorpusResult parsed = timeCorpus(CORPUS_SIZE, [&](size_t i) {
+      return parseUdp<Packet, isRequest>(valid[i], encoding);
+    });
+    report(Packet::ID, encodingName + " parse", parsed, true);
+    CorpusResult parsedMalformed = timeCorpus(CORPUS_SIZE, [&](size_t i) {
+      return parseUdp<Packet, isRequest>(malformed[i], encoding);
+    });
+    report(Packet::ID, encodingName + " parse malformed", parsedMalformed,
+           true);
+  }
+}
+
+static int tcpPair[2]; // packets are written to [1] and parsed from [0]
+
+/**
+ * @brief Reads every byte waiting in the parsing end of the socket pair.
+ *
+ * @return the bytes that were read
+ */
+static std::string drainTcp() {
+  std::string bytes;
+  char chunk[FILE_BUFFER_LEN];
+  ssize_t n;
+  while ((n = read(tcpPair[0], chunk, sizeof(chunk))) > 0) {
+    bytes.append(chunk, (size_t)n);
+  }
+  return bytes;
+}
+
+/**
+ * @brief Parses a TCP packet the way its receiver does.
+ *
+ * The parsing end does not block, so a truncated packet is rejected instead
+ * of waiting for more bytes.
+ *
+ * @param bytes the bytes sent, without the ID for requests, since the AS
+ * reads it before picking a handler
+ * @return whether the packet was accepted
+ */
+template <typename Packet> static bool parseTcp(const std::string &bytes) {
+  if (write(tcpPair[1], bytes.data(), bytes.length()) !=
+      (ssize_t)bytes.length()) {
+    return false;
+  }
+  Packet packet;
+  bool accepted = true;
+  try {
+    packet.receive(tcpPair[0]);
+  } catch (...) {
+    accepted = false;
+  }
+  drainTcp();
+  return accepted;
+}
+
+/**
+ * @brief Benchmarks the sender and the receiver of a TCP packet.
+ *
+ * @param generate makes a random packet
+ * @param isRequest whether the AS receives the packet
+ */
+template <typename Packet>
+static void benchTcp(Packet (*generate)(), bool isRequest) {
+  std::vector<Packet> samples;
+  for (int i = 0; i < CORPUS_SIZE; i++) {
+    samples.push_back(generate());
+  }
+
+  CorpusResult sent = timeCorpus(CORPUS_SIZE, [&](size_t i) {
+    samples[i].send(tcpPair[1]);
+    drainTcp();
+    return true;
+  });
+  report(Packet::ID, "send", sent, false);
+
+  std::vector<std::string> valid;
+  std::vector<std::string> malformed;
+  for (auto &sample : samples) {
+    sample.send(tcpPair[1]);
+    valid.push_back(drainTcp().substr(isRequest ? PACKET_ID_LEN : 0));
+    malformed.push_back(mutate(valid.back()));
+  }
+
+  CorpusResult received = timeCorpus(
+      CORPUS_SIZE, [&](size_t i) { return parseTcp<Packet>(valid[i]); });
+  report(Packet::ID, "receive", received, true);
+  CorpusResult receivedMalformed = timeCorpus(
+      CORPUS_SIZE, [&](size_t i) { return parseTcp<Packet>(malformed[i]); });
+  report(Packet::ID, "receive malformed", receivedMalformed, true);
+}
+
+template <typename Request> static Request userRequest() {
+  Request request;
+  request.userID = randomUserID();
+  request.password = randomPassword();
+  return request;
+}
+
+template <typename Request> static Request userIDRequest() {
+  Request request;
+  request.userID = randomUserID();
+  return request;
+}
+
+template <typename Response> static Response statusResponse() {
+  Response response;
+  response.status = static_cast<decltype(response.status)>(randomInt(0, 3));
+  return response;
+}
+
+template <typename Response> static Response listingResponse() {
+  Response response;
+  response.status = Response::OK;
+  response.auctions = randomAuctions();
+  return response;
+}
+
+template <typename Request> static Request pageRequest() {
+  Request request;
+  request.userID = randomUserID();
+  request.cursor = randomAuctionID();
+  return request;
+}
+
+template <typename Response> static Response pageResponse() {
+  Response response;
+  response.status = Response::OK;
+  response.nextCursor = randomAuctionID();
+  response.auctions = randomAuctions();
+  return response;
+}
+
+static ListAuctionsRequest listAuctionsRequest() {
+  return ListAuctionsRequest();
+}
+
+static ListAuctionsPageRequest listAuctionsPageRequest() {
+  ListAuctionsPageRequest request;
+  request.cursor = randomAuctionID();
+  return request;
+}
+
+static ShowRecordRequest showRecordRequest() {
+  ShowRecordRequest request;
+  request.auctionID = randomAuctionID();
+  return request;
+}
+
+static ShowRecordResponse showRecordResponse() {
+  ShowRecordResponse response;
+  response.status = ShowRecordResponse::OK;
+  response.hostUID = randomUserID();
+  response.auctionName = randomString(randomInt(1, ASSET_NAME_MAX), ALNUM);
+  response.assetFileName = randomString(randomInt(1, 20), ALNUM) + ".jpg";
+  response.startValue = randomInt(1, 999999);
+  response.startDate = randomDateTime();
+  response.timeActive = randomInt(1, 99999);
+  response.bids = randomBids();
+  response.end = randomEnd();
+  return response;
+}
+
+static ListAuctionsDeltaRequest listAuctionsDeltaRequest() {
+  ListAuctionsDeltaRequest request;
+  request.version = (uint64_t)randomInt(0, UINT32_MAX) << 20;
+  return request;
+}
+
+static ListAuctionsDeltaResponse listAuctionsDeltaResponse() {
+  ListAuctionsDeltaResponse response;
+  response.status = ListAuctionsDeltaResponse::OK;
+  response.version = (uint64_t)randomInt(0, UINT32_MAX) << 20;
+  response.auctions = randomAuctions();
+  return response;
+}
+
+static ShowRecordDeltaRequest showRecordDeltaRequest() {
+  ShowRecordDeltaRequest request;
+  request.auctionID = randomAuctionID();
+  request.version = randomInt(0, 100);
+  return request;
+}
+
+static ShowRecordDeltaResponse showRecordDeltaResponse() {
+  ShowRecordDeltaResponse response;
+  response.status = ShowRecordDeltaResponse::OK;
+  response.version = randomInt(0, 100);
+  response.bids = randomBids();
+  response.end = randomEnd();
+  return response;
+}
+
+static ShowAssetRequest showAssetRequest() {
+  ShowAssetRequest request;
+  request.auctionID = randomAuctionID();
+  return request;
+}
+
+static CloseAuctionRequest closeAuctionRequest() {
+  CloseAuctionRequest request = userRequest<CloseAuctionRequest>();
+  request.auctionID = randomAuctionID();
+  return request;
+}
+
+static BidRequest bidRequest() {
+  BidRequest request = userRequest<BidRequest>();
+  request.auctionID = randomAuctionID();
+  request.bidValue = randomInt(1, 999999);
+  return request;
+}
+
+static WatchRequest watchRequest() {
+  WatchRequest request;
+  request.auctionID = randomAuctionID();
+  request.timeout = randomInt(1, WATCH_TIMEOUT_MAX);
+  return request;
+}
+
+static OpenAuctionResponse openAuctionResponse() {
+  OpenAuctionResponse response = statusResponse<OpenAuctionResponse>();
+  response.auctionID = randomAuctionID();
+  return response;
+}
+
+static WatchResponse watchResponse() {
+  WatchResponse response;
+  response.status = static_cast<enum WatchResponse::status>(randomInt(0, 4));
+  response.bidValue = randomInt(1, 999999);
+  return response;
+}
+
+int main() {
+  benchUdp<LoginRequest, true>(userRequest<LoginRequest>);
+  benchUdp<LoginResponse, false>(statusResponse<LoginResponse>);
+  benchUdp<LogoutRequest, true>(userRequest<LogoutRequest>);
+  benchUdp<LogoutResponse, false>(statusResponse<LogoutResponse>);
+  benchUdp<UnregisterRequest, true>(userRequest<UnregisterRequest>);
+  benchUdp<UnregisterResponse, false>(statusResponse<UnregisterResponse>);
+  benchUdp<ListUserAuctionsRequest, true>(
+      userIDRequest<ListUserAuctionsRequest>);
+  benchUdp<ListUserAuctionsResponse, false>(
+      listingResponse<ListUserAuctionsResponse>);
+  benchUdp<ListUserBidsRequest, true>(userIDRequest<ListUserBidsRequest>);
+  benchUdp<ListUserBidsResponse, false>(
+      listingResponse<ListUserBidsResponse>);
+  benchUdp<ListAuctionsRequest, true>(listAuctionsRequest);
+  benchUdp<ListAuctionsResponse, false>(
+      listingResponse<ListAuctionsResponse>);
+  benchUdp<ListAuctionsPageRequest, true>(listAuctionsPageRequest);
+  benchUdp<ListAuctionsPageResponse, false>(
+      pageResponse<ListAuctionsPageResponse>);
+  benchUdp<ListUserAuctionsPageRequest, true>(
+      pageRequest<ListUserAuctionsPageRequest>);
+  benchUdp<ListUserBidsPageRequest, true>(
+      pageRequest<ListUserBidsPageRequest>);
+  benchUdp<ShowRecordRequest, true>(showRecordRequest);
+  benchUdp<ShowRecordResponse, false>(showRecordResponse);
+  benchUdp<ListAuctionsDeltaRequest, true>(listAuctionsDeltaRequest);
+  benchUdp<ListAuctionsDeltaResponse, false>(listAuctionsDeltaResponse);
+  benchUdp<ShowRecordDeltaRequest, true>(showRecordDeltaRequest);
+  benchUdp<ShowRecordDeltaResponse, false>(showRecordDeltaResponse);
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, tcpPair) < 0) {
+    std::cerr << "Failed to create a socket pair" << std::endl;
+    return EXIT_FAILURE;
+  }
+  fcntl(tcpPair[0], F_SETFL, fcntl(tcpPair[0], F_GETFL) | O_NONBLOCK);
+
+  benchTcp<ShowAssetRequest>(showAssetRequest, true);
+  benchTcp<CloseAuctionRequest>(closeAuctionRequest, true);
+  benchTcp<CloseAuctionResponse>(statusResponse<CloseAuctionResponse>, false);
+  benchTcp<BidRequest>(bidRequest, true);
+  benchTcp<BidResponse>(statusResponse<BidResponse>, false);
+  benchTcp<WatchRequest>(watchRequest, true);
+  benchTcp<WatchResponse>(watchResponse, false);
+  benchTcp<OpenAuctionResponse>(openAuctionResponse, false);
+
+  close(tcpPair[0]);
+  close(tcpPair[1]);
+  return EXIT_SUCCESS;
+}
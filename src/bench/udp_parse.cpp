@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "../utils/protocol.hpp"
+
+// Compares the stream and the string_view UDP request parsers, as used by the
+// AS, reporting the time and the heap allocations per parsed packet.
+
+static uint64_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t size) noexcept {
+  (void)size;
+  std::free(ptr);
+}
+
+#define BENCH_ITERATIONS 1000000
+
+static const std::string_view packets[] = {
+    "LIN 123456 password\n", "LOU 123456 password\n", "LMA 123456\n",
+    "LMB 123456\n",          "LST\n",                 "SRC 001\n",
+};
+static const size_t numPackets = sizeof(packets) / sizeof(packets[0]);
+
+/**
+ * @brief Parses a packet the way the AS used to, through a stringstream.
+ *
+ * @param packet the received bytes
+ */
+static void parseStream(std::string_view packet) {
+  std::stringstream stream;
+  stream.write(packet.data(), (std::streamsize)packet.length());
+
+  char packetID[PACKET_ID_LEN + 1];
+  stream >> packetID;
+  std::string id = packetID;
+
+  if (id == LoginRequest::ID || id == LogoutRequest::ID) {
+    LoginRequest request;
+    request.deserialize(stream);
+  } else if (id == ListUserAuctionsRequest::ID ||
+             id == ListUserBidsRequest::ID) {
+    ListUserAuctionsRequest request;
+    request.deserialize(stream);
+  } else if (id == ListAuctionsRequest::ID) {
+    ListAuctionsRequest request;
+    request.deserialize(stream);
+  } else {
+    ShowRecordRequest request;
+    request.deserialize(stream);
+  }
+}
+
+/**
+ * @brief Parses a packet in place, over the received bytes.
+ *
+ * @param packet the received bytes
+ */
+static void parseView(std::string_view packet) {
+  std::string_view id = packet.substr(0, PACKET_ID_LEN);
+  packet.remove_prefix(PACKET_ID_LEN);
+
+  if (id == LoginRequest::ID || id == LogoutRequest::ID) {
+    LoginRequest request;
+    request.deserialize(packet);
+  } else if (id == ListUserAuctionsRequest::ID ||
+             id == ListUserBidsRequest::ID) {
+    ListUserAuctionsRequest request;
+    request.deserialize(packet);
+  } else if (id == ListAuctionsRequest::ID) {
+    ListAuctionsRequest request;
+    request.deserialize(packet);
+  } else {
+    ShowRecordRequest request;
+    request.deserialize(packet);
+  }
+}
+
+/**
+ * @brief Runs a parser over the sample packets and prints its results.
+ *
+ * @param name the name of the parser
+ * @param parse the parser to run
+ */
+static void run(const char *name, void (*parse)(std::string_view)) {
+  uint64_t allocationsBefore = allocations;
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    parse(packets[(size_t)i % numPackets]);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+      (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  std::cout << name << ": " << ns / BENCH_ITERATIONS << " ns/packet, "
+            << (double)(allocations - allocationsBefore) / BENCH_ITERATIONS
+            << " allocations/packet" << std::endl;
+}
+
+int main() {
+  run("stringstream", parseStream);
+  run("string_view ", parseView);
+  return EXIT_SUCCESS;
+}
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <unistd.h>
 
@@ -356,6 +357,72 @@ void CloseAuctionCommand::handleCommand(std::string args, UserState &state) {
   }
 }
 
+/**
+ * @brief Gets a whole paged listing, a small reply at a time, rather than in a
+ * single reply that may not fit in a datagram.
+ *
+ * @param request The request of the listing, whose cursor is moved along.
+ * @param response Where the auctions of every page are gathered, with the
+ * status of the last page.
+ * @param state The user state.
+ * @return false if the AS only speaks the base protocol and answered the first
+ * page with an error, true otherwise.
+ */
+template <typename Request, typename Response>
+static bool listEveryPage(Request &request, Response &response,
+                          UserState &state) {
+  std::vector<std::pair<std::string, uint8_t>> auctions;
+  request.cursor = LIST_CURSOR_START;
+  while (true) {
+    try {
+      state.sendUdpPacketAndWaitForReply(request, response);
+    } catch (UnexpectedPacketException &e) {
+      if (request.cursor != LIST_CURSOR_START) { // it did know the first page
+        throw;
+      }
+      return false;
+    }
+    if (response.status != Response::OK) {
+      break;
+    }
+    auctions.insert(auctions.end(), response.auctions.begin(),
+                    response.auctions.end());
+    // the cursor goes back to the start after the last page, and only moves
+    // forward otherwise
+    if (response.nextCursor <= request.cursor) {
+      break;
+    }
+    request.cursor = response.nextCursor;
+  }
+  response.auctions = std::move(auctions);
+  return true;
+}
+
+/**
+ * @brief Gets a whole listing in a single reply to a base protocol request,
+ * from an AS that does not know the paged ones.
+ *
+ * @param request The base protocol request of the listing.
+ * @param page Where the auctions are put, with the status of the reply.
+ * @param state The user state.
+ */
+template <typename Response, typename Request>
+static void listInOneReply(Request &request, ListingPageResponse &page,
+                           UserState &state) {
+  Response response;
+  state.sendUdpPacketAndWaitForReply(request, response);
+
+  // the statuses of the base replies are among those of the paged ones
+  std::string statusName = Response::STATUS_NAMES[response.status];
+  page.status = ListingPageResponse::ERR;
+  for (size_t i = 0; i < std::size(ListingPageResponse::STATUS_NAMES); i++) {
+    if (statusName == ListingPageResponse::STATUS_NAMES[i]) {
+      page.status = static_cast<enum ListingPageResponse::status>(i);
+    }
+  }
+  page.auctions = std::move(response.auctions);
+}
+
 void ListUserAuctionsCommand::handleCommand(std::string args,
                                             UserState &state) {
   std::vector<std::string> params = parse_args(args);
@@ -368,27 +435,32 @@ void ListUserAuctionsCommand::handleCommand(std::string args,
     return;
   }
 
-  ListUserAuctionsRequest listUserAuctionsRequest;
+  ListUserAuctionsPageRequest listUserAuctionsRequest;
   listUserAuctionsRequest.userID = state.getUserID();
 
-  ListUserAuctionsResponse listUserAuctionsResponse;
-  state.sendUdpPacketAndWaitForReply(listUserAuctionsRequest,
-                                     listUserAuctionsResponse);
+  ListUserAuctionsPageResponse listUserAuctionsResponse;
+  if (!listEveryPage(listUserAuctionsRequest, listUserAuctionsResponse,
+                     state)) {
+    ListUserAuctionsRequest wholeListRequest;
+    wholeListRequest.userID = state.getUserID();
+    listInOneReply<ListUserAuctionsResponse>(wholeListRequest,
+                                             listUserAuctionsResponse, state);
+  }
 
   switch (listUserAuctionsResponse.status) {
-  case ListUserAuctionsResponse::status::OK:
+  case ListUserAuctionsPageResponse::status::OK:
     std::cout << "List user auctions successful!" << std::endl;
     printListUserAuctionsTable(listUserAuctionsResponse.auctions);
     break;
-  case ListUserAuctionsResponse::status::NOK:
+  case ListUserAuctionsPageResponse::status::NOK:
     std::cout << "List user auctions failed: You have no ongoing auctions"
               << std::endl;
     break;
-  case ListUserAuctionsResponse::status::NLG:
+  case ListUserAuctionsPageResponse::status::NLG:
     std::cout << "List user auctions failed: You are not logged in"
               << std::endl;
     break;
-  case ListUserAuctionsResponse::status::ERR:
+  case ListUserAuctionsPageResponse::status::ERR:
     std::cout << "List user auctions failed: Server error" << std::endl;
     break;
   default:
@@ -407,25 +479,30 @@ void ListUserBidsCommand::handleCommand(std::string args, UserState &state) {
     return;
   }
 
-  ListUserBidsRequest listUserBidsRequest;
+  ListUserBidsPageRequest listUserBidsRequest;
   listUserBidsRequest.userID = state.getUserID();
 
-  ListUserBidsResponse listUserBidsResponse;
-  state.sendUdpPacketAndWaitForReply(listUserBidsRequest, listUserBidsResponse);
+  ListUserBidsPageResponse listUserBidsResponse;
+  if (!listEveryPage(listUserBidsRequest, listUserBidsResponse, state)) {
+    ListUserBidsRequest wholeListRequest;
+    wholeListRequest.userID = state.getUserID();
+    listInOneReply<ListUserBidsResponse>(wholeListRequest, listUserBidsResponse,
+                                         state);
+  }
 
   switch (listUserBidsResponse.status) {
-  case ListUserBidsResponse::status::OK:
+  case ListUserBidsPageResponse::status::OK:
     std::cout << "List user auctions with bids successful!" << std::endl;
     printListUserBidsTable(listUserBidsResponse.auctions);
     break;
-  case ListUserBidsResponse::status::NOK:
+  case ListUserBidsPageResponse::status::NOK:
     std::cout << "List user auctions with bids failed: You have no ongoing bids"
               << std::endl;
     break;
-  case ListUserBidsResponse::status::NLG:
+  case ListUserBidsPageResponse::status::NLG:
     std::cout << "List user bids failed: You are not logged in" << std::endl;
     break;
-  case ListUserBidsResponse::status::ERR:
+  case ListUserBidsPageResponse::status::ERR:
     std::cout << "List user bids failed: Server error" << std::endl;
     break;
   default:
@@ -444,21 +521,26 @@ void ListAuctionsCommand::handleCommand(std::string args, UserState &state) {
     return;
   }
 
-  ListAuctionsRequest listAuctionsRequest;
+  ListAuctionsPageRequest listAuctionsRequest;
 
-  ListAuctionsResponse listAuctionsResponse;
-  state.sendUdpPacketAndWaitForReply(listAuctionsRequest, listAuctionsResponse);
+  ListAuctionsPageResponse listAuctionsResponse;
+  if (!listEveryPage(listAuctionsRequest, listAuctionsResponse, state)) {
+    ListAuctionsRequest wholeListRequest;
+    listInOneReply<ListAuctionsResponse>(wholeListRequest, listAuctionsResponse,
+                                         state);
+  }
 
   switch (listAuctionsResponse.status) {
-  case ListAuctionsResponse::status::OK:
+  case ListAuctionsPageResponse::status::OK:
     std::cout << "List auctions successful!" << std::endl;
     printListAuctionsTable(listAuctionsResponse.auctions);
     break;
-  case ListAuctionsResponse::status::NOK:
+  case ListAuctionsPageResponse::status::NOK:
     std::cout << "List auctions failed: There are no ongoing auctions"
               << std::endl;
     break;
-  case ListAuctionsResponse::status::ERR:
+  case ListAuctionsPageResponse::status::NLG: // only for the user listings
+  case ListAuctionsPageResponse::status::ERR:
     std::cout << "List auctions failed: Server error" << std::endl;
     break;
   default:
@@ -22,7 +22,8 @@ int main(int argc, char *argv[]) {
       return EXIT_SUCCESS;
     }
 
-    UserState userState(config.host, config.port); // create a new user state
+    // create a new user state
+    UserState userState(config.host, config.port, config.encoding);
     CommandManager commandManager;    // create a new command manager
     registerCommands(commandManager); // register all commands with the manager
 
@@ -73,13 +74,16 @@ void registerCommands(CommandManager &commandManager) {
 ClientConfig::ClientConfig(int argc, char *argv[]) {
   this->programPath = argv[0]; // set the program path to the first argument
 
-  // -h -n -p are valid options, and : means that they need an argument
+  // -h -n -p -b are valid options, and : means that they need an argument
   int opt;
-  while ((opt = getopt(argc, argv, "hn:p:")) != -1) {
+  while ((opt = getopt(argc, argv, "hn:p:b")) != -1) {
     switch (opt) {
     case 'h':
       this->help = true;
       break;
+    case 'b':
+      this->encoding = BINARY_ENCODING;
+      break;
     case 'n':
       this->host = std::string(optarg);
       break;
@@ -96,12 +100,13 @@ ClientConfig::ClientConfig(int argc, char *argv[]) {
 }
 
 void ClientConfig::printHelp(std::ostream &stream) {
-  stream << "Usage: " << programPath << " [-n ASIP] [-p ASport] [-h]"
+  stream << "Usage: " << programPath << " [-n ASIP] [-p ASport] [-b] [-h]"
          << std::endl;
   stream << "Available options:" << std::endl;
   stream << "-n ASIP\t\tSet hostname of Auction Server. Default: "
          << DEFAULT_HOSTNAME << std::endl;
   stream << "-p ASport\tSet port of Auction Server. Default: " << DEFAULT_PORT
          << std::endl;
+  stream << "-b\t\tSend UDP requests in the binary encoding." << std::endl;
   stream << "-h\t\tPrint this menu." << std::endl;
 }
\ No newline at end of file
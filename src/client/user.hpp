@@ -14,7 +14,8 @@
  * @brief Represents configuration options for a client application.
  *
  * The ClientConfig class encapsulates parameters such as the program path,
- * host, port, and a flag indicating whether to display help information.
+ * host, port, the encoding of UDP packets and a flag indicating whether to
+ * display help information.
  */
 class ClientConfig {
 public:
@@ -22,6 +23,7 @@ public:
   std::string host = DEFAULT_HOSTNAME;
   std::string port = DEFAULT_PORT;
   bool help = false;
+  PacketEncoding encoding = TEXT_ENCODING;
 
   /**
    * @brief Constructs a new ClientConfig object.
@@ -2,10 +2,14 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 
-UserState::UserState(std::string &hostname, std::string &port) {
+UserState::UserState(std::string &hostname, std::string &port,
+                     PacketEncoding encoding)
+    : udpEncoding(encoding), nextRequestID((uint32_t)random()) {
   this->setupUdpSocket();
   this->resolveServerAddress(hostname, port);
 }
@@ -61,28 +65,71 @@ void UserState::resolveServerAddress(std::string &hostname, std::string &port) {
   }
 }
 
-void UserState::sendUdpPacket(UdpPacket &packet) {
+void UserState::sendUdpPacket(UdpPacket &packet, uint32_t requestID) {
   send_packet(packet, udpSocketFD, serverUdpAddr->ai_addr,
-              serverUdpAddr->ai_addrlen);
+              serverUdpAddr->ai_addrlen, udpEncoding, requestID);
 }
 
-void UserState::waitForUdpPacket(UdpPacket &packet) {
-  wait_for_packet(packet, udpSocketFD);
+void UserState::sampleRtt(std::chrono::duration<double> rtt) {
+  if (srtt.count() <= 0) { // the first sample
+    srtt = rtt;
+    rttvar = rtt / 2;
+  } else {
+    rttvar = rttvar * 0.75 + std::chrono::duration<double>(
+                                 std::abs((srtt - rtt).count()) * 0.25);
+    srtt = srtt * 0.875 + rtt * 0.125;
+  }
+  rto = std::clamp(srtt + rttvar * 4,
+                   std::chrono::duration<double>(UDP_RTO_MIN_MS / 1000.0),
+                   std::chrono::duration<double>(UDP_RTO_MAX_MS / 1000.0));
 }
 
 void UserState::sendUdpPacketAndWaitForReply(UdpPacket &request,
                                              UdpPacket &response) {
-  int triesLeft = UDP_RESEND_TRIES; // number of tries left
-  while (triesLeft > 0) {
-    --triesLeft;
+  drain_packets(udpSocketFD); // late replies to the requests given up on
+
+  // the attempts take consecutive IDs, and 0 is never taken
+  if (nextRequestID == 0 || nextRequestID > UINT32_MAX - UDP_RESEND_TRIES) {
+    nextRequestID = 1;
+  }
+  uint32_t firstID = nextRequestID;
+  std::chrono::steady_clock::time_point sentAt[UDP_RESEND_TRIES];
+  std::uniform_real_distribution<double> jitter(1, 1 + UDP_RTO_JITTER);
+  // however short the round trip, a slow or lossy AS gets as long as before
+  auto giveUpAt = std::chrono::steady_clock::now() +
+                  std::chrono::seconds(UDP_GIVE_UP_SECONDS);
+
+  for (uint32_t attempt = 0; attempt < UDP_RESEND_TRIES; attempt++) {
+    uint32_t requestID = nextRequestID++;
+    sentAt[attempt] = std::chrono::steady_clock::now();
+    this->sendUdpPacket(request, requestID);
+
+    auto wait = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        rto * jitter(random));
+    auto waitUntil = std::min(sentAt[attempt] + wait, giveUpAt);
+    if (attempt + 1 == UDP_RESEND_TRIES) { // the last try waits until the end
+      waitUntil = giveUpAt;
+    }
     try {
-      this->sendUdpPacket(request);
-      this->waitForUdpPacket(response);
+      uint32_t repliedID = wait_for_packet(response, udpSocketFD, udpEncoding,
+                                           waitUntil, firstID, requestID);
+      auto now = std::chrono::steady_clock::now();
+      // a text reply could be to any attempt, so it is only timed if there
+      // was a single one, as TCP does
+      if (udpEncoding == BINARY_ENCODING) {
+        sampleRtt(now - sentAt[repliedID - firstID]);
+      } else if (attempt == 0) {
+        sampleRtt(now - sentAt[0]);
+      }
       return;
     } catch (ConnectionTimeoutException &e) { // timeout
-      if (triesLeft == 0) {                   // no more tries left
+      if (std::chrono::steady_clock::now() >= giveUpAt ||
+          attempt + 1 == UDP_RESEND_TRIES) { // no more tries left
         throw;
       }
+      // kept until the next sample, as the AS may just have slowed down
+      rto = std::min(rto * 2,
+                     std::chrono::duration<double>(UDP_RTO_MAX_MS / 1000.0));
     }
   }
 }
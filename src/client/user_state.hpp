@@ -2,6 +2,9 @@
 #define USER_STATE_H
 
 #include <netdb.h>
+
+#include <chrono>
+#include <random>
 #include <string>
 
 #include "../utils/protocol.hpp"
@@ -23,6 +26,23 @@ class UserState {
   int tcpSocketFD = -1;
   struct addrinfo *serverUdpAddr = NULL;
   struct addrinfo *serverTcpAddr = NULL;
+  PacketEncoding udpEncoding = TEXT_ENCODING;
+
+  // the round trip time to the AS, estimated as TCP does (RFC 6298)
+  std::chrono::duration<double> srtt{0};   // smoothed, 0 before any sample
+  std::chrono::duration<double> rttvar{0}; // how much it varies
+  // how long to wait for a reply, backed off while requests time out
+  std::chrono::duration<double> rto{UDP_RTO_INITIAL_MS / 1000.0};
+  std::mt19937 random{std::random_device{}()}; // to jitter the waits
+  uint32_t nextRequestID;                      // of the next binary attempt
+
+  /**
+   * @brief Updates the estimated round trip time with a sample of it, and the
+   * wait for a reply with it.
+   *
+   * @param rtt The time a request took to be replied to.
+   */
+  void sampleRtt(std::chrono::duration<double> rtt);
 
   /**
    * @brief Sets up a UDP socket.
@@ -42,15 +62,9 @@ class UserState {
    * @brief Sends a UDP packet.
    *
    * @param packet The packet to send.
+   * @param requestID The ID of the attempt, if binary.
    */
-  void sendUdpPacket(UdpPacket &packet);
-
-  /**
-   * @brief Waits for a UDP packet.
-   *
-   * @param packet The packet to receive.
-   */
-  void waitForUdpPacket(UdpPacket &packet);
+  void sendUdpPacket(UdpPacket &packet, uint32_t requestID);
 
   /**
    * @brief Opens a TCP socket.
@@ -84,8 +98,10 @@ public:
    *
    * @param hostname The hostname of the server.
    * @param port The port of the server.
+   * @param encoding The encoding of UDP packets.
    */
-  UserState(std::string &hostname, std::string &port);
+  UserState(std::string &hostname, std::string &port,
+            PacketEncoding encoding);
 
   /**
    * @brief Destroys the UserState object.
@@ -94,7 +110,14 @@ public:
   ~UserState();
 
   /**
-   * @brief Sends a UDP packet and waits for a reply.
+   * @brief Sends a UDP packet and waits for a reply, sending it again if it
+   * does not arrive in time.
+   *
+   * Every wait is the estimated round trip time and a few times its
+   * variation, doubled on every attempt, and made up to a quarter longer at
+   * random, so clients that lost their packets at once do not all send them
+   * again at once. It keeps sending it until UDP_GIVE_UP_SECONDS have passed,
+   * however short the waits are.
    *
    * @param request The packet to send.
    * @param response The packet to receive.
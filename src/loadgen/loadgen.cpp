@@ -0,0 +1,534 @@
+#include "loadgen.hpp"
+#include "replay.hpp"
+
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+extern bool is_exiting; // flag to indicate whether the application is exiting
+
+static const char *COMMAND_NAMES[LOAD_COMMAND_COUNT] = {"LIN", "LST", "SRC",
+                                                        "OPA", "BID", "SAS"};
+
+// highest auction ID seen, so auctions are picked among the ones that exist
+static std::atomic<uint32_t> highestAuctionID(0);
+// the asset every simulated user uploads when it opens an auction
+static std::string assetPath;
+
+/**
+ * @brief Creates the scratch directory of the run, and moves into the
+ * directory where the downloaded assets are saved.
+ *
+ * The asset is uploaded from the scratch directory, and the downloaded assets
+ * are saved to its downloads directory, so they never clash.
+ *
+ * @param assetSize The size of the asset uploaded by OPA.
+ * @return The path of the scratch directory.
+ */
+static std::string setupScratchDirectory(uint32_t assetSize) {
+  char scratchTemplate[] = "/tmp/loadgen-XXXXXX";
+  if (mkdtemp(scratchTemplate) == NULL) {
+    throw FatalError("Failed to create a scratch directory", errno);
+  }
+  std::string scratchDir = scratchTemplate;
+  assetPath = scratchDir + SLASH + LOADGEN_ASSET_NAME;
+  write_to_file(assetPath, std::string(assetSize, 'a'));
+  create_new_directory(scratchDir + SLASH + "downloads");
+  if (chdir((scratchDir + SLASH + "downloads").c_str()) != 0) {
+    throw FatalError("Failed to enter the scratch directory", errno);
+  }
+  return scratchDir;
+}
+
+/**
+ * @brief Runs every simulated user on the command mix, and prints the report.
+ *
+ * @param config The configuration of the run.
+ */
+static void runMix(LoadgenConfig &config) {
+  std::cout << (config.rate == 0 ? "Closed-loop" : "Open-loop") << " run of "
+            << config.users << " users for " << config.duration
+            << " seconds against " << config.host << ":" << config.port
+            << std::endl;
+
+  std::vector<LoadStats> userStats(config.users);
+  std::vector<std::thread> threads;
+  std::atomic<uint64_t> slowClosed(0);
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < config.slowConnections; i++) {
+    threads.emplace_back(holdSlowConnection, std::ref(config),
+                         std::ref(slowClosed));
+  }
+  for (uint32_t i = 0; i < config.users; i++) {
+    threads.emplace_back(simulateUser, std::ref(config), i,
+                         std::ref(userStats[i]));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (config.slowConnections > 0) {
+    std::cout << config.slowConnections << " slow connections were closed by "
+              << "the AS " << slowClosed << " times" << std::endl;
+  }
+
+  LoadStats stats;
+  for (auto &userStat : userStats) {
+    for (size_t c = 0; c < LOAD_COMMAND_COUNT; c++) {
+      stats[c].merge(userStat[c]);
+    }
+  }
+  printReport(COMMAND_NAMES, stats.data(), LOAD_COMMAND_COUNT,
+              std::chrono::duration<double>(end - start).count(), false);
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    setup_custom_signal_handlers();   // change the signal handlers to our own
+    LoadgenConfig config(argc, argv); // parse command-line arguments
+
+    if (config.help) { // if the help flag is set, print the help menu and exit
+      config.printHelp(std::cout);
+      return EXIT_SUCCESS;
+    }
+
+    // loaded first, as their paths may be relative to the working directory
+    std::vector<Script> scripts = loadScripts(config.scripts);
+    std::string scratchDir = setupScratchDirectory(config.assetSize);
+    if (scripts.empty()) {
+      runMix(config);
+    } else {
+      replayScripts(config, scripts, scratchDir);
+    }
+
+    std::filesystem::remove_all(scratchDir);
+    return EXIT_SUCCESS;
+
+  } catch (std::exception &e) { // catch any exceptions thrown
+    std::cerr << "Encountered fatal error while running the load generator. "
+                 "Shutting down..."
+              << std::endl
+              << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+/**
+ * @brief Parses a numeric option, exiting if it is not a number.
+ *
+ * @param name The name of the option, for the error message.
+ * @param value The value of the option.
+ * @return The number.
+ */
+static uint32_t parseNumberOption(const char *name, const std::string &value) {
+  if (value.empty() || value.length() > 9 || !is_digits(value)) {
+    std::cerr << "Invalid " << name << ": " << value << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return (uint32_t)std::stoul(value);
+}
+
+LoadgenConfig::LoadgenConfig(int argc, char *argv[]) {
+  this->programPath = argv[0]; // set the program path to the first argument
+  parseMix(LOADGEN_MIX);
+
+  // -n -p -u -d -r -m -i -s -f -z -k need an argument, -b and -h do not
+  int opt;
+  while ((opt = getopt(argc, argv, "hn:p:bu:d:r:m:i:s:f:z:k:")) != -1) {
+    switch (opt) {
+    case 'h':
+      this->help = true;
+      break;
+    case 'b':
+      this->encoding = BINARY_ENCODING;
+      break;
+    case 'n':
+      this->host = std::string(optarg);
+      break;
+    case 'p':
+      this->port = std::string(optarg);
+      break;
+    case 'u':
+      this->users = parseNumberOption("user count", optarg);
+      break;
+    case 'd':
+      this->duration = parseNumberOption("duration", optarg);
+      break;
+    case 'r':
+      this->rate = parseNumberOption("rate", optarg);
+      break;
+    case 'm':
+      parseMix(optarg);
+      break;
+    case 'i':
+      this->firstUserID = parseNumberOption("first user ID", optarg);
+      break;
+    case 's':
+      this->assetSize = parseNumberOption("asset size", optarg);
+      break;
+    case 'f':
+      this->scripts.push_back(std::string(optarg));
+      break;
+    case 'z':
+      this->sleepFactor = parseNumberOption("sleep factor", optarg);
+      break;
+    case 'k':
+      this->slowConnections = parseNumberOption("slow connections", optarg);
+      break;
+    default:
+      std::cerr << std::endl; // print a newline before printing help
+      printHelp(std::cerr);
+      exit(EXIT_FAILURE);
+    }
+  }
+  validate_port_number(port); // validate the port number
+
+  if (users == 0 || firstUserID + users - 1 > 999999) {
+    std::cerr << "The simulated users do not fit in the user IDs" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (sleepFactor == 0) {
+    std::cerr << "Invalid sleep factor: 0" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (validateAssetFileSize(assetSize) == INVALID) {
+    std::cerr << "Invalid asset size: " << assetSize << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void LoadgenConfig::parseMix(const std::string &mixStr) {
+  mix.fill(0);
+  std::stringstream stream(mixStr);
+  std::string entry;
+  while (std::getline(stream, entry, ',')) {
+    size_t equals = entry.find('=');
+    auto name = std::find(COMMAND_NAMES, COMMAND_NAMES + LOAD_COMMAND_COUNT,
+                          entry.substr(0, equals));
+    if (equals == std::string::npos ||
+        name == COMMAND_NAMES + LOAD_COMMAND_COUNT) {
+      std::cerr << "Invalid command mix entry: " << entry << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    mix[(size_t)(name - COMMAND_NAMES)] =
+        parseNumberOption("command weight", entry.substr(equals + 1));
+  }
+  if (std::all_of(mix.begin(), mix.end(), [](uint32_t w) { return w == 0; })) {
+    std::cerr << "The command mix is empty" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void LoadgenConfig::printHelp(std::ostream &stream) {
+  stream << "Usage: " << programPath
+         << " [-n ASIP] [-p ASport] [-b] [-u users] [-d seconds] [-r rate]"
+            " [-m mix] [-i UID] [-s bytes] [-f script]... [-z factor]"
+            " [-k connections] [-h]"
+         << std::endl;
+  stream << "Available options:" << std::endl;
+  stream << "-n ASIP\t\tSet hostname of Auction Server. Default: "
+         << DEFAULT_HOSTNAME << std::endl;
+  stream << "-p ASport\tSet port of Auction Server. Default: " << DEFAULT_PORT
+         << std::endl;
+  stream << "-b\t\tSend UDP requests in the binary encoding." << std::endl;
+  stream << "-u users\tSet the number of simulated users. Default: "
+         << LOADGEN_USERS << std::endl;
+  stream << "-d seconds\tSet how long to run for. Default: "
+         << LOADGEN_DURATION_SECONDS << std::endl;
+  stream << "-r rate\t\tIssue this many requests per second from every user "
+            "(open-loop), instead of one as soon as the last one is answered "
+            "(closed-loop)."
+         << std::endl;
+  stream << "-m mix\t\tSet the weights of the commands. Default: "
+         << LOADGEN_MIX << std::endl;
+  stream << "-i UID\t\tSet the user ID of the first simulated user. Default: "
+         << LOADGEN_FIRST_USER_ID << std::endl;
+  stream << "-s bytes\tSet the size of the uploaded asset. Default: "
+         << LOADGEN_ASSET_SIZE << std::endl;
+  stream << "-f script\tReplay a user script, with -u copies running at once, "
+            "instead of the mix. Can be given more than once."
+         << std::endl;
+  stream << "-z factor\tMake the sleeps of the scripts this many times "
+            "shorter. Default: 1"
+         << std::endl;
+  stream << "-k connections\tHold this many TCP connections open without "
+            "finishing their request, as slow clients, during the mix."
+         << std::endl;
+  stream << "-h\t\tPrint this menu." << std::endl;
+}
+
+void CommandStats::merge(const CommandStats &other) {
+  latencies.insert(latencies.end(), other.latencies.begin(),
+                   other.latencies.end());
+  requests += other.requests;
+  errors += other.errors;
+  timeouts += other.timeouts;
+  wrong += other.wrong;
+}
+
+/**
+ * @brief Records that an auction exists.
+ *
+ * @param auctionID The ID of the auction.
+ */
+static void seeAuction(const std::string &auctionID) {
+  uint32_t id = (uint32_t)std::stoul(auctionID);
+  uint32_t highest = highestAuctionID.load();
+  while (id > highest &&
+         !highestAuctionID.compare_exchange_weak(highest, id)) {
+    // another user raised it first, and highest now holds its value
+  }
+}
+
+/**
+ * @brief Picks one of the auctions seen so far.
+ *
+ * @param rng The random generator of the user.
+ * @return The ID of the auction.
+ */
+static std::string pickAuction(std::mt19937 &rng) {
+  uint32_t highest = std::max(highestAuctionID.load(), 1u);
+  uint32_t id = std::uniform_int_distribution<uint32_t>(1, highest)(rng);
+  return intToStringWithZeros((int)id, AUCTION_ID_LENGTH);
+}
+
+/**
+ * @brief Issues a command and waits for its reply.
+ *
+ * @param state The connection of the user.
+ * @param command The command to issue.
+ * @param userID The user ID of the user.
+ * @param rng The random generator of the user.
+ * @return true if the reply was not an error, given that refusals such as a
+ * bid that is too low are normal outcomes under load.
+ */
+static bool issueCommand(UserState &state, LoadCommand command,
+                         const std::string &userID, std::mt19937 &rng) {
+  switch (command) {
+  case LOAD_LIN: {
+    LoginRequest request;
+    request.userID = userID;
+    request.password = LOADGEN_PASSWORD;
+    LoginResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return response.status == LoginResponse::OK ||
+           response.status == LoginResponse::REG;
+  }
+  case LOAD_LST: {
+    ListAuctionsRequest request;
+    ListAuctionsResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    for (auto &auction : response.auctions) {
+      seeAuction(auction.first);
+    }
+    return response.status != ListAuctionsResponse::ERR;
+  }
+  case LOAD_SRC: {
+    ShowRecordRequest request;
+    request.auctionID = pickAuction(rng);
+    ShowRecordResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return response.status != ShowRecordResponse::ERR;
+  }
+  case LOAD_OPA: {
+    OpenAuctionRequest request;
+    request.userID = userID;
+    request.password = LOADGEN_PASSWORD;
+    request.auctionName = "loadgen";
+    request.startValue = std::uniform_int_distribution<uint32_t>(1, 999)(rng);
+    request.timeActive = LOADGEN_AUCTION_DURATION;
+    request.assetFileName = LOADGEN_ASSET_NAME;
+    request.assetPath = assetPath;
+    request.assetSize = (uint32_t)std::filesystem::file_size(assetPath);
+    OpenAuctionResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    if (response.status == OpenAuctionResponse::OK) {
+      seeAuction(response.auctionID);
+    }
+    return response.status == OpenAuctionResponse::OK;
+  }
+  case LOAD_BID: {
+    BidRequest request;
+    request.userID = userID;
+    request.password = LOADGEN_PASSWORD;
+    request.auctionID = pickAuction(rng);
+    request.bidValue = std::uniform_int_distribution<uint32_t>(1, 99999)(rng);
+    BidResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    return response.status != BidResponse::NLG &&
+           response.status != BidResponse::ERR;
+  }
+  case LOAD_SAS: {
+    ShowAssetRequest request;
+    request.auctionID = pickAuction(rng);
+    ShowAssetResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    return response.status != ShowAssetResponse::ERR;
+  }
+  case LOAD_COMMAND_COUNT:
+  default:
+    return false;
+  }
+}
+
+void simulateUser(LoadgenConfig &config, uint32_t index, LoadStats &stats) {
+  using std::chrono::steady_clock;
+
+  std::string userID =
+      intToStringWithZeros((int)(config.firstUserID + index), USER_ID_LENGTH);
+  std::mt19937 rng(config.firstUserID + index);
+  std::discrete_distribution<int> mix(config.mix.begin(), config.mix.end());
+
+  try {
+    UserState state(config.host, config.port, config.encoding);
+
+    auto start = steady_clock::now();
+    auto end = start + std::chrono::seconds(config.duration);
+    steady_clock::duration period = steady_clock::duration::zero();
+    auto due = start;
+    if (config.rate != 0) {
+      period = std::chrono::duration_cast<steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / config.rate));
+      // spread the first requests of the users over a period
+      due += period * index / config.users;
+    }
+
+    // the first command logs the user in, for the commands that need it
+    LoadCommand command = LOAD_LIN;
+    while (!is_exiting) {
+      auto sent = steady_clock::now();
+      if (config.rate != 0) {
+        if (due >= end || sent >= end) { // requests still due are dropped
+          break;
+        }
+        std::this_thread::sleep_until(due);
+        sent = due; // even if the last request made this one late
+        due += period;
+      } else if (sent >= end) {
+        break;
+      }
+
+      CommandStats &commandStats = stats[command];
+      commandStats.requests++;
+      try {
+        if (!issueCommand(state, command, userID, rng)) {
+          commandStats.errors++;
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            steady_clock::now() - sent);
+        commandStats.latencies.push_back((uint64_t)latency.count());
+      } catch (ConnectionTimeoutException &e) {
+        commandStats.timeouts++;
+      } catch (OperationCancelledException &e) {
+        break;
+      } catch (FatalError &e) {
+        throw;
+      } catch (std::exception &e) { // a malformed or unexpected reply
+        commandStats.errors++;
+      }
+      command = (LoadCommand)mix(rng);
+    }
+  } catch (std::exception &e) {
+    std::cerr << "User " << userID << " stopped: " << e.what() << std::endl;
+  }
+}
+
+void holdSlowConnection(LoadgenConfig &config, std::atomic<uint64_t> &closed) {
+  using std::chrono::steady_clock;
+  try {
+    UserState state(config.host, config.port, config.encoding);
+    struct addrinfo *addr = state.getServerTcpAddr();
+    auto end = steady_clock::now() + std::chrono::seconds(config.duration);
+
+    while (!is_exiting && steady_clock::now() < end) {
+      int fd = socket(AF_INET, SOCK_STREAM, 0);
+      if (fd == -1) {
+        throw FatalError("Failed to create a TCP socket", errno);
+      }
+      // the start of a packet ID, so the worker waits for the rest of it
+      if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0 &&
+          send(fd, "O", 1, MSG_NOSIGNAL) == 1) {
+        struct pollfd pollFD = {fd, POLLIN, 0};
+        while (!is_exiting && steady_clock::now() < end) {
+          if (poll(&pollFD, 1, 100) > 0) { // closed, or replied to with ERR
+            closed++;
+            break;
+          }
+        }
+      }
+      close(fd);
+      // as a client would, rather than hammering the AS with connections
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  } catch (std::exception &e) {
+    std::cerr << "Slow connection stopped: " << e.what() << std::endl;
+  }
+}
+
+/**
+ * @brief Gets a percentile of sorted latencies.
+ *
+ * @param latencies The latencies, sorted.
+ * @param percentile The percentile, between 0 and 1.
+ * @return The latency, in milliseconds.
+ */
+static double percentile(const std::vector<uint64_t> &latencies,
+                         double percentile) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  size_t rank = (size_t)std::ceil(percentile * (double)latencies.size());
+  return (double)latencies[std::max(rank, (size_t)1) - 1] / 1000;
+}
+
+void printReport(const char *const names[], CommandStats stats[],
+                 size_t count, double seconds, bool showWrong) {
+  std::cout << std::left << std::setw(12) << "command" << std::right
+            << std::setw(10) << "requests" << std::setw(12) << "requests/s"
+            << std::setw(9) << "errors" << std::setw(10) << "timeouts";
+  if (showWrong) {
+    std::cout << std::setw(8) << "wrong";
+  }
+  std::cout << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+            << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms"
+            << std::endl;
+
+  uint64_t total = 0;
+  for (size_t c = 0; c < count; c++) {
+    CommandStats &commandStats = stats[c];
+    if (commandStats.requests == 0) {
+      continue;
+    }
+    std::sort(commandStats.latencies.begin(), commandStats.latencies.end());
+    total += commandStats.requests;
+
+    std::cout << std::left << std::setw(12) << names[c] << std::right
+              << std::fixed << std::setw(10) << commandStats.requests
+              << std::setw(12) << std::setprecision(1)
+              << (double)commandStats.requests / seconds << std::setw(9)
+              << commandStats.errors << std::setw(10) << commandStats.timeouts;
+    if (showWrong) {
+      std::cout << std::setw(8) << commandStats.wrong;
+    }
+    std::cout << std::setprecision(3) << std::setw(10)
+              << percentile(commandStats.latencies, 0.5) << std::setw(10)
+              << percentile(commandStats.latencies, 0.99) << std::setw(10)
+              << percentile(commandStats.latencies, 0.999) << std::setw(10)
+              << percentile(commandStats.latencies, 1) << std::endl;
+  }
+  std::cout << std::left << std::setw(12) << "total" << std::right
+            << std::setw(10) << total << std::setw(12) << std::setprecision(1)
+            << (double)total / seconds << std::endl;
+}
@@ -0,0 +1,138 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../client/user_state.hpp"
+#include "../utils/constants.hpp"
+#include "../utils/protocol.hpp"
+#include "../utils/utils.hpp"
+
+/**
+ * @brief The commands a simulated user can issue.
+ */
+enum LoadCommand {
+  LOAD_LIN, // login, over UDP
+  LOAD_LST, // list every auction, over UDP
+  LOAD_SRC, // show the record of an auction, over UDP
+  LOAD_OPA, // open an auction, over TCP
+  LOAD_BID, // bid on an auction, over TCP
+  LOAD_SAS, // download the asset of an auction, over TCP
+  LOAD_COMMAND_COUNT
+};
+
+/**
+ * @class LoadgenConfig
+ *
+ * @brief Represents configuration options for the load generator.
+ *
+ * Besides the AS to load, the options set how many users are simulated, for
+ * how long, the mix of commands they issue and, in open-loop mode, the rate
+ * at which they issue them. When scripts are given, every user replays one of
+ * them instead.
+ */
+class LoadgenConfig {
+  /**
+   * @brief Parses the weights of the commands in the mix.
+   *
+   * @param mixStr The mix, as in "LIN=1,LST=4,BID=2".
+   */
+  void parseMix(const std::string &mixStr);
+
+public:
+  char *programPath;
+  std::string host = DEFAULT_HOSTNAME;
+  std::string port = DEFAULT_PORT;
+  bool help = false;
+  PacketEncoding encoding = TEXT_ENCODING;
+  uint32_t users = LOADGEN_USERS;
+  uint32_t duration = LOADGEN_DURATION_SECONDS;
+  uint32_t rate = 0; // requests per second of every user, 0 for closed-loop
+  uint32_t firstUserID = LOADGEN_FIRST_USER_ID;
+  uint32_t assetSize = LOADGEN_ASSET_SIZE;
+  std::vector<std::string> scripts; // user scripts to replay instead of the mix
+  uint32_t sleepFactor = 1;         // how many times shorter script sleeps are
+  uint32_t slowConnections = 0;     // TCP connections never sending a request
+  std::array<uint32_t, LOAD_COMMAND_COUNT> mix = {};
+
+  /**
+   * @brief Constructs a new LoadgenConfig object.
+   *
+   * @param argc The number of command-line arguments.
+   * @param argv The command-line arguments.
+   */
+  LoadgenConfig(int argc, char *argv[]);
+
+  /**
+   * @brief Prints the help menu.
+   *
+   * @param stream The output stream to print to.
+   */
+  void printHelp(std::ostream &stream);
+};
+
+/**
+ * @brief The results of a command, gathered by a simulated user and then
+ * merged with the ones of every other user.
+ */
+struct CommandStats {
+  std::vector<uint64_t> latencies; // in microseconds, of every answered request
+  uint64_t requests = 0; // requests sent
+  uint64_t errors = 0;   // requests answered with an error or a bad packet
+  uint64_t timeouts = 0; // requests never answered
+  uint64_t wrong = 0;    // replayed replies unlike the ones of a solo run
+
+  /**
+   * @brief Adds the results of another user.
+   *
+   * @param other The results to add.
+   */
+  void merge(const CommandStats &other);
+};
+
+typedef std::array<CommandStats, LOAD_COMMAND_COUNT> LoadStats;
+
+/**
+ * @brief Runs a simulated user until the run is over.
+ *
+ * The user logs in and then issues commands picked at random from the mix,
+ * each one as soon as the last one is answered in closed-loop mode, or at a
+ * fixed rate in open-loop mode. In open-loop mode the latency is measured from
+ * when a request was due rather than from when it was sent, so a slow AS that
+ * holds up the next requests is not hidden by it (coordinated omission).
+ *
+ * @param config The configuration of the run.
+ * @param index The index of the user, which picks its user ID.
+ * @param stats Where to gather the results of the user.
+ */
+void simulateUser(LoadgenConfig &config, uint32_t index, LoadStats &stats);
+
+/**
+ * @brief Holds a TCP connection open without ever finishing its request, as a
+ * slow client would, opening it again every time the AS closes it, until the
+ * run is over.
+ *
+ * @param config The configuration of the run.
+ * @param closed Where to count the times the AS closed the connection.
+ */
+void holdSlowConnection(LoadgenConfig &config, std::atomic<uint64_t> &closed);
+
+/**
+ * @brief Prints the throughput, the latency percentiles and the error rates
+ * of every command that was sent.
+ *
+ * @param names The names of the commands.
+ * @param stats The results of every command, merged across users.
+ * @param count The number of commands.
+ * @param seconds How long the run took.
+ * @param showWrong Whether to print the replies unlike the ones of a solo run.
+ */
+void printReport(const char *const names[], CommandStats stats[],
+                 size_t count, double seconds, bool showWrong);
+
+#endif
@@ -0,0 +1,490 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+extern bool is_exiting; // flag to indicate whether the application is exiting
+
+static const char *REPLAY_COMMAND_NAMES[REPLAY_COMMAND_COUNT] = {
+    "login", "logout", "unregister", "open", "close", "myauctions",
+    "mybids", "list", "show_asset", "bid", "show_record"};
+
+// outcomes of a line besides the status of its reply, which is never negative
+#define OUTCOME_SKIPPED (-1) // not sent, as the user application would not
+#define OUTCOME_TIMEOUT (-2) // never answered
+#define OUTCOME_ERROR (-3)   // answered with ERR or a packet that is not valid
+
+typedef std::array<CommandStats, REPLAY_COMMAND_COUNT> ReplayStats;
+
+/**
+ * @brief Parses a line of a user script.
+ *
+ * @param text The line.
+ * @return The line, parsed.
+ */
+static ScriptLine parseLine(const std::string &text) {
+  ScriptLine line;
+  line.args = parse_args(text);
+  line.command = REPLAY_UNKNOWN;
+  if (line.args.empty()) {
+    return line;
+  }
+
+  std::string name = line.args[0];
+  line.args.erase(line.args.begin());
+  if (name == "sleep") {
+    line.command = REPLAY_SLEEP;
+  } else if (name == "exit") {
+    line.command = REPLAY_EXIT;
+  } else if (name == "ma") {
+    line.command = REPLAY_MYAUCTIONS;
+  } else if (name == "mb") {
+    line.command = REPLAY_MYBIDS;
+  } else if (name == "l") {
+    line.command = REPLAY_LIST;
+  } else if (name == "sa") {
+    line.command = REPLAY_SHOW_ASSET;
+  } else if (name == "b") {
+    line.command = REPLAY_BID;
+  } else if (name == "sr") {
+    line.command = REPLAY_SHOW_RECORD;
+  } else {
+    auto it = std::find(REPLAY_COMMAND_NAMES,
+                        REPLAY_COMMAND_NAMES + REPLAY_COMMAND_COUNT, name);
+    if (it != REPLAY_COMMAND_NAMES + REPLAY_COMMAND_COUNT) {
+      line.command = (ReplayCommand)(it - REPLAY_COMMAND_NAMES);
+    }
+  }
+  return line;
+}
+
+std::vector<Script> loadScripts(const std::vector<std::string> &paths) {
+  std::vector<Script> scripts;
+  for (const std::string &path : paths) {
+    std::ifstream file(path);
+    if (!file.good()) {
+      throw FatalError("Failed to read the script " + path);
+    }
+
+    Script script;
+    script.path = path;
+    std::filesystem::path scriptDir =
+        std::filesystem::absolute(path).parent_path();
+    std::string text;
+    while (std::getline(file, text)) {
+      ScriptLine line = parseLine(text);
+      if (line.command == REPLAY_LOGIN && !line.args.empty() &&
+          std::find(script.userIDs.begin(), script.userIDs.end(),
+                    line.args[0]) == script.userIDs.end()) {
+        script.userIDs.push_back(line.args[0]);
+      } else if (line.command == REPLAY_OPEN && line.args.size() > 1) {
+        std::filesystem::path asset = scriptDir / line.args[1];
+        script.assets[line.args[1]] =
+            std::filesystem::exists(asset) ? asset.string() : "";
+      }
+      script.lines.push_back(line);
+    }
+    scripts.push_back(script);
+  }
+  return scripts;
+}
+
+/**
+ * @class ScriptCopy
+ *
+ * @brief Represents a copy of a user script being replayed, with its own user
+ * IDs, auctions and connection to the AS.
+ */
+class ScriptCopy {
+  const Script &script;
+  UserState state;
+  std::map<std::string, std::string> userIDs; // of the script, to the copy's
+  std::vector<std::string> openedAuctions;    // in the order they were opened
+  std::string userID;                         // logged in, if not empty
+  std::string password;
+
+  /**
+   * @brief Gets the auction ID a copy uses for an auction ID of the script.
+   *
+   * @param auctionID The auction ID in the script.
+   * @return The ID of the auction the copy opened in its place, or the same ID
+   * if the copy did not open that many auctions.
+   */
+  std::string mapAuction(const std::string &auctionID);
+
+  /**
+   * @brief Sends the request of a line and waits for its reply.
+   *
+   * @param line The line to send.
+   * @return The status of the reply, or one of the other outcomes.
+   */
+  int issue(const ScriptLine &line);
+
+public:
+  std::vector<int> outcomes; // of every line
+
+  /**
+   * @brief Constructs a new ScriptCopy object.
+   *
+   * @param config The configuration of the run.
+   * @param script The script to replay.
+   * @param firstUserID The first of the user IDs the copy takes, one for every
+   * user ID of the script.
+   */
+  ScriptCopy(LoadgenConfig &config, const Script &script,
+             uint32_t firstUserID);
+
+  /**
+   * @brief Replays every line of the script.
+   *
+   * @param sleepFactor How many times shorter the sleeps are.
+   * @param stats Where to gather the results of the copy.
+   */
+  void run(uint32_t sleepFactor, ReplayStats &stats);
+};
+
+ScriptCopy::ScriptCopy(LoadgenConfig &config, const Script &__script,
+                       uint32_t firstUserID)
+    : script(__script), state(config.host, config.port, config.encoding),
+      outcomes(__script.lines.size(), OUTCOME_SKIPPED) {
+  for (const std::string &scriptUserID : script.userIDs) {
+    userIDs[scriptUserID] =
+        intToStringWithZeros((int)firstUserID++, USER_ID_LENGTH);
+  }
+}
+
+std::string ScriptCopy::mapAuction(const std::string &auctionID) {
+  if (validateAuctionID(auctionID) == INVALID) {
+    return auctionID;
+  }
+  size_t index = std::stoul(auctionID);
+  if (index == 0 || index > openedAuctions.size()) {
+    return auctionID;
+  }
+  return openedAuctions[index - 1];
+}
+
+/**
+ * @brief Gets the outcome of a reply.
+ *
+ * @param response The reply.
+ * @return The status of the reply, or OUTCOME_ERROR if it is ERR.
+ */
+template <typename Response> static int outcomeOf(Response &response) {
+  return response.status == Response::ERR ? OUTCOME_ERROR
+                                          : (int)response.status;
+}
+
+int ScriptCopy::issue(const ScriptLine &line) {
+  const std::vector<std::string> &args = line.args;
+  // the user application checks the arguments, and if a user is logged in,
+  // before sending anything
+  switch (line.command) {
+  case REPLAY_LOGIN: {
+    if (args.size() != LOGIN_ARGS_NUM ||
+        validateUserID(args[0]) == INVALID ||
+        validatePassword(args[1]) == INVALID) {
+      return OUTCOME_SKIPPED;
+    }
+    LoginRequest request;
+    request.userID = userIDs[args[0]];
+    request.password = args[1];
+    LoginResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    if (response.status == LoginResponse::OK ||
+        response.status == LoginResponse::REG) {
+      userID = request.userID;
+      password = request.password;
+    }
+    return outcomeOf(response);
+  }
+  case REPLAY_LOGOUT: {
+    if (args.size() != LOGOUT_ARGS_NUM || userID.empty()) {
+      return OUTCOME_SKIPPED;
+    }
+    LogoutRequest request;
+    request.userID = userID;
+    request.password = password;
+    LogoutResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    if (response.status == LogoutResponse::OK) {
+      userID.clear();
+      password.clear();
+    }
+    return outcomeOf(response);
+  }
+  case REPLAY_UNREGISTER: {
+    if (args.size() != UNREGISTER_ARGS_NUM || userID.empty()) {
+      return OUTCOME_SKIPPED;
+    }
+    UnregisterRequest request;
+    request.userID = userID;
+    request.password = password;
+    UnregisterResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    if (response.status == UnregisterResponse::OK) {
+      userID.clear();
+      password.clear();
+    }
+    return outcomeOf(response);
+  }
+  case REPLAY_OPEN: {
+    if (args.size() != OPEN_AUCTION_ARGS_NUM || userID.empty() ||
+        validateStartValue(args[2]) == INVALID ||
+        validateAuctionDuration(args[3]) == INVALID) {
+      return OUTCOME_SKIPPED;
+    }
+    OpenAuctionRequest request;
+    request.userID = userID;
+    request.password = password;
+    request.auctionName = args[0];
+    request.assetFileName = args[1];
+    request.assetPath = script.assets.at(args[1]);
+    request.assetSize = (uint32_t)std::filesystem::file_size(request.assetPath);
+    request.startValue = (uint32_t)std::stoul(args[2]);
+    request.timeActive = (uint32_t)std::stoul(args[3]);
+    OpenAuctionResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    if (response.status == OpenAuctionResponse::OK) {
+      openedAuctions.push_back(response.auctionID);
+    }
+    return outcomeOf(response);
+  }
+  case REPLAY_CLOSE: {
+    if (args.size() != CLOSE_AUCTION_ARGS_NUM || userID.empty()) {
+      return OUTCOME_SKIPPED;
+    }
+    CloseAuctionRequest request;
+    request.userID = userID;
+    request.password = password;
+    request.auctionID = mapAuction(args[0]);
+    CloseAuctionResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_MYAUCTIONS: {
+    if (args.size() != LIST_USER_AUCTIONS_ARGS_NUM) {
+      return OUTCOME_SKIPPED;
+    }
+    ListUserAuctionsRequest request;
+    request.userID = userID;
+    ListUserAuctionsResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_MYBIDS: {
+    if (args.size() != LIST_USER_BIDS_ARGS_NUM) {
+      return OUTCOME_SKIPPED;
+    }
+    ListUserBidsRequest request;
+    request.userID = userID;
+    ListUserBidsResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_LIST: {
+    if (args.size() != LIST_AUCTIONS_ARGS_NUM) {
+      return OUTCOME_SKIPPED;
+    }
+    ListAuctionsRequest request;
+    ListAuctionsResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_SHOW_ASSET: {
+    if (args.size() != SHOW_ASSETS_ARGS_NUM) {
+      return OUTCOME_SKIPPED;
+    }
+    ShowAssetRequest request;
+    request.auctionID = mapAuction(args[0]);
+    ShowAssetResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_BID: {
+    if (args.size() != BID_ARGS_NUM || userID.empty() ||
+        validateBidValue(args[1]) == INVALID) {
+      return OUTCOME_SKIPPED;
+    }
+    BidRequest request;
+    request.userID = userID;
+    request.password = password;
+    request.auctionID = mapAuction(args[0]);
+    request.bidValue = (uint32_t)std::stoul(args[1]);
+    BidResponse response;
+    state.sendTcpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_SHOW_RECORD: {
+    if (args.size() != SHOW_RECORD_ARGS_NUM) {
+      return OUTCOME_SKIPPED;
+    }
+    ShowRecordRequest request;
+    request.auctionID = mapAuction(args[0]);
+    ShowRecordResponse response;
+    state.sendUdpPacketAndWaitForReply(request, response);
+    return outcomeOf(response);
+  }
+  case REPLAY_COMMAND_COUNT:
+  case REPLAY_SLEEP:
+  case REPLAY_EXIT:
+  case REPLAY_UNKNOWN:
+  default:
+    return OUTCOME_SKIPPED;
+  }
+}
+
+void ScriptCopy::run(uint32_t sleepFactor, ReplayStats &stats) {
+  for (size_t i = 0; i < script.lines.size() && !is_exiting; i++) {
+    const ScriptLine &line = script.lines[i];
+    if (line.command == REPLAY_SLEEP) {
+      if (!line.args.empty() && is_digits(line.args[0])) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(
+            std::stod(line.args[0]) / sleepFactor));
+      }
+      continue;
+    } else if (line.command == REPLAY_EXIT) {
+      if (userID.empty()) { // the user application only exits if logged out
+        break;
+      }
+      continue;
+    } else if (line.command >= REPLAY_COMMAND_COUNT) {
+      continue;
+    }
+
+    auto sent = std::chrono::steady_clock::now();
+    int outcome;
+    try {
+      outcome = issue(line);
+    } catch (ConnectionTimeoutException &e) {
+      outcome = OUTCOME_TIMEOUT;
+    } catch (OperationCancelledException &e) {
+      break;
+    } catch (FatalError &e) {
+      throw;
+    } catch (std::exception &e) { // a malformed or unexpected reply
+      outcome = OUTCOME_ERROR;
+    }
+    outcomes[i] = outcome;
+    if (outcome == OUTCOME_SKIPPED) {
+      continue;
+    }
+
+    CommandStats &commandStats = stats[line.command];
+    commandStats.requests++;
+    if (outcome == OUTCOME_TIMEOUT) {
+      commandStats.timeouts++;
+      continue;
+    } else if (outcome == OUTCOME_ERROR) {
+      commandStats.errors++;
+    }
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sent);
+    commandStats.latencies.push_back((uint64_t)latency.count());
+  }
+}
+
+/**
+ * @brief Replays a copy of a script, reporting why if it could not.
+ *
+ * @param copy The copy to replay.
+ * @param sleepFactor How many times shorter the sleeps are.
+ * @param stats Where to gather the results of the copy.
+ */
+static void replayCopy(ScriptCopy &copy, uint32_t sleepFactor,
+                       ReplayStats &stats) {
+  try {
+    copy.run(sleepFactor, stats);
+  } catch (std::exception &e) {
+    std::cerr << "Replay stopped: " << e.what() << std::endl;
+  }
+}
+
+void replayScripts(LoadgenConfig &config, std::vector<Script> &scripts,
+                   const std::string &scratchDir) {
+  // assets that are not next to their script are made up
+  std::string assetDir = scratchDir + SLASH + "assets";
+  create_new_directory(assetDir);
+  for (Script &script : scripts) {
+    for (auto &asset : script.assets) {
+      if (asset.second.empty()) {
+        asset.second = assetDir + SLASH + asset.first;
+        write_to_file(asset.second, std::string(config.assetSize, 'a'));
+      }
+    }
+  }
+
+  uint32_t nextUserID = config.firstUserID;
+  size_t userIDCount = 0;
+  for (Script &script : scripts) {
+    userIDCount += script.userIDs.size() * (config.users + 1);
+  }
+  if (nextUserID + userIDCount > 1000000) {
+    throw FatalError("The copies of the scripts do not fit in the user IDs");
+  }
+
+  std::cout << "Replaying " << scripts.size() << " scripts, alone and then "
+            << config.users << " copies of each at once, against "
+            << config.host << ":" << config.port << std::endl;
+
+  // the replies of every script when it runs alone
+  std::vector<std::vector<int>> soloOutcomes;
+  for (Script &script : scripts) {
+    ReplayStats soloStats;
+    ScriptCopy solo(config, script, nextUserID);
+    nextUserID += (uint32_t)script.userIDs.size();
+    replayCopy(solo, config.sleepFactor, soloStats);
+    soloOutcomes.push_back(solo.outcomes);
+  }
+
+  std::vector<std::unique_ptr<ScriptCopy>> copies;
+  std::vector<size_t> copyScripts; // the script of every copy
+  for (size_t s = 0; s < scripts.size(); s++) {
+    for (uint32_t i = 0; i < config.users; i++) {
+      copies.push_back(
+          std::make_unique<ScriptCopy>(config, scripts[s], nextUserID));
+      copyScripts.push_back(s);
+      nextUserID += (uint32_t)scripts[s].userIDs.size();
+    }
+  }
+
+  std::vector<ReplayStats> copyStats(copies.size());
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t c = 0; c < copies.size(); c++) {
+    threads.emplace_back(replayCopy, std::ref(*copies[c]), config.sleepFactor,
+                         std::ref(copyStats[c]));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  ReplayStats stats;
+  std::vector<uint64_t> scriptWrong(scripts.size(), 0);
+  for (size_t c = 0; c < copies.size(); c++) {
+    const Script &script = scripts[copyScripts[c]];
+    const std::vector<int> &solo = soloOutcomes[copyScripts[c]];
+    for (size_t i = 0; i < script.lines.size(); i++) {
+      if (script.lines[i].command < REPLAY_COMMAND_COUNT &&
+          copies[c]->outcomes[i] != solo[i]) {
+        copyStats[c][script.lines[i].command].wrong++;
+        scriptWrong[copyScripts[c]]++;
+      }
+    }
+    for (size_t r = 0; r < REPLAY_COMMAND_COUNT; r++) {
+      stats[r].merge(copyStats[c][r]);
+    }
+  }
+
+  printReport(REPLAY_COMMAND_NAMES, stats.data(), REPLAY_COMMAND_COUNT,
+              std::chrono::duration<double>(end - start).count(), true);
+  for (size_t s = 0; s < scripts.size(); s++) {
+    std::cout << scripts[s].path << ": " << scriptWrong[s]
+              << " replies unlike the solo run" << std::endl;
+  }
+}
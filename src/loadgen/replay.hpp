@@ -0,0 +1,78 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "loadgen.hpp"
+
+/**
+ * @brief The commands of a user script, named as in the user application.
+ */
+enum ReplayCommand {
+  REPLAY_LOGIN,
+  REPLAY_LOGOUT,
+  REPLAY_UNREGISTER,
+  REPLAY_OPEN,
+  REPLAY_CLOSE,
+  REPLAY_MYAUCTIONS,
+  REPLAY_MYBIDS,
+  REPLAY_LIST,
+  REPLAY_SHOW_ASSET,
+  REPLAY_BID,
+  REPLAY_SHOW_RECORD,
+  REPLAY_COMMAND_COUNT,
+  // lines that send no request, and so have no results
+  REPLAY_SLEEP,
+  REPLAY_EXIT,
+  REPLAY_UNKNOWN
+};
+
+/**
+ * @brief A line of a user script.
+ */
+struct ScriptLine {
+  ReplayCommand command;
+  std::vector<std::string> args;
+};
+
+/**
+ * @brief A user script, as piped into the user application.
+ */
+struct Script {
+  std::string path;
+  std::vector<ScriptLine> lines;
+  std::vector<std::string> userIDs; // every user ID it logs in as, in order
+  std::map<std::string, std::string> assets; // path of every opened asset
+};
+
+/**
+ * @brief Loads the user scripts to replay.
+ *
+ * Every asset a script opens is looked up next to the script, and left for
+ * replayScripts to make up if it is not there.
+ *
+ * @param paths The paths of the scripts.
+ * @return The scripts.
+ * @throws FatalError If a script cannot be read.
+ */
+std::vector<Script> loadScripts(const std::vector<std::string> &paths);
+
+/**
+ * @brief Replays user scripts against the AS, and prints the report.
+ *
+ * Every script is first run alone, and then as many copies of every script as
+ * there are simulated users are run at once. Every copy logs in with its own
+ * user IDs, and the auction IDs in a script are taken to be the auctions that
+ * the copy opened, in order, so the copies do not step on each other. A reply
+ * of a copy that differs from the reply of the solo run is counted as wrong.
+ *
+ * @param config The configuration of the run.
+ * @param scripts The scripts to replay.
+ * @param scratchDir The scratch directory of the run, for made up assets.
+ */
+void replayScripts(LoadgenConfig &config, std::vector<Script> &scripts,
+                   const std::string &scratchDir);
+
+#endif
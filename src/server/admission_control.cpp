@@ -0,0 +1,173 @@
+#include "admission_control.hpp"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+
+void TokenBucket::refill(uint32_t rate,
+                         std::chrono::steady_clock::time_point now) {
+  double capacity = (double)rate * ADMISSION_BURST_SECONDS;
+  if (refilledAt == std::chrono::steady_clock::time_point()) {
+    tokens = capacity;
+  } else {
+    std::chrono::duration<double> elapsed = now - refilledAt;
+    tokens = std::min(capacity, tokens + elapsed.count() * rate);
+  }
+  refilledAt = now;
+}
+
+bool TokenBucket::isFull(uint32_t rate) const {
+  return tokens >= (double)rate * ADMISSION_BURST_SECONDS;
+}
+
+bool isLoopback(const struct sockaddr_in &addr) {
+  return ntohl(addr.sin_addr.s_addr) >> 24 == 127;
+}
+
+void AdmissionControl::setLimits(const AdmissionLimits &_limits) {
+  std::lock_guard<std::mutex> guard(lock);
+  limits = _limits;
+}
+
+AdmissionControl::Source &
+AdmissionControl::sourceOf(const struct sockaddr_in &addr,
+                           std::chrono::steady_clock::time_point now) {
+  auto found = sources.find(addr.sin_addr.s_addr);
+  if (found != sources.end()) {
+    return found->second;
+  }
+
+  if (sources.size() >= sweepAt) {
+    // a source whose buckets refilled is treated as new if it comes back
+    for (auto it = sources.begin(); it != sources.end();) {
+      Source &source = it->second;
+      source.udp.refill(limits.udpRate, now);
+      source.tcp.refill(limits.tcpRate, now);
+      source.upload.refill(limits.uploadRate, now);
+      if (source.connections == 0 && source.watchers == 0 &&
+          source.udp.isFull(limits.udpRate) &&
+          source.tcp.isFull(limits.tcpRate) &&
+          source.upload.isFull(limits.uploadRate)) {
+        it = sources.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // so the busy sources are not swept through on every new one
+    sweepAt = std::max((size_t)ADMISSION_SOURCES_SWEEP, sources.size() * 2);
+  }
+  return sources[addr.sin_addr.s_addr];
+}
+
+Admission AdmissionControl::admitRequest(const struct sockaddr_in &addr) {
+  if (isLoopback(addr)) {
+    return ADMITTED;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  if (limits.udpRate == 0) {
+    return ADMITTED;
+  }
+
+  TokenBucket &bucket = sourceOf(addr, now).udp;
+  bucket.refill(limits.udpRate, now);
+  if (!bucket.hasTokens()) {
+    return UDP_RATE_EXCEEDED;
+  }
+  bucket.take(1);
+  return ADMITTED;
+}
+
+Admission AdmissionControl::admitConnection(const struct sockaddr_in &addr) {
+  if (isLoopback(addr)) {
+    return ADMITTED;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  Source &source = sourceOf(addr, now);
+
+  if (limits.connectionsMax != 0 &&
+      source.connections >= limits.connectionsMax) {
+    return CONNECTIONS_EXCEEDED;
+  }
+  if (limits.uploadRate != 0) {
+    // still paying for what it sent over its last connections
+    source.upload.refill(limits.uploadRate, now);
+    if (!source.upload.hasTokens()) {
+      return UPLOAD_RATE_EXCEEDED;
+    }
+  }
+  if (limits.tcpRate != 0) {
+    source.tcp.refill(limits.tcpRate, now);
+    if (!source.tcp.hasTokens()) {
+      return TCP_RATE_EXCEEDED;
+    }
+    source.tcp.take(1);
+  }
+  source.connections++;
+  return ADMITTED;
+}
+
+void AdmissionControl::releaseConnection(const struct sockaddr_in &addr,
+                                         uint64_t bytesIn) {
+  if (isLoopback(addr)) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  Source &source = sourceOf(addr, now);
+  if (source.connections > 0) {
+    source.connections--;
+  }
+  if (limits.uploadRate != 0) {
+    source.upload.refill(limits.uploadRate, now);
+    source.upload.take((double)bytesIn);
+  }
+}
+
+bool AdmissionControl::chargeUpload(const struct sockaddr_in &addr,
+                                    uint64_t bytes) {
+  if (isLoopback(addr)) {
+    return true;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  if (limits.uploadRate == 0) {
+    return true;
+  }
+
+  TokenBucket &bucket = sourceOf(addr, now).upload;
+  bucket.refill(limits.uploadRate, now);
+  if (!bucket.hasTokens()) {
+    return false;
+  }
+  bucket.take((double)bytes);
+  return true;
+}
+
+Admission AdmissionControl::admitWatcher(const struct sockaddr_in &addr) {
+  if (isLoopback(addr)) {
+    return ADMITTED;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  Source &source = sourceOf(addr, now);
+
+  if (limits.watchersMax != 0 && source.watchers >= limits.watchersMax) {
+    return WATCHERS_EXCEEDED;
+  }
+  source.watchers++;
+  return ADMITTED;
+}
+
+void AdmissionControl::releaseWatcher(const struct sockaddr_in &addr) {
+  if (isLoopback(addr)) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> guard(lock);
+  Source &source = sourceOf(addr, now);
+  if (source.watchers > 0) {
+    source.watchers--;
+  }
+}
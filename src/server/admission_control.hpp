@@ -0,0 +1,187 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <netinet/in.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "../utils/constants.hpp"
+
+/**
+ * @brief The traffic every source is allowed, 0 meaning unlimited.
+ */
+struct AdmissionLimits {
+  uint32_t udpRate = ADMISSION_UDP_RATE;               // requests per second
+  uint32_t tcpRate = ADMISSION_TCP_RATE;               // connections per second
+  uint32_t connectionsMax = ADMISSION_CONNECTIONS_MAX; // open at once
+  uint32_t uploadRate = ADMISSION_UPLOAD_RATE;         // bytes per second
+  uint32_t watchersMax = ADMISSION_WATCHERS_MAX;       // held open at once
+};
+
+/**
+ * @brief Whether a request or connection was admitted, or why not.
+ */
+enum Admission {
+  ADMITTED,
+  UDP_RATE_EXCEEDED,
+  TCP_RATE_EXCEEDED,
+  CONNECTIONS_EXCEEDED,
+  UPLOAD_RATE_EXCEEDED,
+  WORKERS_BUSY, // every TCP worker was busy, whatever the source
+  WATCHERS_EXCEEDED,
+  ADMISSION_COUNT
+};
+
+/**
+ * @class TokenBucket
+ *
+ * @brief Allows a rate of something, with bursts of a few seconds of it.
+ *
+ * Something that costs more than the bucket holds, such as a large upload, is
+ * allowed as long as the bucket is not empty, leaving it in debt, so it takes
+ * as long to be allowed anything again as the cost takes to be refilled.
+ */
+class TokenBucket {
+  double tokens = 0;
+  std::chrono::steady_clock::time_point refilledAt; // never if new, so full
+
+public:
+  /**
+   * @brief Refills the bucket for the time since it was last refilled.
+   *
+   * @param rate the tokens added per second
+   * @param now the current time
+   */
+  void refill(uint32_t rate, std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief Checks if the bucket has tokens left, after being refilled.
+   */
+  bool hasTokens() const { return tokens > 0; }
+
+  /**
+   * @brief Checks if the bucket is full, after being refilled, so it can be
+   * forgotten.
+   *
+   * @param rate the tokens added per second
+   */
+  bool isFull(uint32_t rate) const;
+
+  /**
+   * @brief Takes tokens from the bucket, which may leave it in debt.
+   *
+   * @param cost the tokens to take
+   */
+  void take(double cost) { tokens -= cost; }
+};
+
+/**
+ * @class AdmissionControl
+ *
+ * @brief Rejects the UDP requests and TCP connections of the sources that send
+ * more than they are allowed, before they are parsed, so a single client
+ * cannot slow down the AS for everyone else.
+ *
+ * Every source IP has a token bucket for its UDP requests, another for the TCP
+ * connections it opens and another for the bytes it sends over them, charged
+ * as its uploads arrive, and a limit on the TCP connections it has open at
+ * once, so it cannot hold every TCP worker, nor every watch request the AS
+ * holds open past its connection. The sources on the machine of the AS, such
+ * as the load generator, are never limited.
+ */
+class AdmissionControl {
+  struct Source {
+    TokenBucket udp;
+    TokenBucket tcp;
+    TokenBucket upload;
+    uint32_t connections = 0; // open, and held by a TCP worker
+    uint32_t watchers = 0;    // watch requests held open
+  };
+
+  std::mutex lock;
+  AdmissionLimits limits;
+  std::unordered_map<in_addr_t, Source> sources;
+  size_t sweepAt = ADMISSION_SOURCES_SWEEP; // sources kept before a sweep
+
+  /**
+   * @brief Gets the source of an address, with the lock held, forgetting the
+   * idle sources first if there are too many.
+   *
+   * @param addr the address
+   * @param now the current time
+   */
+  Source &sourceOf(const struct sockaddr_in &addr,
+                   std::chrono::steady_clock::time_point now);
+
+public:
+  /**
+   * @brief Sets the traffic every source is allowed.
+   *
+   * @param _limits the limits
+   */
+  void setLimits(const AdmissionLimits &_limits);
+
+  /**
+   * @brief Decides whether to handle a UDP request.
+   *
+   * @param addr the address the request came from
+   * @return ADMITTED, or why the request must be dropped
+   */
+  Admission admitRequest(const struct sockaddr_in &addr);
+
+  /**
+   * @brief Decides whether to handle a TCP connection, counting it as open if
+   * so, until it is released.
+   *
+   * @param addr the address the connection came from
+   * @return ADMITTED, or why the connection must be closed
+   */
+  Admission admitConnection(const struct sockaddr_in &addr);
+
+  /**
+   * @brief Releases an admitted TCP connection, once closed.
+   *
+   * @param addr the address the connection came from
+   * @param bytesIn the bytes the connection received, charged to the source
+   */
+  void releaseConnection(const struct sockaddr_in &addr, uint64_t bytesIn);
+
+  /**
+   * @brief Charges the bytes an admitted TCP connection uploads to its source,
+   * as they arrive.
+   *
+   * @param addr the address the connection came from
+   * @param bytes the bytes that arrived
+   * @return false if the source was out of upload allowance, so the rest of the
+   * upload must be refused
+   */
+  bool chargeUpload(const struct sockaddr_in &addr, uint64_t bytes);
+
+  /**
+   * @brief Decides whether to hold a watch request open, counting it as held
+   * if so, until it is released.
+   *
+   * @param addr the address the watch request came from
+   * @return ADMITTED, or why the watch request must be answered right away
+   */
+  Admission admitWatcher(const struct sockaddr_in &addr);
+
+  /**
+   * @brief Releases an admitted watch request, once answered.
+   *
+   * @param addr the address the watch request came from
+   */
+  void releaseWatcher(const struct sockaddr_in &addr);
+};
+
+/**
+ * @brief Checks if an address is of the machine of the AS, 127.0.0.0/8.
+ *
+ * @param addr the address
+ */
+bool isLoopback(const struct sockaddr_in &addr);
+
+#endif
@@ -0,0 +1,253 @@
+#include "async_logger.hpp"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+// the ring of the thread, and the logger it belongs to
+static thread_local AsyncLogger *ringOwner = nullptr;
+static thread_local LogRing *threadRing = nullptr;
+
+static const char *const LEVEL_NAMES[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+
+AsyncLogger::AsyncLogger(LogLevel _threshold) : threshold{_threshold} {
+  thread = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  running = false;
+  thread.join();
+}
+
+LogRing &AsyncLogger::ring() {
+  if (ringOwner != this) {
+    // left uninitialized, so only the records that are written are paged in
+    std::unique_ptr<LogRing> ring(new LogRing);
+    threadRing = ring.get();
+    ringOwner = this;
+    std::lock_guard<std::mutex> guard(ringsLock);
+    rings.push_back(std::move(ring));
+  }
+  return *threadRing;
+}
+
+LogRecord &AsyncLogger::pending(LogLevel level) {
+  LogRing &ring = this->ring();
+  if (!ring.writing) {
+    LogRecord &record = ring.pending;
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    record.time = (uint64_t)
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    record.level = (uint8_t)level;
+    record.length = 0;
+    record.truncated = false;
+    ring.writing = true;
+  }
+  return ring.pending;
+}
+
+char *AsyncLogger::reserve(LogLevel level, char type, size_t length) {
+  LogRecord &record = pending(level);
+  if (record.length + 1 + length > sizeof(record.values)) {
+    record.truncated = true;
+    return nullptr;
+  }
+  record.values[record.length] = type;
+  char *value = &record.values[record.length + 1];
+  record.length = (uint16_t)(record.length + 1 + length);
+  return value;
+}
+
+void AsyncLogger::appendString(LogLevel level, std::string_view value) {
+  LogRecord &record = pending(level);
+  size_t room = sizeof(record.values) - record.length;
+  if (room < 1 + sizeof(uint16_t)) {
+    record.truncated = true;
+    return;
+  }
+  // a long string is cut down to what fits, rather than left out
+  uint16_t length =
+      (uint16_t)std::min(value.length(), room - 1 - sizeof(uint16_t));
+  char *dest = reserve(level, 'S', sizeof(length) + length);
+  std::memcpy(dest, &length, sizeof(length));
+  std::memcpy(dest + sizeof(length), value.data(), length);
+  if (length < value.length()) {
+    record.truncated = true;
+  }
+}
+
+void AsyncLogger::appendChar(LogLevel level, char value) {
+  char *dest = reserve(level, 'C', 1);
+  if (dest != nullptr) {
+    *dest = value;
+  }
+}
+
+void AsyncLogger::appendSigned(LogLevel level, int64_t value) {
+  char *dest = reserve(level, 'I', sizeof(value));
+  if (dest != nullptr) {
+    std::memcpy(dest, &value, sizeof(value));
+  }
+}
+
+void AsyncLogger::appendUnsigned(LogLevel level, uint64_t value) {
+  char *dest = reserve(level, 'U', sizeof(value));
+  if (dest != nullptr) {
+    std::memcpy(dest, &value, sizeof(value));
+  }
+}
+
+void AsyncLogger::appendDouble(LogLevel level, double value) {
+  char *dest = reserve(level, 'D', sizeof(value));
+  if (dest != nullptr) {
+    std::memcpy(dest, &value, sizeof(value));
+  }
+}
+
+void AsyncLogger::appendAddress(LogLevel level,
+                                const struct sockaddr_in &value) {
+  char *dest = reserve(level, 'A', 6);
+  if (dest != nullptr) { // both in network byte order
+    std::memcpy(dest, &value.sin_addr.s_addr, 4);
+    std::memcpy(dest + 4, &value.sin_port, 2);
+  }
+}
+
+void AsyncLogger::commit(LogLevel level) {
+  pending(level); // a record without values is an empty line
+  LogRing &ring = *threadRing;
+  ring.writing = false;
+
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= LOG_RING_RECORDS) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring.records[head % LOG_RING_RECORDS] = ring.pending;
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Formats the values of a record.
+ *
+ * @param record the record
+ * @param line where to write the values to
+ */
+static void formatValues(const LogRecord &record, std::string &line) {
+  const char *value = record.values;
+  const char *end = record.values + record.length;
+  while (value < end) {
+    char type = *value++;
+    if (type == 'S') {
+      uint16_t length;
+      std::memcpy(&length, value, sizeof(length));
+      line.append(value + sizeof(length), length);
+      value += sizeof(length) + length;
+    } else if (type == 'C') {
+      line.push_back(*value++);
+    } else if (type == 'I') {
+      int64_t number;
+      std::memcpy(&number, value, sizeof(number));
+      line.append(std::to_string(number));
+      value += sizeof(number);
+    } else if (type == 'U') {
+      uint64_t number;
+      std::memcpy(&number, value, sizeof(number));
+      line.append(std::to_string(number));
+      value += sizeof(number);
+    } else if (type == 'D') {
+      double number;
+      std::memcpy(&number, value, sizeof(number));
+      line.append(std::to_string(number));
+      value += sizeof(number);
+    } else if (type == 'A') {
+      struct in_addr addr;
+      uint16_t port;
+      std::memcpy(&addr.s_addr, value, 4);
+      std::memcpy(&port, value + 4, 2);
+      char addrStr[INET_ADDRSTRLEN] = {0};
+      inet_ntop(AF_INET, &addr, addrStr, INET_ADDRSTRLEN);
+      line.append(addrStr).append(":").append(std::to_string(ntohs(port)));
+      value += 6;
+    } else {
+      break; // never written
+    }
+  }
+}
+
+void AsyncLogger::drain() {
+  std::vector<LogRecord> records;
+  uint64_t drops = 0;
+  {
+    std::lock_guard<std::mutex> guard(ringsLock);
+    for (auto &ring : rings) {
+      uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+      for (; tail < head; tail++) {
+        records.push_back(ring->records[tail % LOG_RING_RECORDS]);
+      }
+      ring->tail.store(tail, std::memory_order_release);
+      drops += ring->dropped.load(std::memory_order_relaxed);
+    }
+  }
+  // every ring is in order, but the threads are interleaved
+  std::stable_sort(records.begin(), records.end(),
+                   [](const LogRecord &a, const LogRecord &b) {
+                     return a.time < b.time;
+                   });
+
+  std::string out;
+  std::string err;
+  time_t second = -1;
+  char date[DATE_TIME_LENGTH + 1] = {0};
+  for (const auto &record : records) {
+    std::string &line = record.level >= LOG_WARNING ? err : out;
+    time_t recordSecond = (time_t)(record.time / 1000000000);
+    if (recordSecond != second) {
+      second = recordSecond;
+      struct tm local;
+      localtime_r(&second, &local);
+      strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    char millis[8];
+    snprintf(millis, sizeof(millis), ".%03u",
+             (unsigned)(record.time / 1000000 % 1000));
+    line.append(date).append(millis).append(" ");
+    line.append(LEVEL_NAMES[record.level]).append(" ");
+    formatValues(record, line);
+    if (record.truncated) {
+      line.append("...");
+    }
+    line.push_back('\n');
+  }
+  auto now = std::chrono::steady_clock::now();
+  if (drops > reportedDrops && now - reportedAt >= std::chrono::seconds(1)) {
+    err.append(std::to_string(drops - reportedDrops))
+        .append(" log records were dropped, as they were written faster than "
+                "they could be printed\n");
+    reportedDrops = drops;
+    reportedAt = now;
+  }
+
+  if (!out.empty()) {
+    std::fwrite(out.data(), 1, out.length(), stdout);
+    std::fflush(stdout);
+  }
+  if (!err.empty()) {
+    std::fwrite(err.data(), 1, err.length(), stderr);
+  }
+}
+
+void AsyncLogger::run() {
+  while (running) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS));
+    drain();
+  }
+  drain(); // the records written while stopping
+}
@@ -0,0 +1,206 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <netinet/in.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../utils/constants.hpp"
+
+/**
+ * @brief The levels of the log records, from the least to the most severe.
+ */
+enum LogLevel { LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR };
+
+/**
+ * @brief A log record, as written by a thread: the values it was made of,
+ * each one prefixed by its type, to be formatted by the logger thread.
+ */
+struct LogRecord {
+  uint64_t time;   // nanoseconds since the epoch
+  uint16_t length; // of the values
+  uint8_t level;
+  bool truncated; // values were left out, as they did not fit
+  char values[LOG_RECORD_LEN - 12];
+};
+
+/**
+ * @class LogRing
+ *
+ * @brief The records written by a thread and not yet formatted, in a ring
+ * with a single writer and a single reader, so neither of them locks.
+ */
+class LogRing {
+public:
+  std::array<LogRecord, LOG_RING_RECORDS> records;
+  std::atomic<uint64_t> head{0}; // records written, only moved by the thread
+  std::atomic<uint64_t> tail{0}; // records read, only moved by the logger
+  std::atomic<uint64_t> dropped{0}; // records the ring had no room for
+  LogRecord pending;                // the record being written
+  bool writing = false;             // whether pending has values
+};
+
+/**
+ * @class AsyncLogger
+ *
+ * @brief Writes the log records of every thread to the standard output, or to
+ * the standard error for warnings and errors, from a thread of its own.
+ *
+ * A thread only copies the values of its records into its own ring, and the
+ * logger thread formats and writes them a few times a second, so logging never
+ * waits on a lock or on the terminal. When a ring is full its records are
+ * dropped and counted, and the logger writes how many were lost.
+ */
+class AsyncLogger {
+  std::mutex ringsLock; // only held to add a ring, or to read the rings
+  std::vector<std::unique_ptr<LogRing>> rings;
+  std::atomic<bool> running{true};
+  // the drops written so far, at most once a second, by the logger thread
+  uint64_t reportedDrops = 0;
+  std::chrono::steady_clock::time_point reportedAt;
+  std::thread thread;
+
+  /**
+   * @brief Gets the ring of the calling thread, adding it on first use.
+   */
+  LogRing &ring();
+
+  /**
+   * @brief Gets the record being written by the calling thread, starting it
+   * if there is none.
+   *
+   * @param level the level of the record, if it is started
+   */
+  LogRecord &pending(LogLevel level);
+
+  /**
+   * @brief Reserves room for a value in the record of the calling thread.
+   *
+   * @param level the level of the record
+   * @param type the type of the value
+   * @param length the size of the value
+   * @return where to copy the value to, or nullptr if it does not fit
+   */
+  char *reserve(LogLevel level, char type, size_t length);
+
+  /**
+   * @brief Formats and writes every record in the rings, oldest first.
+   */
+  void drain();
+
+  /**
+   * @brief Formats and writes records until the logger is stopped.
+   */
+  void run();
+
+public:
+  const LogLevel threshold; // records of lower levels are not written
+
+  /**
+   * @brief Starts the logger thread.
+   *
+   * @param threshold the lowest level of the records to write
+   */
+  AsyncLogger(LogLevel threshold);
+
+  /**
+   * @brief Writes the records left, and stops the logger thread.
+   */
+  ~AsyncLogger();
+
+  AsyncLogger(const AsyncLogger &) = delete;
+  AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+  void appendString(LogLevel level, std::string_view value);
+  void appendChar(LogLevel level, char value);
+  void appendSigned(LogLevel level, int64_t value);
+  void appendUnsigned(LogLevel level, uint64_t value);
+  void appendDouble(LogLevel level, double value);
+  void appendAddress(LogLevel level, const struct sockaddr_in &value);
+
+  /**
+   * @brief Ends the record of the calling thread, handing it to the logger
+   * thread, or dropping it if the ring of the thread is full.
+   *
+   * @param level the level of the record, if it has no values
+   */
+  void commit(LogLevel level);
+};
+
+/**
+ * @class LogStream
+ *
+ * @brief Writes records of a level to the logger, a line at a time, as in
+ * stream << "Auction " << auctionID << " closed" << std::endl;
+ *
+ * Numbers and addresses are formatted by the logger thread, while values of
+ * other types are formatted right away.
+ */
+class LogStream {
+  AsyncLogger &logger;
+  LogLevel level;
+
+public:
+  LogStream(AsyncLogger &_logger, LogLevel _level)
+      : logger{_logger}, level{_level} {};
+
+  bool enabled() const { return level >= logger.threshold; }
+
+  template <class T> LogStream &operator<<(const T &val) {
+    if (!enabled()) {
+      return *this;
+    }
+    if constexpr (std::is_same_v<T, char>) {
+      logger.appendChar(level, val);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      logger.appendUnsigned(level, val);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      logger.appendSigned(level, val);
+    } else if constexpr (std::is_integral_v<T>) {
+      logger.appendUnsigned(level, val);
+    } else if constexpr (std::is_floating_point_v<T>) {
+      logger.appendDouble(level, val);
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      logger.appendString(level, val);
+    } else if constexpr (std::is_same_v<T, struct sockaddr_in>) {
+      logger.appendAddress(level, val);
+    } else {
+      std::ostringstream formatted;
+      formatted << val;
+      logger.appendString(level, formatted.str());
+    }
+    return *this;
+  }
+
+  // std::endl and std::flush end the record
+  LogStream &operator<<(std::ostream &(*f)(std::ostream &)) {
+    (void)f;
+    if (enabled()) {
+      logger.commit(level);
+    }
+    return *this;
+  }
+
+  LogStream &operator<<(std::ios &(*f)(std::ios &)) {
+    (void)f;
+    return *this;
+  }
+
+  LogStream &operator<<(std::ios_base &(*f)(std::ios_base &)) {
+    (void)f;
+    return *this;
+  }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "auction_archive.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "../utils/io_counters.hpp"
+#include "../utils/utils.hpp"
+
+std::string getArchivePath(const std::string &auctionID) {
+  return ARCHIVE_DIR + SLASH + auctionID + ARCHIVE_EXT;
+}
+
+int8_t isAuctionArchived(const std::string &auctionID) {
+  return file_exists(getArchivePath(auctionID));
+}
+
+/**
+ * @brief Reads the header of the archive of an auction.
+ *
+ * @param auctionID the archived auction ID
+ * @return the header of the archive
+ */
+static ArchiveIndex readArchiveIndex(const std::string &auctionID) {
+  std::ifstream file(getArchivePath(auctionID),
+                     std::ios::in | std::ios::binary);
+  ArchiveIndex index;
+  if (!file.read(reinterpret_cast<char *>(&index), sizeof(index)) ||
+      std::memcmp(index.magic, ARCHIVE_MAGIC, sizeof(index.magic)) != 0) {
+    throw CorruptedArchiveException();
+  }
+  threadIO.opens++;
+  threadIO.bytesRead += sizeof(index);
+  return index;
+}
+
+void archiveAuction(const std::string &auctionID) {
+  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+  std::string sections[ARCHIVE_SECTIONS];
+
+  read_from_file(auctionPath + SLASH + START_FILE + auctionID + TXT_EXT,
+                 sections[ARCHIVE_START]);
+  read_from_file(auctionPath + SLASH + END_FILE + auctionID + TXT_EXT,
+                 sections[ARCHIVE_END]);
+
+  // all bids, not only the top ones, so my bids still finds every bidder
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids =
+      getAuctionBids(auctionID);
+  sortAuctionBids(bids);
+  for (auto bid : bids) {
+    sections[ARCHIVE_BIDS] += std::get<0>(bid) + " " +
+                              std::to_string(std::get<1>(bid)) + " " +
+                              std::get<2>(bid) + " " +
+                              std::to_string(std::get<3>(bid)) + "\n";
+  }
+
+  std::vector<std::string> startWords =
+      splitOnSeparator(sections[ARCHIVE_START], ' ');
+  std::string assetPath = auctionPath + ASSET_DIR + startWords[2];
+  std::ifstream asset(assetPath, std::ios::in | std::ios::binary);
+  if (!asset) {
+    throw CorruptedArchiveException();
+  }
+
+  ArchiveIndex index;
+  std::memcpy(index.magic, ARCHIVE_MAGIC, sizeof(index.magic));
+  uint32_t offset = sizeof(index);
+  for (int i = 0; i < ARCHIVE_SECTIONS; i++) {
+    index.offset[i] = offset;
+    index.length[i] = i == ARCHIVE_ASSET
+                          ? (uint32_t)std::filesystem::file_size(assetPath)
+                          : (uint32_t)sections[i].length();
+    offset += index.length[i];
+  }
+
+  std::string archivePath = getArchivePath(auctionID);
+  std::string tmpPath = archivePath + ".tmp";
+  std::ofstream file(tmpPath,
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&index), sizeof(index));
+  for (int i = 0; i < ARCHIVE_ASSET; i++) {
+    file.write(sections[i].data(), (std::streamsize)sections[i].length());
+  }
+  if (index.length[ARCHIVE_ASSET] > 0) {
+    file << asset.rdbuf();
+  }
+  file.close();
+
+  if (!file || (uint32_t)std::filesystem::file_size(tmpPath) != offset) {
+    delete_file(tmpPath);
+    throw CorruptedArchiveException();
+  }
+  rename_file(tmpPath, archivePath);
+}
+
+std::pair<uint32_t, uint32_t>
+getArchiveSectionRange(const std::string &auctionID, ArchiveSection section) {
+  ArchiveIndex index = readArchiveIndex(auctionID);
+  return std::make_pair(index.offset[section], index.length[section]);
+}
+
+std::string readArchiveSection(const std::string &auctionID,
+                               ArchiveSection section) {
+  ArchiveIndex index = readArchiveIndex(auctionID);
+
+  std::ifstream file(getArchivePath(auctionID),
+                     std::ios::in | std::ios::binary);
+  std::string text(index.length[section], '\0');
+  file.seekg(index.offset[section]);
+  if (!file.read(text.data(), (std::streamsize)text.length())) {
+    throw CorruptedArchiveException();
+  }
+  threadIO.opens++;
+  threadIO.bytesRead += text.length();
+  return text;
+}
+
+std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+getArchivedAuctionBids(const std::string &auctionID, uint32_t numBids) {
+  // one bid per line: UID bid_value bid_datetime bid_sec_time
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
+  for (auto line :
+       splitOnSeparator(readArchiveSection(auctionID, ARCHIVE_BIDS), '\n')) {
+    if (bids.size() >= numBids) {
+      break;
+    }
+    std::vector<std::string> bidWords = splitOnSeparator(line, ' ');
+    if (bidWords.size() != 5) {
+      continue;
+    }
+    bids.push_back(std::make_tuple(
+        bidWords[0], (uint32_t)std::stoi(bidWords[1]),
+        bidWords[2] + " " + bidWords[3], (uint32_t)std::stoi(bidWords[4])));
+  }
+  return bids;
+}
+
+std::pair<std::string, uint32_t>
+getArchivedAuctionEnd(const std::string &auctionID) {
+  // end format: end_datetime end_sec_time
+  std::vector<std::string> endWords =
+      splitOnSeparator(readArchiveSection(auctionID, ARCHIVE_END), ' ');
+  if (endWords.size() < 3) {
+    throw CorruptedArchiveException();
+  }
+  return std::make_pair(endWords[0] + " " + endWords[1],
+                        (uint32_t)std::stoi(endWords[2]));
+}
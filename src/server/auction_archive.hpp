@@ -0,0 +1,110 @@
+#ifndef AUCTION_ARCHIVE_H
+#define AUCTION_ARCHIVE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../utils/constants.hpp"
+
+/**
+ * @brief Sections of an auction archive, in the order they are stored.
+ */
+enum ArchiveSection {
+  ARCHIVE_START, // contents of START_<aid>.txt
+  ARCHIVE_END,   // contents of END_<aid>.txt
+  ARCHIVE_BIDS,  // every bid, largest first, one per line
+  ARCHIVE_ASSET, // the asset file
+  ARCHIVE_SECTIONS
+};
+
+/**
+ * @brief Header of an auction archive.
+ *
+ * An archive is ARCHIVE/<aid>.arc, made of this header followed by the data of
+ * every section, at the given offsets from the start of the file.
+ */
+struct ArchiveIndex {
+  char magic[4];
+  uint32_t offset[ARCHIVE_SECTIONS];
+  uint32_t length[ARCHIVE_SECTIONS];
+};
+
+/**
+ * @brief Get the path of the archive of an auction.
+ *
+ * @param auctionID the auction ID
+ * @return the path of the archive file
+ */
+std::string getArchivePath(const std::string &auctionID);
+
+/**
+ * @brief Checks if an auction was moved to the archive.
+ *
+ * @param auctionID the auction ID to check
+ * @return VALID if the auction is archived, INVALID otherwise
+ */
+int8_t isAuctionArchived(const std::string &auctionID);
+
+/**
+ * @brief Packs a closed auction into its archive file.
+ *
+ * The archive is written to a temporary file and renamed, so it is either
+ * complete or missing. The auction directory is left untouched.
+ *
+ * @param auctionID the auction ID to archive
+ */
+void archiveAuction(const std::string &auctionID);
+
+/**
+ * @brief Gets where a section is stored in the archive of an auction.
+ *
+ * @param auctionID the archived auction ID
+ * @param section the section to locate
+ * @return the offset and length of the section
+ */
+std::pair<uint32_t, uint32_t>
+getArchiveSectionRange(const std::string &auctionID, ArchiveSection section);
+
+/**
+ * @brief Reads a section of the archive of an auction.
+ *
+ * @param auctionID the archived auction ID
+ * @param section the section to read
+ * @return the contents of the section
+ */
+std::string readArchiveSection(const std::string &auctionID,
+                               ArchiveSection section);
+
+/**
+ * @brief Gets the bids of an archived auction.
+ *
+ * @param auctionID the archived auction ID
+ * @param numBids the maximum number of bids to return
+ * @return the largest bids, largest first
+ */
+std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+getArchivedAuctionBids(const std::string &auctionID, uint32_t numBids);
+
+/**
+ * @brief Gets the end information of an archived auction.
+ *
+ * @param auctionID the archived auction ID
+ * @return the end date-time and the seconds the auction was active
+ */
+std::pair<std::string, uint32_t>
+getArchivedAuctionEnd(const std::string &auctionID);
+
+/**
+ * @brief Exception thrown when an archive file is missing or corrupted.
+ */
+class CorruptedArchiveException : public std::runtime_error {
+public:
+  CorruptedArchiveException()
+      : std::runtime_error("The auction archive is corrupted") {}
+};
+
+#endif
@@ -1,20 +1,85 @@
 #include "handlers.hpp"
 
+#include <arpa/inet.h>
+
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 
 #include "../utils/protocol.hpp"
+#include "../utils/tracer.hpp"
+#include "request_stats.hpp"
+
+/**
+ * @brief Deserializes a request in the encoding it was received in.
+ *
+ * @param request The request to deserialize.
+ * @param buf The packet, without its ID.
+ * @param addressFrom The address of the sender.
+ */
+template <typename Request>
+static void readRequest(Request &request, std::string_view buf,
+                        SocketAddress &addressFrom) {
+  TraceSpan traceSpan("parse");
+  if (addressFrom.encoding == BINARY_ENCODING) {
+    request.deserializeBinary(buf);
+  } else {
+    request.deserialize(buf);
+  }
+}
+
+/**
+ * @brief Receives a request over TCP.
+ *
+ * @param request The request to receive.
+ * @param fd The file descriptor of the connection.
+ */
+template <typename Request>
+static void receiveRequest(Request &request, int fd) {
+  TraceSpan traceSpan("parse");
+  request.receive(fd);
+}
+
+/**
+ * @brief Sends a response in the encoding the request was received in, and
+ * notes it in the stats of the request.
+ *
+ * @param response The response to send.
+ * @param addressFrom The address of the sender.
+ */
+template <typename Response>
+static void sendResponse(Response &response, SocketAddress &addressFrom) {
+  TraceSpan traceSpan("reply");
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  encode_packet(response, buffer, addressFrom.encoding, addressFrom.requestID);
+  send_buffer(buffer.view(), addressFrom.socket,
+              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  RequestTimer::noteReply(Response::STATUS_NAMES[response.status],
+                          buffer.length());
+}
+
+/**
+ * @brief Sends a response over TCP, and notes it in the stats of the request.
+ *
+ * @param response The response to send.
+ * @param fd The file descriptor of the connection.
+ */
+template <typename Response>
+static void sendResponse(Response &response, int fd) {
+  TraceSpan traceSpan("reply");
+  response.send(fd);
+  RequestTimer::noteReply(Response::STATUS_NAMES[response.status]);
+}
 
-void handleLogin(AuctionServerState &serverState, std::stringstream &buf,
+void handleLogin(AuctionServerState &serverState, std::string_view buf,
                  SocketAddress &addressFrom) {
 
-  std::cout << "Handling login request" << std::endl;
+  serverState.info << "Handling login request" << std::endl;
 
   LoginRequest request;
   LoginResponse response;
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
     serverState.verbose << "[Login] User " << request.userID
                         << " requested to login" << std::endl;
 
@@ -40,26 +105,25 @@ void handleLogin(AuctionServerState &serverState, std::stringstream &buf,
     serverState.verbose << "[Login] Invalid packet received" << std::endl;
     response.status = LoginResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[Login] There was an unhandled exception that prevented "
-                 "the user from logging in"
-              << e.what() << std::endl;
+    serverState.error << "[Login] There was an unhandled exception that "
+                         "prevented the user from logging in"
+                      << e.what() << std::endl;
 
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
 }
 
-void handleLogout(AuctionServerState &serverState, std::stringstream &buf,
+void handleLogout(AuctionServerState &serverState, std::string_view buf,
                   SocketAddress &addressFrom) {
-  std::cout << "Handling logout request" << std::endl;
+  serverState.info << "Handling logout request" << std::endl;
 
   LogoutRequest request;
   LogoutResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
     serverState.verbose << "[Logout] User " << request.userID
                         << " requested to logout with password "
                         << request.password << std::endl;
@@ -89,25 +153,24 @@ void handleLogout(AuctionServerState &serverState, std::stringstream &buf,
     serverState.verbose << "[Logout] Invalid packet received" << std::endl;
     response.status = LogoutResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[Logout] There was an unhandled exception that prevented "
-                 "the user from logging out"
-              << e.what() << std::endl;
+    serverState.error << "[Logout] There was an unhandled exception that "
+                         "prevented the user from logging out"
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
 }
 
-void handleUnregister(AuctionServerState &serverState, std::stringstream &buf,
+void handleUnregister(AuctionServerState &serverState, std::string_view buf,
                       SocketAddress &addressFrom) {
-  std::cout << "Handling unregister request" << std::endl;
+  serverState.info << "Handling unregister request" << std::endl;
 
   UnregisterRequest request;
   UnregisterResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
     serverState.verbose << "[Unregister] User " << request.userID
                         << " requested to unregister with password "
                         << request.password << std::endl;
@@ -141,25 +204,25 @@ void handleUnregister(AuctionServerState &serverState, std::stringstream &buf,
     serverState.verbose << "[Unregister] Invalid packet received" << std::endl;
     response.status = UnregisterResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[Unregister] There was an unhandled exception that prevented "
-                 "the user from unregistering"
-              << e.what() << std::endl;
+    serverState.error << "[Unregister] There was an unhandled exception that "
+                         "prevented the user from unregistering"
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
 }
 
 void handleListUserAuctions(AuctionServerState &serverState,
-                            std::stringstream &buf,
+                            std::string_view buf,
                             SocketAddress &addressFrom) {
-  std::cout << "Handling list user auctions request" << std::endl;
+  serverState.info << "Handling list user auctions request" << std::endl;
   ListUserAuctionsRequest request;
   ListUserAuctionsResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
     serverState.verbose << "[ListUserAuctions] User "
                         << " requested to list auctions" << std::endl;
 
@@ -184,24 +247,24 @@ void handleListUserAuctions(AuctionServerState &serverState,
                         << std::endl;
     response.status = ListUserAuctionsResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[ListUserAuctions] There was an unhandled exception that "
-                 "prevented the user from listing auctions"
-              << e.what() << std::endl;
+    serverState.error << "[ListUserAuctions] There was an unhandled exception "
+                         "that prevented the user from listing auctions"
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
 }
 
-void handleListUserBids(AuctionServerState &serverState, std::stringstream &buf,
+void handleListUserBids(AuctionServerState &serverState, std::string_view buf,
                         SocketAddress &addressFrom) {
-  std::cout << "Handling list user bids request" << std::endl;
+  serverState.info << "Handling list user bids request" << std::endl;
   ListUserBidsRequest request;
   ListUserBidsResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
     serverState.verbose << "[ListUserBids] User "
                         << " requested to list bids" << std::endl;
 
@@ -227,33 +290,52 @@ void handleListUserBids(AuctionServerState &serverState, std::stringstream &buf,
                         << std::endl;
     response.status = ListUserBidsResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[ListUserBids] There was an unhandled exception that "
-                 "prevented the user from listing bids: "
-              << e.what() << std::endl;
+    serverState.error << "[ListUserBids] There was an unhandled exception that "
+                         "prevented the user from listing bids: "
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
 }
 
-void handleListAuctions(AuctionServerState &serverState, std::stringstream &buf,
+void handleListAuctions(AuctionServerState &serverState, std::string_view buf,
                         SocketAddress &addressFrom) {
-  std::cout << "Handling list auctions request" << std::endl;
+  serverState.info << "Handling list auctions request" << std::endl;
 
   ListAuctionsRequest request;
   ListAuctionsResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
     serverState.verbose << "[ListAuctions] User "
                         << " requested to list auctions" << std::endl;
 
-    response.auctions = serverState.auctionManager.listAuctions();
-    response.status = ListAuctionsResponse::OK;
-    serverState.verbose << "[ListAuctions] Auctions listed successfully"
-                        << std::endl;
+    if (addressFrom.encoding == BINARY_ENCODING) {
+      // only the text reply is cached
+      auto archive = serverState.lockArchive();
+      response.auctions = serverState.auctionManager.listAuctions();
+      response.status = ListAuctionsResponse::OK;
+    } else {
+      // copied from the cached reply, unless the auctions changed since
+      PacketBuffer &buffer = PacketBuffer::forThread();
+      {
+        auto archive = serverState.lockArchive();
+        serverState.auctionManager.serializeAuctionList(buffer);
+      }
+      serverState.verbose << "[ListAuctions] Auctions listed successfully"
+                          << std::endl;
 
+      send_buffer(buffer.view(), addressFrom.socket,
+                  (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+      // the cached reply is NOK if there are no auctions
+      auto status = buffer.view().substr(PACKET_ID_LEN + 1, 2) == "OK"
+                        ? ListAuctionsResponse::OK
+                        : ListAuctionsResponse::NOK;
+      RequestTimer::noteReply(ListAuctionsResponse::STATUS_NAMES[status],
+                              buffer.length());
+      return;
+    }
   } catch (NoAuctionsException &e) {
     serverState.verbose << "[ListAuctions] No auctions to list" << std::endl;
     response.status = ListAuctionsResponse::NOK;
@@ -262,25 +344,168 @@ void handleListAuctions(AuctionServerState &serverState, std::stringstream &buf,
                         << std::endl;
     response.status = ListAuctionsResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[ListAuctions] There was an unhandled exception that "
-                 "prevented the user from listing auctions"
-              << e.what() << std::endl;
+    serverState.error << "[ListAuctions] There was an unhandled exception that "
+                         "prevented the user from listing auctions"
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
+}
+
+void handleListAuctionsPage(AuctionServerState &serverState,
+                            std::string_view buf, SocketAddress &addressFrom) {
+  serverState.info << "Handling list auctions page request" << std::endl;
+
+  ListAuctionsPageRequest request;
+  ListAuctionsPageResponse response;
+
+  try {
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ListAuctionsPage] User requested to list the "
+                        << "auctions after " << request.cursor << std::endl;
+
+    response.auctions = serverState.auctionManager.listAuctionsPage(
+        request.cursor, LIST_PAGE_SIZE, nullptr);
+    if (response.auctions.empty() && request.cursor == LIST_CURSOR_START) {
+      throw NoAuctionsException();
+    }
+    response.nextCursor = serverState.auctionManager.getNextCursor(
+        response.auctions, LIST_PAGE_SIZE);
+    response.status = ListAuctionsPageResponse::OK;
+    serverState.verbose << "[ListAuctionsPage] Auctions listed successfully"
+                        << std::endl;
+  } catch (NoAuctionsException &e) {
+    serverState.verbose << "[ListAuctionsPage] No auctions to list"
+                        << std::endl;
+    response.status = ListAuctionsPageResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ListAuctionsPage] Invalid packet received"
+                        << std::endl;
+    response.status = ListAuctionsPageResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ListAuctionsPage] There was an unhandled exception "
+                         "that prevented the user from listing auctions"
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
+}
+
+void handleListUserAuctionsPage(AuctionServerState &serverState,
+                                std::string_view buf,
+                                SocketAddress &addressFrom) {
+  serverState.info << "Handling list user auctions page request" << std::endl;
+
+  ListUserAuctionsPageRequest request;
+  ListUserAuctionsPageResponse response;
+
+  try {
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ListUserAuctionsPage] User " << request.userID
+                        << " requested to list auctions after "
+                        << request.cursor << std::endl;
+
+    if (serverState.usersManager.isUserLoggedIn(request.userID) != INVALID) {
+      response.auctions = serverState.auctionManager.listUserAuctionsPage(
+          request.userID, request.cursor, LIST_PAGE_SIZE);
+      if (response.auctions.empty() && request.cursor == LIST_CURSOR_START) {
+        throw NoAuctionsException();
+      }
+      response.nextCursor = serverState.auctionManager.getNextCursor(
+          response.auctions, LIST_PAGE_SIZE);
+      response.status = ListUserAuctionsPageResponse::OK;
+      serverState.verbose << "[ListUserAuctionsPage] Auctions listed "
+                             "successfully"
+                          << std::endl;
+    } else {
+      response.status = ListUserAuctionsPageResponse::NLG;
+      serverState.verbose << "[ListUserAuctionsPage] User " << request.userID
+                          << " is not logged in" << std::endl;
+    }
+
+  } catch (NoAuctionsException &e) {
+    serverState.verbose << "[ListUserAuctionsPage] No auctions to list"
+                        << std::endl;
+    response.status = ListUserAuctionsPageResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ListUserAuctionsPage] Invalid packet received"
+                        << std::endl;
+    response.status = ListUserAuctionsPageResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ListUserAuctionsPage] There was an unhandled "
+                         "exception that prevented the user from listing "
+                         "auctions"
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
+}
+
+void handleListUserBidsPage(AuctionServerState &serverState,
+                            std::string_view buf, SocketAddress &addressFrom) {
+  serverState.info << "Handling list user bids page request" << std::endl;
+
+  ListUserBidsPageRequest request;
+  ListUserBidsPageResponse response;
+
+  try {
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ListUserBidsPage] User " << request.userID
+                        << " requested to list bids after " << request.cursor
+                        << std::endl;
+
+    if (serverState.usersManager.isUserLoggedIn(request.userID) != INVALID) {
+      response.auctions =
+          serverState.auctionManager.getAuctionsBiddedByUserPage(
+              request.userID, request.cursor, LIST_PAGE_SIZE);
+      if (response.auctions.empty() && request.cursor == LIST_CURSOR_START) {
+        throw NoOngoingBidsException();
+      }
+      response.nextCursor = serverState.auctionManager.getNextCursor(
+          response.auctions, LIST_PAGE_SIZE);
+      response.status = ListUserBidsPageResponse::OK;
+      serverState.verbose << "[ListUserBidsPage] Bids listed successfully"
+                          << std::endl;
+    } else {
+      response.status = ListUserBidsPageResponse::NLG;
+      serverState.verbose << "[ListUserBidsPage] User " << request.userID
+                          << " is not logged in" << std::endl;
+    }
+
+  } catch (NoOngoingBidsException &e) {
+    serverState.verbose << "[ListUserBidsPage] User " << request.userID
+                        << " has not bidded on any auction" << std::endl;
+    response.status = ListUserBidsPageResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ListUserBidsPage] Invalid packet received"
+                        << std::endl;
+    response.status = ListUserBidsPageResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ListUserBidsPage] There was an unhandled exception "
+                         "that prevented the user from listing bids: "
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
 }
 
-void handleShowRecord(AuctionServerState &serverState, std::stringstream &buf,
+void handleShowRecord(AuctionServerState &serverState, std::string_view buf,
                       SocketAddress &addressFrom) {
-  std::cout << "Handling show record request" << std::endl;
+  serverState.info << "Handling show record request" << std::endl;
 
   ShowRecordRequest request;
   ShowRecordResponse response;
 
   try {
-    request.deserialize(buf);
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
     serverState.verbose << "[ShowRecord] User "
                         << " requested to show record of auction "
                         << request.auctionID << std::endl;
@@ -314,33 +539,151 @@ void handleShowRecord(AuctionServerState &serverState, std::stringstream &buf,
     serverState.verbose << "[ShowRecord] Invalid packet received" << std::endl;
     response.status = ShowRecordResponse::ERR;
   } catch (std::exception &e) {
-    std::cerr << "[ShowRecord] There was an unhandled exception that "
-                 "prevented the user from showing the record"
-              << e.what() << std::endl;
+    serverState.error << "[ShowRecord] There was an unhandled exception that "
+                         "prevented the user from showing the record"
+                      << e.what() << std::endl;
     return;
   }
 
-  send_packet(response, addressFrom.socket,
-              (struct sockaddr *)&addressFrom.addr, addressFrom.size);
+  sendResponse(response, addressFrom);
+}
+
+void handleListAuctionsDelta(AuctionServerState &serverState,
+                             std::string_view buf, SocketAddress &addressFrom) {
+  serverState.info << "Handling list auctions delta request" << std::endl;
+
+  ListAuctionsDeltaRequest request;
+  ListAuctionsDeltaResponse response;
+
+  try {
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ListAuctionsDelta] User "
+                        << " requested the auctions changed since version "
+                        << request.version << std::endl;
+
+    response.auctions = serverState.auctionManager.getAuctionListChanges(
+        request.version, response.version);
+    response.status = response.version == request.version
+                          ? ListAuctionsDeltaResponse::NMD
+                          : ListAuctionsDeltaResponse::OK;
+    serverState.verbose << "[ListAuctionsDelta] " << response.auctions.size()
+                        << " auctions changed" << std::endl;
+  } catch (NoAuctionsException &e) {
+    serverState.verbose << "[ListAuctionsDelta] No auctions to list"
+                        << std::endl;
+    response.status = ListAuctionsDeltaResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ListAuctionsDelta] Invalid packet received"
+                        << std::endl;
+    response.status = ListAuctionsDeltaResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ListAuctionsDelta] There was an unhandled exception "
+                         "that prevented the user from listing auctions"
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
+}
+
+void handleShowRecordDelta(AuctionServerState &serverState,
+                           std::string_view buf, SocketAddress &addressFrom) {
+  serverState.info << "Handling show record delta request" << std::endl;
+
+  ShowRecordDeltaRequest request;
+  ShowRecordDeltaResponse response;
+
+  try {
+    readRequest(request, buf, addressFrom);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ShowRecordDelta] User "
+                        << " requested the changes to auction "
+                        << request.auctionID << " since version "
+                        << request.version << std::endl;
+
+    std::tie(response.version, response.bids, response.end) =
+        serverState.auctionManager.getAuctionRecordChanges(request.auctionID,
+                                                           request.version);
+    response.status = response.version == request.version
+                          ? ShowRecordDeltaResponse::NMD
+                          : ShowRecordDeltaResponse::OK;
+    serverState.verbose << "[ShowRecordDelta] " << response.bids.size()
+                        << " new bids shown" << std::endl;
+  } catch (AuctionNotFoundException &e) {
+    serverState.verbose << "[ShowRecordDelta] Auction " << request.auctionID
+                        << " not found" << std::endl;
+    response.status = ShowRecordDeltaResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ShowRecordDelta] Invalid packet received"
+                        << std::endl;
+    response.status = ShowRecordDeltaResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ShowRecordDelta] There was an unhandled exception "
+                         "that prevented the user from showing the record"
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
+}
+
+void handleStats(AuctionServerState &serverState, std::string_view buf,
+                 SocketAddress &addressFrom) {
+  serverState.info << "Handling stats request" << std::endl;
+
+  StatsRequest request;
+  StatsResponse response;
+  try {
+    readRequest(request, buf, addressFrom);
+    if (!isLoopback(addressFrom.addr)) {
+      serverState.verbose << "[Stats] Refused a stats request from another "
+                             "machine"
+                          << std::endl;
+      response.status = StatsResponse::NOK;
+    } else {
+      std::ostringstream report;
+      serverState.requestStats.report(report);
+      response.report = report.str();
+      response.status = StatsResponse::OK;
+    }
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[Stats] Invalid packet received" << std::endl;
+    response.status = StatsResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[Stats] There was an unhandled exception that "
+                         "prevented the stats from being reported"
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, addressFrom);
 }
 
 void handleOpenAuction(AuctionServerState &serverState, int fd) {
 
-  std::cout << "Handling open auction request" << std::endl;
+  serverState.info << "Handling open auction request" << std::endl;
 
   OpenAuctionRequest request;
   OpenAuctionResponse response;
   try {
-    request.receive(fd);
+    receiveRequest(request, fd);
     validateOpenAuctionArgs(request.userID, request.password,
                             request.auctionName, request.startValue,
                             request.timeActive, request.assetFileName,
                             request.assetSize);
+
+    // must confirm the user password is correct
+    if (serverState.usersManager.getUserPassword(request.userID) !=
+        request.password) {
+      throw InvalidPacketException();
+    }
+
     serverState.verbose << "[OpenAuction] User " << request.userID
                         << " requested to open an auction" << std::endl;
 
     if (serverState.usersManager.isUserLoggedIn(request.userID) == 0) {
-
+      // a new auction cannot be archived, so the archive lock is not needed
       uint32_t auctionID = serverState.auctionManager.openAuction(
           request.userID, request.auctionName, request.startValue,
           request.timeActive, request.assetFileName, request.assetPath);
@@ -376,24 +719,30 @@ void handleOpenAuction(AuctionServerState &serverState, int fd) {
     response.status = OpenAuctionResponse::ERR;
     serverState.verbose << "[OpenAuction] Invalid packet received" << std::endl;
 
+    // discard the asset that was uploaded with the rejected request
+    if (!request.assetPath.empty()) {
+      delete_directory(
+          request.assetPath.substr(0, request.assetPath.find_first_of(SLASH)));
+    }
+
   } catch (std::exception &e) {
-    std::cerr
-        << "[OpenAuction] There was an unhandled exception that prevented "
-           "the user from opening an auction"
-        << e.what() << std::endl;
+    serverState.error << "[OpenAuction] There was an unhandled exception that "
+                         "prevented the user from opening an auction"
+                      << e.what() << std::endl;
     return;
   }
-  response.send(fd);
+  sendResponse(response, fd);
 }
 
 void handleCloseAuction(AuctionServerState &serverState, int fd) {
-  std::cout << "Handling close auction request" << std::endl;
+  serverState.info << "Handling close auction request" << std::endl;
 
   CloseAuctionRequest request;
   CloseAuctionResponse response;
 
   try {
-    request.receive(fd);
+    receiveRequest(request, fd);
+    auto archive = serverState.lockArchive();
     serverState.verbose << "[CloseAuction] User " << request.userID
                         << " requested to close an auction" << std::endl;
 
@@ -445,32 +794,38 @@ void handleCloseAuction(AuctionServerState &serverState, int fd) {
                         << std::endl;
 
   } catch (std::exception &e) {
-    std::cerr
-        << "[CloseAuction] There was an unhandled exception that prevented "
-           "the user from closing an auction"
-        << e.what() << std::endl;
+    serverState.error << "[CloseAuction] There was an unhandled exception that "
+                         "prevented the user from closing an auction"
+                      << e.what() << std::endl;
     return;
   }
 
-  response.send(fd);
+  sendResponse(response, fd);
 }
 
 void handleShowAsset(AuctionServerState &serverState, int fd) {
-  std::cout << "Handling show assets request" << std::endl;
+  serverState.info << "Handling show assets request" << std::endl;
 
   ShowAssetRequest request;
   ShowAssetResponse response;
   try {
-    request.receive(fd);
+    receiveRequest(request, fd);
     serverState.verbose
         << "[ShowAsset] An user has requested to show an asset of auction "
         << request.auctionID << std::endl;
 
-    std::tuple<std::string, uint32_t, std::string> asset =
+    auto archive = serverState.lockArchive();
+    std::tuple<std::string, uint32_t, std::string, uint32_t> asset =
         serverState.auctionManager.getAuctionAsset(request.auctionID);
     response.assetFileName = std::get<0>(asset);
     response.assetSize = std::get<1>(asset);
     response.assetPath = std::get<2>(asset);
+    response.assetOffset = std::get<3>(asset);
+    // opened before the lock is released, so it is still sent if the archiver
+    // removes the live files of the auction meanwhile
+    response.assetFile.open(response.assetPath,
+                            std::ios::in | std::ios::binary);
+    threadIO.opens++;
     response.status = ShowAssetResponse::OK;
 
     serverState.verbose << "[ShowAsset] Asset of auction " << request.auctionID
@@ -491,23 +846,24 @@ void handleShowAsset(AuctionServerState &serverState, int fd) {
 
   } catch (
       std::exception &e) { // TODO: catch only the exceptions that can be thrown
-    std::cerr << "[ShowAsset] There was an unhandled exception that prevented "
-                 "the user from showing an asset"
-              << e.what() << std::endl;
+    serverState.error << "[ShowAsset] There was an unhandled exception that "
+                         "prevented the user from showing an asset"
+                      << e.what() << std::endl;
     return;
   }
 
-  response.send(fd);
+  sendResponse(response, fd);
 }
 
 void handleBid(AuctionServerState &serverState, int fd) {
-  std::cout << "Handling bid request" << std::endl;
+  serverState.info << "Handling bid request" << std::endl;
 
   BidRequest request;
   BidResponse response;
 
   try {
-    request.receive(fd);
+    receiveRequest(request, fd);
+    auto archive = serverState.lockArchive();
     serverState.verbose << "[Bid] User " << request.userID
                         << " requested to bid on an auction" << std::endl;
 
@@ -558,11 +914,116 @@ void handleBid(AuctionServerState &serverState, int fd) {
     serverState.verbose << "[Bid] Invalid packet received" << std::endl;
 
   } catch (std::exception &e) {
-    std::cerr << "[Bid] There was an unhandled exception that prevented "
-                 "the user from bidding on an auction "
-              << e.what() << std::endl;
+    serverState.error << "[Bid] There was an unhandled exception that "
+                         "prevented the user from bidding on an auction "
+                      << e.what() << std::endl;
     return;
   }
 
-  response.send(fd);
-}
\ No newline at end of file
+  sendResponse(response, fd);
+}
+
+void handleListAuctionsStream(AuctionServerState &serverState, int fd) {
+  serverState.info << "Handling list auctions stream request" << std::endl;
+
+  ListAuctionsStreamRequest request;
+  ListAuctionsStreamResponse response;
+  try {
+    receiveRequest(request, fd);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[ListAuctionsStream] User requested to list all "
+                           "auctions"
+                        << std::endl;
+
+    response.auctions = serverState.auctionManager.listAuctionsPage(
+        LIST_CURSOR_START, LIST_PAGE_SIZE, nullptr);
+    if (response.auctions.empty()) {
+      throw NoAuctionsException();
+    }
+    // the following pages are only listed while they are being sent
+    response.nextPage = [&serverState](const std::string &cursor) {
+      auto pageArchive = serverState.lockArchive();
+      return serverState.auctionManager.listAuctionsPage(
+          cursor, LIST_PAGE_SIZE, nullptr);
+    };
+    response.status = ListAuctionsStreamResponse::OK;
+  } catch (NoAuctionsException &e) {
+    serverState.verbose << "[ListAuctionsStream] No auctions to list"
+                        << std::endl;
+    response.status = ListAuctionsStreamResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[ListAuctionsStream] Invalid packet received"
+                        << std::endl;
+    response.status = ListAuctionsStreamResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[ListAuctionsStream] There was an unhandled "
+                         "exception that prevented the user from listing "
+                         "auctions "
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, fd);
+  serverState.verbose << "[ListAuctionsStream] Auctions listed successfully"
+                      << std::endl;
+}
+
+void handleWatch(AuctionServerState &serverState, int fd) {
+  serverState.info << "Handling watch request" << std::endl;
+
+  WatchRequest request;
+  WatchResponse response;
+  try {
+    receiveRequest(request, fd);
+    auto archive = serverState.lockArchive();
+    serverState.verbose << "[Watch] User requested to watch auction "
+                        << request.auctionID << " for " << request.timeout
+                        << " seconds" << std::endl;
+
+    // held open past its connection, so counted against its source apart
+    struct sockaddr_in source = {};
+    socklen_t sourceLength = sizeof(source);
+    getpeername(fd, (struct sockaddr *)&source, &sourceLength);
+    AdmissionControl &admission = serverState.admission;
+    if (admission.admitWatcher(source) != ADMITTED) {
+      serverState.requestStats.countRejected(WATCHERS_EXCEEDED);
+      throw WatchersLimitExceededException();
+    }
+
+    bool held = false;
+    try {
+      held = serverState.auctionManager.watchAuction(
+          request.auctionID, fd, request.timeout,
+          [&admission, source]() { admission.releaseWatcher(source); });
+    } catch (...) {
+      admission.releaseWatcher(source);
+      throw;
+    }
+    if (held) {
+      // answered by whichever request changes the auction, or on timeout
+      return;
+    }
+    admission.releaseWatcher(source);
+    response.status = WatchResponse::CLS;
+    serverState.verbose << "[Watch] Auction " << request.auctionID
+                        << " is already closed" << std::endl;
+  } catch (AuctionNotFoundException &e) {
+    serverState.verbose << "[Watch] Auction " << request.auctionID
+                        << " not found" << std::endl;
+    response.status = WatchResponse::NOK;
+  } catch (WatchersLimitExceededException &e) {
+    serverState.verbose << "[Watch] Too many watch requests held open"
+                        << std::endl;
+    response.status = WatchResponse::NOK;
+  } catch (InvalidPacketException &e) {
+    serverState.verbose << "[Watch] Invalid packet received" << std::endl;
+    response.status = WatchResponse::ERR;
+  } catch (std::exception &e) {
+    serverState.error << "[Watch] There was an unhandled exception that "
+                         "prevented the user from watching an auction "
+                      << e.what() << std::endl;
+    return;
+  }
+
+  sendResponse(response, fd);
+}
@@ -2,6 +2,7 @@
 #define HANDLERS_H
 
 #include <sstream>
+#include <string_view>
 
 #include "../utils/constants.hpp"
 #include "server_state.hpp"
@@ -16,7 +17,7 @@
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleLogin(AuctionServerState &state, std::stringstream &buf,
+void handleLogin(AuctionServerState &state, std::string_view buf,
                  SocketAddress &addressFrom);
 
 /**
@@ -26,7 +27,7 @@ void handleLogin(AuctionServerState &state, std::stringstream &buf,
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleLogout(AuctionServerState &state, std::stringstream &buf,
+void handleLogout(AuctionServerState &state, std::string_view buf,
                   SocketAddress &addressFrom);
 
 /**
@@ -37,7 +38,7 @@ void handleLogout(AuctionServerState &state, std::stringstream &buf,
  * @param addressFrom The address of the sender.
 
 */
-void handleUnregister(AuctionServerState &state, std::stringstream &buf,
+void handleUnregister(AuctionServerState &state, std::string_view buf,
                       SocketAddress &addressFrom);
 
 /**
@@ -47,7 +48,7 @@ void handleUnregister(AuctionServerState &state, std::stringstream &buf,
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleListUserAuctions(AuctionServerState &state, std::stringstream &buf,
+void handleListUserAuctions(AuctionServerState &state, std::string_view buf,
                             SocketAddress &addressFrom);
 
 /**
@@ -57,7 +58,7 @@ void handleListUserAuctions(AuctionServerState &state, std::stringstream &buf,
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleListUserBids(AuctionServerState &state, std::stringstream &buf,
+void handleListUserBids(AuctionServerState &state, std::string_view buf,
                         SocketAddress &addressFrom);
 
 /**
@@ -67,9 +68,40 @@ void handleListUserBids(AuctionServerState &state, std::stringstream &buf,
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleListAuctions(AuctionServerState &state, std::stringstream &buf,
+void handleListAuctions(AuctionServerState &state, std::string_view buf,
                         SocketAddress &addressFrom);
 
+/**
+ * @brief Handles a request for a page of the list of all auctions.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleListAuctionsPage(AuctionServerState &state, std::string_view buf,
+                            SocketAddress &addressFrom);
+
+/**
+ * @brief Handles a request for a page of the auctions of an user.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleListUserAuctionsPage(AuctionServerState &state,
+                                std::string_view buf,
+                                SocketAddress &addressFrom);
+
+/**
+ * @brief Handles a request for a page of the bids of an user.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleListUserBidsPage(AuctionServerState &state, std::string_view buf,
+                            SocketAddress &addressFrom);
+
 /**
  * @brief Handles a show record of an aution request.
  *
@@ -77,9 +109,41 @@ void handleListAuctions(AuctionServerState &state, std::stringstream &buf,
  * @param buf The packet buffer.
  * @param addressFrom The address of the sender.
  */
-void handleShowRecord(AuctionServerState &state, std::stringstream &buf,
+void handleShowRecord(AuctionServerState &state, std::string_view buf,
                       SocketAddress &addressFrom);
 
+/**
+ * @brief Handles a request for the auctions that changed since a catalog
+ * version.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleListAuctionsDelta(AuctionServerState &state, std::string_view buf,
+                             SocketAddress &addressFrom);
+
+/**
+ * @brief Handles a request for the changes to the record of an auction since
+ * a record version.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleShowRecordDelta(AuctionServerState &state, std::string_view buf,
+                           SocketAddress &addressFrom);
+
+/**
+ * @brief Handles a stats request, which is only answered to the same machine.
+ *
+ * @param state The current server state.
+ * @param buf The packet buffer.
+ * @param addressFrom The address of the sender.
+ */
+void handleStats(AuctionServerState &state, std::string_view buf,
+                 SocketAddress &addressFrom);
+
 // TCP handlers
 
 /**
@@ -117,4 +181,20 @@ void handleShowAsset(AuctionServerState &state, int fd);
  */
 void handleBid(AuctionServerState &state, int fd);
 
+/**
+ * @brief Handles a streamed list auctions request.
+ *
+ * @param state The current server state.
+ * @param fd The file descriptor of the connection.
+ */
+void handleListAuctionsStream(AuctionServerState &state, int fd);
+
+/**
+ * @brief Handles a watch request, which is answered once the auction changes.
+ *
+ * @param state The current server state.
+ * @param fd The file descriptor of the connection.
+ */
+void handleWatch(AuctionServerState &state, int fd);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "listing_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include "../utils/utils.hpp"
+
+ListingCache::ListingCache() {
+  using std::chrono::microseconds;
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  startVersion =
+      (uint64_t)std::chrono::duration_cast<microseconds>(now).count();
+  version = startVersion;
+}
+
+bool ListingCache::isCurrent() const {
+  return renderedVersion == version && std::time(nullptr) < expiresAt;
+}
+
+uint64_t ListingCache::getVersion() {
+  std::lock_guard<std::mutex> guard(lock);
+  return version;
+}
+
+bool ListingCache::copyTo(PacketBuffer &buffer) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!isCurrent()) {
+    return false;
+  }
+  buffer.write(reply);
+  return true;
+}
+
+uint64_t ListingCache::getChanges(
+    uint64_t since, std::vector<std::pair<std::string, uint8_t>> &changes) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (!isCurrent()) {
+    return 0;
+  }
+
+  bool known = since >= startVersion && since <= version;
+  for (uint32_t i = 1; i <= AUCTION_ID_MAX; i++) {
+    if (stateOffsets[i] != 0 && (!known || changedAt[i] > since)) {
+      changes.push_back(
+          std::make_pair(intToStringWithZeros((int)i, AUCTION_ID_LENGTH),
+                         (uint8_t)(reply[stateOffsets[i]] - '0')));
+    }
+  }
+  return version;
+}
+
+void ListingCache::store(
+    uint64_t builtVersion, std::string_view builtReply,
+    const std::vector<std::pair<std::string, uint8_t>> &auctions,
+    time_t builtExpiresAt) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (builtVersion != version) { // an auction was opened or closed meanwhile
+    return;
+  }
+
+  reply = builtReply;
+  std::fill(std::begin(stateOffsets), std::end(stateOffsets), 0);
+  // every auction is listed as " <aid> <state>"
+  size_t offset = 0;
+  for (const auto &auction : auctions) {
+    offset = reply.find(" " + auction.first + " ", offset);
+    if (offset == std::string::npos) {
+      return; // unexpected reply, leave it out of the cache
+    }
+    offset += auction.first.length() + 2;
+    stateOffsets[std::stoi(auction.first)] = (uint32_t)offset;
+  }
+
+  renderedVersion = version;
+  expiresAt = builtExpiresAt;
+}
+
+void ListingCache::markOpened(const std::string &auctionID) {
+  std::lock_guard<std::mutex> guard(lock);
+  version++;
+  changedAt[std::stoi(auctionID)] = version;
+}
+
+void ListingCache::markClosed(const std::string &auctionID) {
+  std::lock_guard<std::mutex> guard(lock);
+  bool upToDate = renderedVersion == version;
+  version++;
+  changedAt[std::stoi(auctionID)] = version;
+
+  uint32_t offset = stateOffsets[std::stoi(auctionID)];
+  if (upToDate && offset != 0) { // a single state flip, patch it in place
+    reply[offset] = '0';
+    renderedVersion = version;
+  }
+}
@@ -0,0 +1,112 @@
+#ifndef LISTING_CACHE_H
+#define LISTING_CACHE_H
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../utils/constants.hpp"
+#include "../utils/packet_buffer.hpp"
+
+/**
+ * @class ListingCache
+ *
+ * @brief Keeps the serialized reply to a list auctions request.
+ *
+ * The reply is tagged with the version of the auction catalog it was built
+ * from. Opening an auction bumps the version, so the reply is built again on
+ * the next request, while closing one just flips its state in the reply. The
+ * reply also goes stale once the first of its active auctions expires.
+ *
+ * The version starts at the time the AS started, in microseconds, so versions
+ * handed out before a restart are older than every version handed out after.
+ * The version every auction last changed at is kept, to list only the auctions
+ * that changed since a version.
+ */
+class ListingCache {
+  std::mutex lock;
+  uint64_t startVersion;        // version of the catalog when the AS started
+  uint64_t version;             // version of the auction catalog
+  uint64_t renderedVersion = 0; // version the reply was built from
+  time_t expiresAt = 0;         // when the first active auction expires
+  std::string reply;
+  // offset of the state of every auction in the reply, or 0 if not listed
+  uint32_t stateOffsets[AUCTION_ID_MAX + 1] = {};
+  // version every auction was opened or closed at, or 0 if before the start
+  uint64_t changedAt[AUCTION_ID_MAX + 1] = {};
+
+  /**
+   * @brief Checks if the cached reply is up to date, with the lock held.
+   *
+   * @return true if the reply can be used
+   */
+  bool isCurrent() const;
+
+public:
+  /**
+   * @brief Construct a new Listing Cache object, starting at the current
+   * time.
+   */
+  ListingCache();
+
+  /**
+   * @brief Gets the current version of the auction catalog.
+   *
+   * @return the catalog version
+   */
+  uint64_t getVersion();
+
+  /**
+   * @brief Writes the cached reply to a buffer, if it is up to date.
+   *
+   * @param buffer the buffer to write to
+   * @return true if the reply was written, false if it must be built again
+   */
+  bool copyTo(PacketBuffer &buffer);
+
+  /**
+   * @brief Caches a reply, unless the catalog changed while it was built.
+   *
+   * @param version the catalog version, read before building the reply
+   * @param reply the serialized reply
+   * @param auctions the auctions in the reply, in order
+   * @param expiresAt when the first active auction in the reply expires
+   */
+  void store(uint64_t version, std::string_view reply,
+             const std::vector<std::pair<std::string, uint8_t>> &auctions,
+             time_t expiresAt);
+
+  /**
+   * @brief Gets the auctions whose state changed after a version, from the
+   * cached reply.
+   *
+   * A version the AS does not know, from before it started or from the
+   * future, gets every auction.
+   *
+   * @param since the catalog version the client has seen
+   * @param changes the vector to add the changed auction IDs and states to
+   * @return the catalog version of the changes, or 0 if the reply is stale
+   */
+  uint64_t getChanges(uint64_t since,
+                      std::vector<std::pair<std::string, uint8_t>> &changes);
+
+  /**
+   * @brief Marks the catalog as changed, after an auction was opened.
+   *
+   * @param auctionID the opened auction ID
+   */
+  void markOpened(const std::string &auctionID);
+
+  /**
+   * @brief Marks an auction as closed, patching the cached reply.
+   *
+   * @param auctionID the closed auction ID
+   */
+  void markClosed(const std::string &auctionID);
+};
+
+#endif
@@ -0,0 +1,296 @@
+#include "request_stats.hpp"
+
+#include <linux/sockios.h>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+#include "../utils/utils.hpp"
+
+// the request being handled by the thread, which its reply is noted in
+static thread_local RequestTimer *currentTimer = nullptr;
+
+// the status of the requests that were not replied to by their handler
+static const char *const NO_REPLY = "none";
+
+size_t LatencyHistogram::bucketOf(uint64_t micros) {
+  if (micros < STATS_SUB_BUCKETS) { // exact below the first power of two split
+    return (size_t)micros;
+  }
+  int exponent = 63 - __builtin_clzll(micros);
+  if (exponent >= STATS_LATENCY_BITS) {
+    return STATS_LATENCY_BUCKETS - 1;
+  }
+  // the bits right after the highest one pick the bucket within its power
+  size_t sub = (size_t)(micros >> (exponent - STATS_SUB_BUCKETS_BITS)) -
+               STATS_SUB_BUCKETS;
+  return (size_t)(exponent - STATS_SUB_BUCKETS_BITS + 1) * STATS_SUB_BUCKETS +
+         sub;
+}
+
+uint64_t LatencyHistogram::lowestOf(size_t bucket) {
+  if (bucket < STATS_SUB_BUCKETS) {
+    return bucket;
+  }
+  int exponent = (int)(bucket / STATS_SUB_BUCKETS) + STATS_SUB_BUCKETS_BITS - 1;
+  uint64_t sub = bucket % STATS_SUB_BUCKETS;
+  return (STATS_SUB_BUCKETS + sub) << (exponent - STATS_SUB_BUCKETS_BITS);
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+  buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(micros, std::memory_order_relaxed);
+  uint64_t largest = max.load(std::memory_order_relaxed);
+  while (micros > largest &&
+         !max.compare_exchange_weak(largest, micros,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::total() const {
+  return count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::mean() const {
+  uint64_t recorded = total();
+  return recorded == 0 ? 0 : sum.load(std::memory_order_relaxed) / recorded;
+}
+
+uint64_t LatencyHistogram::largest() const {
+  return max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+  // the buckets are read one at a time while others may be recording, so
+  // they are summed up instead of trusting the count
+  std::array<uint64_t, STATS_LATENCY_BUCKETS> snapshot;
+  uint64_t recorded = 0;
+  for (size_t i = 0; i < STATS_LATENCY_BUCKETS; i++) {
+    snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+    recorded += snapshot[i];
+  }
+  if (recorded == 0) {
+    return 0;
+  }
+
+  uint64_t rank = (uint64_t)std::ceil(percentile / 100 * (double)recorded);
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < STATS_LATENCY_BUCKETS; i++) {
+    seen += snapshot[i];
+    if (seen >= rank) {
+      return std::min(lowestOf(i + 1) - 1, largest());
+    }
+  }
+  return largest();
+}
+
+void IOTotals::add(const IOCounters &start, const IOCounters &end) {
+  opens.fetch_add(end.opens - start.opens, std::memory_order_relaxed);
+  stats.fetch_add(end.stats - start.stats, std::memory_order_relaxed);
+  changes.fetch_add(end.changes - start.changes, std::memory_order_relaxed);
+  bytesRead.fetch_add(end.bytesRead - start.bytesRead,
+                      std::memory_order_relaxed);
+  bytesWritten.fetch_add(end.bytesWritten - start.bytesWritten,
+                         std::memory_order_relaxed);
+  dirEntries.fetch_add(end.dirEntries - start.dirEntries,
+                       std::memory_order_relaxed);
+  locks.fetch_add(end.locks - start.locks, std::memory_order_relaxed);
+}
+
+HandlerStats::HandlerStats(const char *id)
+    : packetID{packPacketID(id)}, name{id} {}
+
+void HandlerStats::countStatus(const char *status) {
+  for (size_t i = 0; i < STATS_STATUSES_MAX; i++) {
+    const char *slot = statusNames[i].load(std::memory_order_acquire);
+    if (slot == nullptr &&
+        statusNames[i].compare_exchange_strong(slot, status,
+                                               std::memory_order_acq_rel)) {
+      slot = status; // the first reply with this status
+    }
+    if (slot == status) {
+      statusCounts[i].fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+  // more statuses than any reply has, so this is never reached
+}
+
+void HandlerStats::report(std::ostream &stream) const {
+  stream << std::left << std::setw(4) << name << std::right << std::setw(9)
+         << requests.load(std::memory_order_relaxed) << std::setw(12)
+         << bytesIn.load(std::memory_order_relaxed) << std::setw(12)
+         << bytesOut.load(std::memory_order_relaxed) << std::setw(9)
+         << latency.mean() << std::setw(9) << latency.percentile(50)
+         << std::setw(9) << latency.percentile(90) << std::setw(9)
+         << latency.percentile(99) << std::setw(9) << latency.percentile(99.9)
+         << std::setw(9) << latency.largest();
+  const char *separator = "  ";
+  for (size_t i = 0; i < STATS_STATUSES_MAX; i++) {
+    const char *status = statusNames[i].load(std::memory_order_acquire);
+    if (status != nullptr) {
+      stream << separator << status << "="
+             << statusCounts[i].load(std::memory_order_relaxed);
+      separator = " ";
+    }
+  }
+  stream << std::endl;
+}
+
+void HandlerStats::reportIO(std::ostream &stream) const {
+  uint64_t handled = requests.load(std::memory_order_relaxed);
+  auto perRequest = [handled](const std::atomic<uint64_t> &total) {
+    uint64_t sum = total.load(std::memory_order_relaxed);
+    return handled == 0 ? 0.0 : (double)sum / (double)handled;
+  };
+  std::ios_base::fmtflags flags = stream.flags();
+  std::streamsize precision = stream.precision(1);
+  stream << std::fixed << std::left << std::setw(4) << name << std::right
+         << std::setw(9) << perRequest(io.opens) << std::setw(9)
+         << perRequest(io.stats) << std::setw(9) << perRequest(io.changes)
+         << std::setw(12) << perRequest(io.bytesRead) << std::setw(14)
+         << perRequest(io.bytesWritten) << std::setw(12)
+         << perRequest(io.dirEntries) << std::setw(9) << perRequest(io.locks)
+         << std::endl;
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+RequestStats::RequestStats(const std::vector<const char *> &ids) {
+  for (const char *id : ids) {
+    handlers.emplace_back(id);
+  }
+}
+
+HandlerStats *RequestStats::find(uint32_t packetID) {
+  for (auto &handler : handlers) {
+    if (handler.packetID == packetID) {
+      return &handler;
+    }
+  }
+  return nullptr;
+}
+
+void RequestStats::countUnknown() {
+  unknown.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RequestStats::countRejected(Admission reason, size_t bytes) {
+  rejected[reason].fetch_add(1, std::memory_order_relaxed);
+  rejectedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void RequestStats::countEvicted() {
+  evicted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RequestStats::report(std::ostream &stream) const {
+  auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::steady_clock::now() - started);
+  stream << "Requests handled in the last " << uptime.count()
+         << " seconds, latencies in microseconds" << std::endl;
+  stream << std::left << std::setw(4) << "ID" << std::right << std::setw(9)
+         << "requests" << std::setw(12) << "bytes_in" << std::setw(12)
+         << "bytes_out" << std::setw(9) << "mean" << std::setw(9) << "p50"
+         << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9)
+         << "p99.9" << std::setw(9) << "max"
+         << "  replies" << std::endl;
+  for (const auto &handler : handlers) {
+    handler.report(stream);
+  }
+  stream << "File system operations per request, on average" << std::endl;
+  stream << std::left << std::setw(4) << "ID" << std::right << std::setw(9)
+         << "opens" << std::setw(9) << "stats" << std::setw(9) << "changes"
+         << std::setw(12) << "bytes_read" << std::setw(14) << "bytes_written"
+         << std::setw(12) << "dir_entries" << std::setw(9) << "locks"
+         << std::endl;
+  for (const auto &handler : handlers) {
+    handler.reportIO(stream);
+  }
+  stream << "Requests with an unknown packet ID: "
+         << unknown.load(std::memory_order_relaxed) << std::endl;
+  stream << "Rejected by the admission control: "
+         << rejected[UDP_RATE_EXCEEDED].load(std::memory_order_relaxed)
+         << " UDP requests ("
+         << rejectedBytes.load(std::memory_order_relaxed) << " bytes), "
+         << rejected[TCP_RATE_EXCEEDED].load(std::memory_order_relaxed)
+         << " TCP connections over the rate, "
+         << rejected[CONNECTIONS_EXCEEDED].load(std::memory_order_relaxed)
+         << " over the open connections, "
+         << rejected[UPLOAD_RATE_EXCEEDED].load(std::memory_order_relaxed)
+         << " over the upload rate, "
+         << rejected[WORKERS_BUSY].load(std::memory_order_relaxed)
+         << " while every worker was busy, "
+         << rejected[WATCHERS_EXCEEDED].load(std::memory_order_relaxed)
+         << " watch requests over the open watchers" << std::endl;
+  stream << "TCP connections evicted for sending their request too slowly: "
+         << evicted.load(std::memory_order_relaxed) << std::endl;
+}
+
+void RequestStats::dump(const std::string &path) const {
+  std::string tmpPath = path + ".tmp";
+  std::ofstream file(tmpPath, std::ios::out | std::ios::trunc);
+  report(file);
+  file.close();
+  if (!file) {
+    delete_file(tmpPath);
+    throw IOException();
+  }
+  rename_file(tmpPath, path); // readers never see a half written report
+}
+
+RequestTimer::RequestTimer(HandlerStats &_stats, size_t _bytesIn)
+    : stats{_stats}, start{std::chrono::steady_clock::now()}, fd{-1},
+      bytesIn{_bytesIn}, bytesOut{0}, ioAtStart{threadIO},
+      outer{currentTimer} {
+  currentTimer = this;
+}
+
+RequestTimer::RequestTimer(HandlerStats &_stats, int _fd)
+    : stats{_stats}, start{std::chrono::steady_clock::now()}, fd{_fd},
+      bytesIn{0}, bytesOut{0}, ioAtStart{threadIO}, outer{currentTimer} {
+  currentTimer = this;
+}
+
+RequestTimer::~RequestTimer() {
+  currentTimer = outer;
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  stats.latency.record((uint64_t)elapsed.count());
+  stats.requests.fetch_add(1, std::memory_order_relaxed);
+  stats.io.add(ioAtStart, threadIO);
+
+  if (fd != -1) {
+    // counted by the kernel, from the packet ID to the last byte of the
+    // reply, which was either acknowledged or is still queued
+    struct tcp_info info = {};
+    socklen_t length = sizeof(info);
+    int queued = 0;
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+      bytesIn = info.tcpi_bytes_received;
+      bytesOut = info.tcpi_bytes_acked;
+      if (ioctl(fd, SIOCOUTQ, &queued) == 0 && queued > 0) {
+        bytesOut += (size_t)queued;
+      }
+    }
+  }
+  stats.bytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+  stats.bytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+  // the handler gave up before replying, or left the reply to another thread
+  stats.countStatus(status != nullptr ? status : NO_REPLY);
+}
+
+void RequestTimer::noteReply(const char *status, size_t bytesOut) {
+  if (currentTimer != nullptr) {
+    currentTimer->status = status;
+    currentTimer->bytesOut += bytesOut;
+  }
+}
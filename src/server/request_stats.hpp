@@ -0,0 +1,269 @@
+#ifndef REQUEST_STATS_H
+#define REQUEST_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../utils/constants.hpp"
+#include "../utils/io_counters.hpp"
+#include "admission_control.hpp"
+
+/**
+ * @class LatencyHistogram
+ *
+ * @brief Counts latencies, in microseconds, in log-linear buckets.
+ *
+ * Every power of two is split in STATS_SUB_BUCKETS buckets, so a percentile
+ * read from the histogram is off by at most 1/STATS_SUB_BUCKETS of its value,
+ * as in an HDR histogram. Recording only increments counters, so any number of
+ * threads can record at once without locking.
+ */
+class LatencyHistogram {
+  std::array<std::atomic<uint64_t>, STATS_LATENCY_BUCKETS> buckets{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> max{0};
+
+  /**
+   * @brief Gets the bucket of a latency.
+   *
+   * @param micros the latency, in microseconds
+   * @return the index of the bucket
+   */
+  static size_t bucketOf(uint64_t micros);
+
+  /**
+   * @brief Gets the smallest latency of a bucket.
+   *
+   * @param bucket the index of the bucket
+   * @return the latency, in microseconds
+   */
+  static uint64_t lowestOf(size_t bucket);
+
+public:
+  /**
+   * @brief Records a latency.
+   *
+   * @param micros the latency, in microseconds
+   */
+  void record(uint64_t micros);
+
+  /**
+   * @brief Gets the number of recorded latencies.
+   */
+  uint64_t total() const;
+
+  /**
+   * @brief Gets the mean of the recorded latencies.
+   */
+  uint64_t mean() const;
+
+  /**
+   * @brief Gets the largest recorded latency.
+   */
+  uint64_t largest() const;
+
+  /**
+   * @brief Gets a percentile of the recorded latencies.
+   *
+   * @param percentile the percentile, between 0 and 100
+   * @return the highest latency of the bucket the percentile falls in, or 0 if
+   * nothing was recorded
+   */
+  uint64_t percentile(double percentile) const;
+};
+
+/**
+ * @brief The file system operations of every request with a packet ID, summed
+ * up, as counted by IOCounters.
+ */
+struct IOTotals {
+  std::atomic<uint64_t> opens{0};
+  std::atomic<uint64_t> stats{0};
+  std::atomic<uint64_t> changes{0};
+  std::atomic<uint64_t> bytesRead{0};
+  std::atomic<uint64_t> bytesWritten{0};
+  std::atomic<uint64_t> dirEntries{0};
+  std::atomic<uint64_t> locks{0};
+
+  /**
+   * @brief Adds the operations of a request.
+   *
+   * @param start the operations of its thread before the request
+   * @param end the operations of its thread after the request
+   */
+  void add(const IOCounters &start, const IOCounters &end);
+};
+
+/**
+ * @class HandlerStats
+ *
+ * @brief The latencies and counters of the requests with a packet ID.
+ */
+class HandlerStats {
+  // the statuses of the replies are told apart by the address of their name,
+  // which is the same for every reply of a kind
+  std::array<std::atomic<const char *>, STATS_STATUSES_MAX> statusNames{};
+  std::array<std::atomic<uint64_t>, STATS_STATUSES_MAX> statusCounts{};
+
+public:
+  uint32_t packetID; // packed by packPacketID
+  std::string name;
+  LatencyHistogram latency;
+  std::atomic<uint64_t> requests{0};
+  std::atomic<uint64_t> bytesIn{0};
+  std::atomic<uint64_t> bytesOut{0};
+  IOTotals io;
+
+  HandlerStats(const char *id);
+
+  /**
+   * @brief Counts a reply with a status.
+   *
+   * @param status the name of the status, which must outlive the stats
+   */
+  void countStatus(const char *status);
+
+  /**
+   * @brief Writes the counters and percentiles as a line of a report.
+   *
+   * @param stream the stream to write to
+   */
+  void report(std::ostream &stream) const;
+
+  /**
+   * @brief Writes the file system operations per request as a line of a
+   * report.
+   *
+   * @param stream the stream to write to
+   */
+  void reportIO(std::ostream &stream) const;
+};
+
+/**
+ * @class RequestStats
+ *
+ * @brief The latencies and counters of every request the AS handles, kept
+ * from when it started.
+ */
+class RequestStats {
+  std::deque<HandlerStats> handlers; // never moved once added
+  std::atomic<uint64_t> unknown{0};  // requests with an unknown packet ID
+  // requests and connections rejected by the admission control, by reason
+  std::array<std::atomic<uint64_t>, ADMISSION_COUNT> rejected = {};
+  std::atomic<uint64_t> rejectedBytes{0}; // of the rejected UDP requests
+  std::atomic<uint64_t> evicted{0};       // connections past their deadline
+  std::chrono::steady_clock::time_point started =
+      std::chrono::steady_clock::now();
+
+public:
+  /**
+   * @brief Constructs the stats of the requests with the given packet IDs.
+   *
+   * @param ids the packet IDs of the requests
+   */
+  RequestStats(const std::vector<const char *> &ids);
+
+  /**
+   * @brief Gets the stats of the requests with a packet ID.
+   *
+   * @param packetID the packet ID, packed by packPacketID
+   * @return the stats, or nullptr if the packet ID is unknown
+   */
+  HandlerStats *find(uint32_t packetID);
+
+  /**
+   * @brief Counts a request with an unknown packet ID.
+   */
+  void countUnknown();
+
+  /**
+   * @brief Counts a request or connection rejected by the admission control.
+   *
+   * @param reason why it was rejected
+   * @param bytes the size of the request, if it came over UDP
+   */
+  void countRejected(Admission reason, size_t bytes = 0);
+
+  /**
+   * @brief Counts a TCP connection given up on, as it did not send its
+   * request before its deadline.
+   */
+  void countEvicted();
+
+  /**
+   * @brief Writes a report of every request.
+   *
+   * @param stream the stream to write to
+   */
+  void report(std::ostream &stream) const;
+
+  /**
+   * @brief Writes a report of every request to a file, replacing it at once.
+   *
+   * @param path the path of the file
+   */
+  void dump(const std::string &path) const;
+};
+
+/**
+ * @class RequestTimer
+ *
+ * @brief Measures the handling of a request, from its construction to its
+ * destruction, and records it in the stats of the request, along with the file
+ * system operations its thread made meanwhile.
+ *
+ * The handler tells the timer of the calling thread how it replied, through
+ * noteReply, since the status of the reply is only known to it.
+ */
+class RequestTimer {
+  HandlerStats &stats;
+  std::chrono::steady_clock::time_point start;
+  int fd;          // the connection of a TCP request, or -1
+  size_t bytesIn;  // of a UDP request
+  size_t bytesOut; // of a UDP reply
+  const char *status = nullptr;
+  IOCounters ioAtStart; // the file system operations of the thread
+  RequestTimer *outer;  // the timer this one is nested in, if any
+
+public:
+  /**
+   * @brief Starts measuring a UDP request.
+   *
+   * @param stats the stats of the request
+   * @param bytesIn the size of the request, as received
+   */
+  RequestTimer(HandlerStats &stats, size_t bytesIn);
+
+  /**
+   * @brief Starts measuring a TCP request, whose bytes in and out are read
+   * from its connection.
+   *
+   * @param stats the stats of the request
+   * @param fd the connection of the request, which must stay open until the
+   * timer is destroyed
+   */
+  RequestTimer(HandlerStats &stats, int fd);
+
+  RequestTimer(const RequestTimer &) = delete;
+  RequestTimer &operator=(const RequestTimer &) = delete;
+
+  ~RequestTimer();
+
+  /**
+   * @brief Notes the reply to the request being handled by the calling
+   * thread, if any.
+   *
+   * @param status the name of the status of the reply
+   * @param bytesOut the size of the reply, if it was sent over UDP
+   */
+  static void noteReply(const char *status, size_t bytesOut = 0);
+};
+
+#endif
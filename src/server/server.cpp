@@ -1,14 +1,21 @@
 #include "server.hpp"
 
 #include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include <iostream>
 #include <string>
 #include <thread>
 
+#include "../utils/tracer.hpp"
+
 extern bool is_exiting; // flag to indicate whether the application is exiting
 
 int main(int argc, char *argv[]) {
@@ -24,40 +31,63 @@ int main(int argc, char *argv[]) {
 
     setup_custom_signal_handlers(); // change the signal handlers to our own
     setupDB();                      // setup the database
+    raiseOpenFilesLimit();          // for the watch requests held open
+    blockTraceSignal();             // before any thread is started
+    tracer.setSampling(config.traceSampling);
 
     AuctionServerState serverState(config.port, config.verbose);
-    serverState.registerHandlers(); // register all handlers with the manager
+    serverState.admission.setLimits(config.limits);
 
     serverState.verbose << "Server is running on verbose mode" << std::endl;
 
     // start the TCP thread
     std::thread tcp_thread(tcpMainThread, std::ref(serverState));
+    // start the archiver thread
+    std::thread archiver_thread(archiverThread, std::ref(serverState),
+                                config.archiveAfter);
+    // start the thread that times out watch requests
+    std::thread watcher_thread(watcherThread, std::ref(serverState));
+    // start the thread that dumps the request stats, if asked to
+    std::thread stats_thread;
+    if (config.statsInterval > 0) {
+      stats_thread = std::thread(statsThread, std::ref(serverState),
+                                 config.statsInterval);
+    }
+    // start the thread that writes the trace when asked to
+    std::thread trace_thread(traceThread, std::ref(serverState));
     uint32_t ex_trial = 0; // exception trial counter
     while (!is_exiting) { // while not exiting, wait for packets and handle them
       try {
         wait_for_udp_packet(serverState);
         ex_trial = 0; // reset the exception trial counter
       } catch (std::exception &e) {
-        std::cerr << "Encountered a fatal error while running the "
-                     "application. Retrying..."
-                  << std::endl
-                  << e.what() << std::endl;
+        serverState.warning << "Encountered a fatal error while running the "
+                               "application. Retrying..."
+                            << std::endl;
+        serverState.warning << e.what() << std::endl;
         ex_trial++;
       } catch (...) {
-        std::cerr << "Encountered a fatal error while running the "
-                     "application. Retrying..."
-                  << std::endl;
+        serverState.warning << "Encountered a fatal error while running the "
+                               "application. Retrying..."
+                            << std::endl;
         ex_trial++;
       }
       if (ex_trial >= EXCEPTION_RETRY_MAX_TRIALS) { // if max trials reached
-        std::cerr << "Max trials reached, shutting down..." << std::endl;
+        serverState.error << "Max trials reached, shutting down..."
+                          << std::endl;
         is_exiting = true; // set the exiting flag
       }
     }
 
-    std::cout << "Shutting down UDP server..." << std::endl;
+    serverState.info << "Shutting down UDP server..." << std::endl;
 
-    tcp_thread.join(); // wait for the TCP thread to finish
+    tcp_thread.join();      // wait for the TCP thread to finish
+    archiver_thread.join(); // wait for the archiver thread to finish
+    watcher_thread.join();  // wait for the watcher thread to finish
+    trace_thread.join();    // wait for the trace thread to finish
+    if (stats_thread.joinable()) {
+      stats_thread.join(); // wait for the last dump of the stats
+    }
 
   } catch (std::exception &e) {
     std::cerr << "Encountered a fatal error while running the "
@@ -78,11 +108,38 @@ ServerConfig::ServerConfig(int argc, char *argv[]) {
   programPath = argv[0];
   // -p -v -h are valid options, and : means that they need an argument
   int opt;
-  while ((opt = getopt(argc, argv, "-p:vh")) != -1) {
+  while ((opt = getopt(argc, argv, "-p:a:s:t:l:vh")) != -1) {
     switch (opt) {
     case 'p':
       port = std::string(optarg);
       break;
+    case 'a':
+      if (!is_digits(std::string(optarg)) || std::string(optarg).empty() ||
+          std::string(optarg).length() > 9) {
+        std::cerr << "Invalid archive delay: " << optarg << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      archiveAfter = (uint32_t)std::stoul(optarg);
+      break;
+    case 's':
+      if (!is_digits(std::string(optarg)) || std::string(optarg).empty() ||
+          std::string(optarg).length() > 9) {
+        std::cerr << "Invalid stats interval: " << optarg << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      statsInterval = (uint32_t)std::stoul(optarg);
+      break;
+    case 't':
+      if (!is_digits(std::string(optarg)) || std::string(optarg).empty() ||
+          std::string(optarg).length() > 9) {
+        std::cerr << "Invalid trace sampling: " << optarg << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      traceSampling = (uint32_t)std::stoul(optarg);
+      break;
+    case 'l':
+      parseLimits(optarg);
+      break;
     case 'h':
       help = true;
       return;
@@ -102,10 +159,62 @@ ServerConfig::ServerConfig(int argc, char *argv[]) {
   validate_port_number(port); // validate the port number
 }
 
+void ServerConfig::parseLimits(const std::string &limitsStr) {
+  std::stringstream stream(limitsStr);
+  std::string entry;
+  while (std::getline(stream, entry, ',')) {
+    size_t equals = entry.find('=');
+    std::string name = entry.substr(0, equals);
+    std::string value =
+        equals == std::string::npos ? "" : entry.substr(equals + 1);
+    if (!is_digits(value) || value.empty() || value.length() > 9) {
+      std::cerr << "Invalid admission limit: " << entry << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    uint32_t limit = (uint32_t)std::stoul(value);
+    if (name == "UDP") {
+      limits.udpRate = limit;
+    } else if (name == "TCP") {
+      limits.tcpRate = limit;
+    } else if (name == "CONN") {
+      limits.connectionsMax = limit;
+    } else if (name == "UPLOAD") {
+      limits.uploadRate = limit;
+    } else if (name == "WAT") {
+      limits.watchersMax = limit;
+    } else {
+      std::cerr << "Invalid admission limit: " << entry << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
 void ServerConfig::printHelp(std::ostream &stream) {
-  stream << "Usage: " << programPath << " [-p ASport] [-v]" << std::endl;
+  stream << "Usage: " << programPath
+         << " [-p ASport] [-a seconds] [-s seconds] [-t requests] [-l limits]"
+            " [-v]"
+         << std::endl;
   stream << "Available options:" << std::endl;
   stream << "  -p ASport: Set the port number to listen on" << std::endl;
+  stream << "  -a seconds: Archive auctions closed for this long (default "
+         << ARCHIVE_AFTER_SECONDS << ")" << std::endl;
+  stream << "  -s seconds: Write the request stats to " << STATS_FILE
+         << " this often, 0 to never (default " << STATS_DUMP_INTERVAL_SECONDS
+         << ")" << std::endl;
+  stream << "  -t requests: Trace 1 in this many requests, 0 to never (default "
+         << TRACE_SAMPLING_DEFAULT << "), kill -USR1 writes " << TRACE_FILE
+         << std::endl;
+  stream << "  -l limits: Set what every source other than the machine of the "
+            "AS can send, 0 for no limit (default UDP="
+         << ADMISSION_UDP_RATE << ",TCP=" << ADMISSION_TCP_RATE
+         << ",CONN=" << ADMISSION_CONNECTIONS_MAX
+         << ",UPLOAD=" << ADMISSION_UPLOAD_RATE
+         << ",WAT=" << ADMISSION_WATCHERS_MAX
+         << "), in UDP requests and TCP connections per second, TCP "
+            "connections open at once, bytes uploaded per second, and watch "
+            "requests held open at once"
+         << std::endl;
   stream << "  -v: Enable verbose logging" << std::endl;
 }
 
@@ -113,25 +222,165 @@ void setupDB() {
   create_new_directory(AS_DIR);      // create the AS directory
   create_new_directory(USER_DIR);    // create the user directory
   create_new_directory(AUCTION_DIR); // create the auction directory
+  create_new_directory(ARCHIVE_DIR); // create the archive directory
 
   std::string nextAuctionFile = AUCTION_DIR + SLASH + NEXT_AUCTION_FILE;
   create_new_file(AUCTION_DIR + SLASH + NEXT_AUCTION_FILE);
 
-  int count = 0; // count the number of auctions that exist
-  for (const auto &entry : std::filesystem::directory_iterator(AUCTION_DIR)) {
-    if (std::filesystem::is_directory(entry.path())) { // if it's a directory
-      count++;                                         // increment the count
+  // the ID after the highest that is taken, whether by an auction or by an
+  // archived one; the rest of the last reserved batch was never handed to a
+  // client, as an ID is only replied once its directory exists
+  uint32_t nextAuction = 1;
+  try {
+    for (const auto &entry : std::filesystem::directory_iterator(AUCTION_DIR)) {
+      std::string auctionID = entry.path().filename().string();
+      if (std::filesystem::is_directory(entry.path()) &&
+          validateAuctionID(auctionID) == 0) {
+        nextAuction =
+            std::max(nextAuction, (uint32_t)std::stoul(auctionID) + 1);
+      }
+    }
+    for (const auto &entry : std::filesystem::directory_iterator(ARCHIVE_DIR)) {
+      std::string auctionID = entry.path().stem().string();
+      if (entry.path().extension() != ARCHIVE_EXT) {
+        // leftover of an archive that was being written
+        delete_file(entry.path());
+      } else if (validateAuctionID(auctionID) == 0) {
+        nextAuction =
+            std::max(nextAuction, (uint32_t)std::stoul(auctionID) + 1);
+      }
+    }
+  } catch (std::filesystem::filesystem_error &e) {
+    // without a whole scan, the high-water mark of the reserved IDs is the
+    // only bound known to be past every ID handed out
+    std::string nextAuctionStr;
+    read_from_file(nextAuctionFile, nextAuctionStr);
+    nextAuctionStr = nextAuctionStr.substr(0, nextAuctionStr.find('\n'));
+    // AUCTION_ID_MAX + 1 once every ID is taken
+    if (!nextAuctionStr.empty() &&
+        nextAuctionStr.length() <= AUCTION_ID_LENGTH + 1 &&
+        is_digits(nextAuctionStr)) {
+      nextAuction = std::max(nextAuction, (uint32_t)std::stoul(nextAuctionStr));
     }
   }
-  count++; // increment the count for the next auction
 
-  std::string numAuctions = std::to_string(count) + "\n";
-  write_to_file(nextAuctionFile, numAuctions); // for the next auction id
+  std::string nextAuctionLine = std::to_string(nextAuction) + "\n";
+  write_to_file(nextAuctionFile, nextAuctionLine); // for the next auction id
 };
 
+void archiverThread(AuctionServerState &serverState, uint32_t archiveAfter) {
+  uint32_t elapsed = ARCHIVE_INTERVAL_SECONDS; // run a first pass right away
+  while (!is_exiting) {
+    if (elapsed < ARCHIVE_INTERVAL_SECONDS) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      elapsed++;
+      continue;
+    }
+    elapsed = 0;
+
+    try {
+      for (auto auctionID :
+           serverState.auctionManager.getArchivableAuctions(archiveAfter)) {
+        if (is_exiting) {
+          break;
+        }
+        // closed auctions no longer change, so they can be packed while
+        // requests are being handled
+        archiveAuction(auctionID);
+
+        std::unique_lock<std::shared_mutex> lock(serverState.archiveLock);
+        serverState.auctionManager.removeArchivedAuction(auctionID);
+        serverState.verbose << "[Archiver] Auction " << auctionID
+                            << " was archived" << std::endl;
+      }
+    } catch (std::exception &e) {
+      serverState.error << "Failed to archive auctions: " << e.what()
+                        << std::endl;
+    }
+  }
+
+  serverState.info << "Shutting down archiver..." << std::endl;
+}
+
+void watcherThread(AuctionServerState &serverState) {
+  while (!is_exiting) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    serverState.auctionManager.expireWatchers(std::time(nullptr));
+  }
+
+  // nothing happened to the watched auctions before shutting down
+  serverState.auctionManager.expireWatchers(
+      std::numeric_limits<time_t>::max());
+  serverState.info << "Shutting down watcher..." << std::endl;
+}
+
+void statsThread(AuctionServerState &serverState, uint32_t interval) {
+  uint32_t elapsed = 0;
+  while (!is_exiting) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (++elapsed < interval && !is_exiting) {
+      continue;
+    }
+    elapsed = 0;
+
+    try {
+      serverState.requestStats.dump(STATS_FILE);
+    } catch (std::exception &e) {
+      serverState.error << "Failed to write the request stats: " << e.what()
+                        << std::endl;
+    }
+  }
+
+  serverState.info << "Shutting down stats..." << std::endl;
+}
+
+/**
+ * @brief Gets the set of the signal that asks for the trace.
+ */
+static sigset_t traceSignalSet() {
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  return set;
+}
+
+void blockTraceSignal() {
+  sigset_t set = traceSignalSet();
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+
+void traceThread(AuctionServerState &serverState) {
+  sigset_t set = traceSignalSet();
+  struct timespec timeout = {1, 0}; // to notice the AS shutting down
+  while (!is_exiting) {
+    if (sigtimedwait(&set, NULL, &timeout) != SIGUSR1) {
+      continue;
+    }
+
+    try {
+      size_t spans = tracer.exportJson(TRACE_FILE);
+      serverState.info << "Wrote " << spans << " trace spans to "
+                       << TRACE_FILE << std::endl;
+    } catch (std::exception &e) {
+      serverState.error << "Failed to write the trace: " << e.what()
+                        << std::endl;
+    }
+  }
+
+  serverState.info << "Shutting down tracer..." << std::endl;
+}
+
+void raiseOpenFilesLimit() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
 void wait_for_udp_packet(AuctionServerState &serverState) {
   SocketAddress sourceAddr;       // the source address of the packet
-  std::stringstream stream;       // the stream to read the packet into
   char buffer[SOCKET_BUFFER_LEN]; // the buffer to read the packet into
 
   sourceAddr.size = sizeof(sourceAddr.addr); // set the size of the address
@@ -151,36 +400,42 @@ void wait_for_udp_packet(AuctionServerState &serverState) {
     throw FatalError("Failed to receive UDP message (recvfrom)", errno);
   }
 
+  // dropped before it is parsed, or even logged, since it may be a flood
+  Admission admission = serverState.admission.admitRequest(sourceAddr.addr);
+  if (admission != ADMITTED) {
+    serverState.requestStats.countRejected(admission, (size_t)n);
+    return;
+  }
+
   sourceAddr.socket =
       serverState.udpSocketFD; // set the socket of the source address
 
-  // convert the source address to a string
-  char addr_str[INET_ADDRSTRLEN + 1] = {0};
+  // the address is only formatted by the logger thread
+  serverState.info << "Receiving incoming UDP message from " << sourceAddr.addr
+                   << std::endl;
 
-  // inet_ntop converts the address from binary to text form (IPV4)
-  inet_ntop(AF_INET, &sourceAddr.addr.sin_addr, addr_str, INET_ADDRSTRLEN);
-
-  std::cout << "Receiving incoming UDP message from " << addr_str << ":"
-            << ntohs(sourceAddr.addr.sin_port) << std::endl;
-
-  // write the buffer into the stream
-  stream.write(buffer, n);
-
-  return handle_packet(serverState, stream, sourceAddr);
+  // the packet is parsed in place, straight from the buffer
+  return handle_packet(serverState, std::string_view(buffer, (size_t)n),
+                       sourceAddr);
 }
 
-void handle_packet(AuctionServerState &serverState, std::stringstream &buffer,
+void handle_packet(AuctionServerState &serverState, std::string_view buffer,
                    SocketAddress &sourceAddr) {
   try {
-    char _packetID[PACKET_ID_LEN + 1]; // the packet id
-    buffer >> _packetID;               // read the packet id from the stream
+    if (is_binary_packet(buffer)) { // replied to in the same encoding
+      sourceAddr.encoding = BINARY_ENCODING;
+      buffer = read_binary_frame(buffer, &sourceAddr.requestID);
+    }
 
-    if (!buffer.good()) { // if the stream is not good, throw an exception
-      std::cerr << "Received unknown packet ID" << std::endl;
+    if (buffer.length() <= PACKET_ID_LEN &&
+        sourceAddr.encoding == TEXT_ENCODING) { // too short to have an ID
+      serverState.warning << "Received unknown packet ID" << std::endl;
       throw InvalidPacketException();
     }
 
-    std::string packetID = std::string(_packetID); // convert to string
+    // the packet id, the handler parses the rest of the packet
+    uint32_t packetID = packPacketID(buffer);
+    buffer.remove_prefix(PACKET_ID_LEN);
 
     serverState.callUdpPacketHandler(packetID, buffer, sourceAddr);
 
@@ -189,15 +444,16 @@ void handle_packet(AuctionServerState &serverState, std::stringstream &buffer,
       ErrorUdpPacket error; // create an error packet
       // set the error message, and the source address, and send the packet
       send_packet(error, sourceAddr.socket, (struct sockaddr *)&sourceAddr.addr,
-                  sourceAddr.size);
+                  sourceAddr.size, sourceAddr.encoding, sourceAddr.requestID);
     } catch (std::exception &ex) {
-      std::cerr << "Failed to reply with ERR packet: " << ex.what()
-                << std::endl;
+      serverState.error << "Failed to reply with ERR packet: " << ex.what()
+                        << std::endl;
     }
   } catch (std::exception &e) {
-    std::cerr << "Failed to handle UDP packet: " << e.what() << std::endl;
+    serverState.error << "Failed to handle UDP packet: " << e.what()
+                      << std::endl;
   } catch (...) {
-    std::cerr << "Failed to handle UDP packet: unknown" << std::endl;
+    serverState.error << "Failed to handle UDP packet: unknown" << std::endl;
   }
 }
 
@@ -207,8 +463,9 @@ void tcpMainThread(AuctionServerState &serverState) {
 
   // We create a socket for the TCP server, and set the socket options
   if (listen(serverState.tcpSocketFD, TCP_MAX_CONNECTIONS) < 0) {
-    perror("Error while executing listen");
-    std::cerr << "TCP server is being shutdown..." << std::endl;
+    serverState.error << "Error while executing listen: " << strerror(errno)
+                      << std::endl;
+    serverState.error << "TCP server is being shutdown..." << std::endl;
     is_exiting = true;
     return;
   }
@@ -219,24 +476,24 @@ void tcpMainThread(AuctionServerState &serverState) {
       wait_for_tcp_packet(serverState, pool);
       ex_trial = 0;
     } catch (std::exception &e) {
-      std::cerr << "Encountered fatal error while running the "
-                   "application. Retrying..."
-                << std::endl
-                << e.what() << std::endl;
+      serverState.warning << "Encountered fatal error while running the "
+                             "application. Retrying..."
+                          << std::endl;
+      serverState.warning << e.what() << std::endl;
       ex_trial++;
     } catch (...) {
-      std::cerr << "Encountered fatal error while running the "
-                   "application. Retrying..."
-                << std::endl;
+      serverState.warning << "Encountered fatal error while running the "
+                             "application. Retrying..."
+                          << std::endl;
       ex_trial++;
     }
     if (ex_trial >= EXCEPTION_RETRY_MAX_TRIALS) { // if max trials reached
-      std::cerr << "Max attempts, shutting down..." << std::endl;
+      serverState.error << "Max attempts, shutting down..." << std::endl;
       is_exiting = true; // set the exiting flag
     }
   }
 
-  std::cout << "Shutting down TCP server..." << std::endl;
+  serverState.info << "Shutting down TCP server..." << std::endl;
 }
 
 void wait_for_tcp_packet(AuctionServerState &serverState, TcpWorkerPool &pool) {
@@ -257,27 +514,35 @@ void wait_for_tcp_packet(AuctionServerState &serverState, TcpWorkerPool &pool) {
     throw FatalError("[ERROR] Failed to accept a connection", errno);
   }
 
-  struct timeval read_timeout;                    // set the read timeout
-  read_timeout.tv_sec = TCP_READ_TIMEOUT_SECONDS; // set the timeout
-  read_timeout.tv_usec = 0;
-
-  // set the read timeout socket option for the connection
-  if (setsockopt(connection_fd, SOL_SOCKET, SO_RCVTIMEO, &read_timeout,
-                 sizeof(read_timeout)) < 0) {
-    throw FatalError("Failed to set TCP read timeout socket option", errno);
+  // closed before anything is read from it, so it never holds a worker
+  Admission admission = serverState.admission.admitConnection(sourceAddr.addr);
+  if (admission != ADMITTED) {
+    close(connection_fd);
+    serverState.requestStats.countRejected(admission);
+    serverState.verbose << "Rejected a TCP connection from "
+                        << sourceAddr.addr << std::endl;
+    return;
   }
 
-  char addr_str[INET_ADDRSTRLEN + 1] = {0}; // convert the address to string
-
-  // inet_ntop converts the address from binary to text form (IPV4)
-  inet_ntop(AF_INET, &sourceAddr.addr.sin_addr, addr_str, INET_ADDRSTRLEN);
-  std::cout << "Receiving incoming TCP connection from " << addr_str << ":"
-            << ntohs(sourceAddr.addr.sin_port) << std::endl;
+  // the address is only formatted by the logger thread
+  serverState.info << "Receiving incoming TCP connection from "
+                   << sourceAddr.addr << std::endl;
 
   try {
-    pool.giveConnection(connection_fd); // give the connection to a worker
+    // give the connection to a worker, which releases it once closed
+    pool.giveConnection(connection_fd, sourceAddr.addr);
+  } catch (AllWorkersBusyException &e) {
+    // the workers are set free by the deadlines of their requests, so the AS
+    // keeps accepting connections meanwhile
+    close(connection_fd);
+    serverState.admission.releaseConnection(sourceAddr.addr, 0);
+    serverState.requestStats.countRejected(WORKERS_BUSY);
+    serverState.verbose << "Rejected a TCP connection from "
+                        << sourceAddr.addr << ", as every worker is busy"
+                        << std::endl;
   } catch (std::exception &e) {
     close(connection_fd);
+    serverState.admission.releaseConnection(sourceAddr.addr, 0);
     throw FatalError(std::string("Failed to give connection to worker: ") +
                      e.what() + "\nClosing connection.");
   }
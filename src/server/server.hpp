@@ -16,8 +16,13 @@ public:
   std::string port = DEFAULT_PORT;
   bool help = false;
   bool verbose = false;
+  uint32_t archiveAfter = ARCHIVE_AFTER_SECONDS;
+  uint32_t statsInterval = STATS_DUMP_INTERVAL_SECONDS; // 0 to never dump
+  uint32_t traceSampling = TRACE_SAMPLING_DEFAULT;      // 0 to never trace
+  AdmissionLimits limits; // of every source
 
   ServerConfig(int argc, char *argv[]);
+  void parseLimits(const std::string &limitsStr);
   void printHelp(std::ostream &stream);
 };
 
@@ -41,11 +46,11 @@ void tcpMainThread(AuctionServerState &serverState);
  * @brief Handles an UDP packet.
  *
  * @param serverState The server state.
- * @param buffer The buffer containing the packet.
+ * @param buffer The bytes of the packet, as received.
  * @param source_addr The source address of the packet.
  *
  */
-void handle_packet(AuctionServerState &serverState, std::stringstream &buffer,
+void handle_packet(AuctionServerState &serverState, std::string_view buffer,
                    SocketAddress &source_addr);
 
 /**
@@ -56,6 +61,50 @@ void handle_packet(AuctionServerState &serverState, std::stringstream &buffer,
  */
 void wait_for_tcp_packet(AuctionServerState &serverState, TcpWorkerPool &pool);
 
+/**
+ * @brief Periodically archives the auctions closed for long enough.
+ *
+ * @param serverState The server state.
+ * @param archiveAfter The seconds an auction must have been closed for.
+ */
+void archiverThread(AuctionServerState &serverState, uint32_t archiveAfter);
+
+/**
+ * @brief Answers the watch requests whose timeout expired, every second.
+ *
+ * @param serverState The server state.
+ */
+void watcherThread(AuctionServerState &serverState);
+
+/**
+ * @brief Periodically writes the latencies and counters of every request to
+ * the stats file, and once more when shutting down.
+ *
+ * @param serverState The server state.
+ * @param interval The seconds between two dumps.
+ */
+void statsThread(AuctionServerState &serverState, uint32_t interval);
+
+/**
+ * @brief Blocks the signal that asks for the trace in the calling thread, and
+ * in the threads it starts afterwards, so only the trace thread takes it.
+ */
+void blockTraceSignal();
+
+/**
+ * @brief Writes the spans of the traced requests to the trace file, every
+ * time the AS receives SIGUSR1.
+ *
+ * @param serverState The server state.
+ */
+void traceThread(AuctionServerState &serverState);
+
+/**
+ * @brief Raises the limit of open files to the hard limit, since every watch
+ * request holds its connection open.
+ */
+void raiseOpenFilesLimit();
+
 /**
  * @brief Creates all the main directories and files of the AS Database.
  *
@@ -1,14 +1,35 @@
 #include "server_auction.hpp"
+#include "../utils/io_counters.hpp"
 #include "../utils/protocol.hpp"
+#include "../utils/tracer.hpp"
+#include "watch_registry.hpp"
 
-// to lock the next auction ID counter file
+#include <limits>
+
+// next auction ID to hand out, and the first ID that is not reserved in the
+// next auction ID file yet
+std::atomic<uint32_t> nextAuctionID{0};
+std::atomic<uint32_t> reservedAuctionID{0};
+std::once_flag auctionCounterLoaded;
+
+// to lock the next auction ID counter file, only when reserving a new batch
 std::mutex fileMutex;
 
+// largest bids of every auction, for bid checks and show record requests
+TopBidsTable topBids;
+
+// reply to list auctions requests, patched when auctions are closed
+ListingCache listingCache;
+
+// watch requests waiting for an auction to receive a bid or close
+WatchRegistry watchRegistry;
+
 uint32_t AuctionManager::openAuction(std::string userID,
                                      std::string auctionName,
                                      uint32_t startValue, uint32_t timeActive,
                                      std::string assetFilename,
                                      std::string assetFilePath) {
+  TraceSpan traceSpan("AuctionManager::openAuction", userID);
   try {
     std::string auctionID = getNextAuctionID();
 
@@ -37,6 +58,11 @@ uint32_t AuctionManager::openAuction(std::string userID,
         assetFilePath.substr(0, assetFilePath.find_first_of(SLASH));
     delete_directory(assetFilenamePathSubstr);
 
+    UserManager userManager;
+    userManager.addOwnedAuction(userID);
+
+    listingCache.markOpened(auctionID);
+
     return (uint32_t)std::stoi(auctionID);
 
   } catch (AuctionsLimitExceededException &e) {
@@ -50,36 +76,56 @@ uint32_t AuctionManager::openAuction(std::string userID,
   return (uint32_t)INVALID;
 }
 
-std::string AuctionManager::getNextAuctionID() {
-  try {
-    std::string nextAuctionID;
-    std::string nextAuctionPath = AUCTION_DIR + SLASH + NEXT_AUCTION_FILE;
-    // lock
-    std::lock_guard<std::mutex> lock(fileMutex);
+void AuctionManager::loadAuctionCounter() {
+  std::string nextAuctionIDStr;
+  std::string nextAuctionPath = AUCTION_DIR + SLASH + NEXT_AUCTION_FILE;
+  read_from_file(nextAuctionPath, nextAuctionIDStr);
 
-    read_from_file(nextAuctionPath, nextAuctionID);
+  uint32_t auctionID = (uint32_t)std::stoi(nextAuctionIDStr);
+  nextAuctionID = auctionID;
+  reservedAuctionID = auctionID;
+}
 
-    if (nextAuctionID.length() > AUCTION_ID_LENGTH) {
-      // unlock
-      fileMutex.unlock();
-      throw AuctionsLimitExceededException();
-    }
+void AuctionManager::reserveAuctionIDs(uint32_t auctionID) {
+  std::lock_guard<std::mutex> lock(fileMutex);
 
-    // Update next auction ID
-    int nextAuctionID_int = std::stoi(nextAuctionID);
-    nextAuctionID = intToStringWithZeros(nextAuctionID_int, AUCTION_ID_LENGTH);
-    nextAuctionID_int++;
-    write_to_file(nextAuctionPath, std::to_string(nextAuctionID_int));
+  // another thread may have reserved it while we waited for the lock
+  uint32_t reserved = reservedAuctionID.load();
+  if (auctionID < reserved) {
+    return;
+  }
 
-    // unlock
-    fileMutex.unlock();
+  while (reserved <= auctionID) {
+    reserved += AUCTION_ID_BATCH;
+  }
+  reserved = std::min(reserved, (uint32_t)AUCTION_ID_MAX + 1);
 
-    return nextAuctionID;
-  } catch (std::exception &e) {
-    // Unlock the mutex in case of an exception
-    fileMutex.unlock();
-    throw;
+  // persist the high-water mark before handing out any ID of the batch
+  std::string nextAuctionPath = AUCTION_DIR + SLASH + NEXT_AUCTION_FILE;
+  write_to_file(nextAuctionPath, std::to_string(reserved));
+  reservedAuctionID = reserved;
+}
+
+std::string AuctionManager::getNextAuctionID() {
+  TraceSpan traceSpan("AuctionManager::getNextAuctionID");
+  std::call_once(auctionCounterLoaded, loadAuctionCounter);
+
+  uint32_t auctionID = nextAuctionID.fetch_add(1);
+  if (auctionID > AUCTION_ID_MAX) {
+    throw AuctionsLimitExceededException();
+  }
+
+  if (auctionID >= reservedAuctionID.load()) {
+    reserveAuctionIDs(auctionID);
   }
+
+  return intToStringWithZeros((int)auctionID, AUCTION_ID_LENGTH);
+}
+
+uint32_t AuctionManager::getAuctionCount() {
+  std::call_once(auctionCounterLoaded, loadAuctionCounter);
+
+  return std::min(nextAuctionID.load() - 1, (uint32_t)AUCTION_ID_MAX);
 }
 
 void validateOpenAuctionArgs(std::string userID, std::string password,
@@ -99,66 +145,149 @@ void validateOpenAuctionArgs(std::string userID, std::string password,
 }
 
 std::vector<std::pair<std::string, uint8_t>> AuctionManager::listAuctions() {
+  TraceSpan traceSpan("AuctionManager::listAuctions");
+  std::vector<std::pair<std::string, uint8_t>> auctions =
+      listAuctionsPage(LIST_CURSOR_START, AUCTION_ID_MAX, nullptr);
+
+  // no auctions in DB, or only auctions that are still being opened
+  if (auctions.empty()) {
+    throw NoAuctionsException();
+  }
+  return auctions;
+}
+
+std::vector<std::pair<std::string, uint8_t>> AuctionManager::listAuctionsPage(
+    const std::string &cursor, uint32_t limit,
+    const std::function<bool(const std::string &)> &filter) {
+  TraceSpan traceSpan("AuctionManager::listAuctionsPage", cursor);
   std::vector<std::pair<std::string, uint8_t>> auctions;
   if (directory_exists(AUCTION_DIR) == INVALID) {
     throw std::exception();
   }
 
-  std::string nextAuctionID;
-  std::string next_auction_path = AUCTION_DIR + SLASH + NEXT_AUCTION_FILE;
-
   // get number of auctions in DB
-  read_from_file(next_auction_path, nextAuctionID);
-  int numAuctions = std::stoi(nextAuctionID) - 1;
-
-  // no auctions in DB
-  if (numAuctions == 0) {
-    throw NoAuctionsException();
-  }
-
-  // get all auctions
-  for (int i = 1; i <= numAuctions; i++) {
-    std::string auction_dir =
-        AUCTION_DIR + SLASH + intToStringWithZeros(i, AUCTION_ID_LENGTH);
-    std::string auction_end_file = auction_dir + SLASH + END_FILE +
-                                   intToStringWithZeros(i, AUCTION_ID_LENGTH) +
-                                   TXT_EXT;
-
-    // if auction directory does not exist - auction count was compromissed
+  uint32_t numAuctions = getAuctionCount();
+
+  // get the auctions after the cursor, until the page is full
+  for (uint32_t i = (uint32_t)std::stoi(cursor) + 1;
+       i <= numAuctions && auctions.size() < limit; i++) {
+    std::string auctionID = intToStringWithZeros((int)i, AUCTION_ID_LENGTH);
+    std::string auction_dir = AUCTION_DIR + SLASH + auctionID;
+    std::string auction_end_file =
+        auction_dir + SLASH + END_FILE + auctionID + TXT_EXT;
+
+    // if auction directory does not exist - auction was archived, or is still
+    // being opened
     if (directory_exists(auction_dir) == INVALID) {
-      throw std::exception();
+      if (isAuctionArchived(auctionID) == VALID &&
+          (!filter || filter(auctionID))) {
+        auctions.push_back(std::make_pair(auctionID, 0));
+      }
+      continue;
+    }
+
+    if (filter && !filter(auctionID)) {
+      continue;
     }
 
     // auction still active - no end file
     if (file_exists(auction_end_file) == INVALID) {
-      if (checkAuctionValidity(intToStringWithZeros(i, AUCTION_ID_LENGTH)) ==
-          INVALID) {
+      if (checkAuctionValidity(auctionID) == INVALID) {
         try {
-          createCloseAuctionFile(intToStringWithZeros(i, AUCTION_ID_LENGTH),
-                                 false);
+          createCloseAuctionFile(auctionID, false);
         } catch (NonActiveAuctionException &e) {
           // if auction was closed by another user, ignore it
         }
-        auctions.push_back(
-            std::make_pair(intToStringWithZeros(i, AUCTION_ID_LENGTH), 0));
+        auctions.push_back(std::make_pair(auctionID, 0));
       } else {
-        auctions.push_back(
-            std::make_pair(intToStringWithZeros(i, AUCTION_ID_LENGTH), 1));
+        auctions.push_back(std::make_pair(auctionID, 1));
       }
     }
     // auction ended
     else {
-      auctions.push_back(
-          std::make_pair(intToStringWithZeros(i, AUCTION_ID_LENGTH), 0));
+      auctions.push_back(std::make_pair(auctionID, 0));
     }
   }
+
   return auctions;
 }
 
+std::string AuctionManager::getNextCursor(
+    const std::vector<std::pair<std::string, uint8_t>> &page, uint32_t limit) {
+  // a page that is not full was the last one
+  if (page.size() < limit ||
+      (uint32_t)std::stoi(page.back().first) >= getAuctionCount()) {
+    return LIST_CURSOR_START;
+  }
+  return page.back().first;
+}
+
+void AuctionManager::serializeAuctionList(PacketBuffer &buffer) {
+  TraceSpan traceSpan("AuctionManager::serializeAuctionList");
+  if (listingCache.copyTo(buffer)) {
+    return;
+  }
+
+  // read before listing, so closures while listing are not missed
+  uint64_t version = listingCache.getVersion();
+
+  ListAuctionsResponse response;
+  time_t expiresAt = std::numeric_limits<time_t>::max();
+  try {
+    response.auctions = listAuctions();
+    response.status = ListAuctionsResponse::OK;
+
+    for (const auto &auction : response.auctions) {
+      if (auction.second == 1) { // active, so its START file is still there
+        std::vector<std::string> words =
+            splitOnSeparator(getAuctionInfo(auction.first), ' ');
+        time_t endTime =
+            std::stol(words[words.size() - 1]) + std::stol(words[4]);
+        expiresAt = std::min(expiresAt, endTime);
+      }
+    }
+  } catch (NoAuctionsException &e) {
+    response.status = ListAuctionsResponse::NOK;
+  }
+
+  size_t start = buffer.view().length();
+  response.serialize(buffer);
+  listingCache.store(version, buffer.view().substr(start), response.auctions,
+                     expiresAt);
+}
+
+std::vector<std::pair<std::string, uint8_t>>
+AuctionManager::getAuctionListChanges(uint64_t since, uint64_t &version) {
+  TraceSpan traceSpan("AuctionManager::getAuctionListChanges");
+  if (getAuctionCount() == 0) {
+    throw NoAuctionsException();
+  }
+
+  std::vector<std::pair<std::string, uint8_t>> changes;
+  for (int i = 0; i < EXCEPTION_RETRY_MAX_TRIALS; i++) {
+    version = listingCache.getChanges(since, changes);
+    if (version != 0) {
+      return changes;
+    }
+    // build the reply again, which also closes the auctions that expired
+    serializeAuctionList(PacketBuffer::forThread());
+  }
+
+  // the catalog keeps changing, every auction is a superset of the changes
+  version = listingCache.getVersion();
+  return listAuctions();
+}
+
 std::vector<std::pair<std::string, uint8_t>>
 AuctionManager::listUserAuctions(std::string userID) {
+  TraceSpan traceSpan("AuctionManager::listUserAuctions", userID);
   std::vector<std::pair<std::string, uint8_t>> userAuctions;
   try {
+    UserManager userManager;
+    if (userManager.getOwnedAuctionCount(userID) == 0) { // no need to search
+      throw NoAuctionsException();
+    }
+
     std::vector<std::pair<std::string, uint8_t>> auctions = listAuctions();
 
     for (auto auction : auctions) {
@@ -182,11 +311,26 @@ AuctionManager::listUserAuctions(std::string userID) {
   }
 }
 
+std::vector<std::pair<std::string, uint8_t>>
+AuctionManager::listUserAuctionsPage(std::string userID,
+                                     const std::string &cursor,
+                                     uint32_t limit) {
+  TraceSpan traceSpan("AuctionManager::listUserAuctionsPage", userID);
+  return listAuctionsPage(cursor, limit, [&](const std::string &auctionID) {
+    return getAuctionOwner(auctionID) == userID;
+  });
+}
+
 std::string AuctionManager::getAuctionInfo(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionInfo", auctionID);
   try {
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
     std::string start = auctionPath + SLASH + START_FILE + auctionID + TXT_EXT;
     std::string auctionInfo;
+    if (file_exists(start) == INVALID &&
+        isAuctionArchived(auctionID) == VALID) {
+      return readArchiveSection(auctionID, ARCHIVE_START);
+    }
     read_from_file(start, auctionInfo);
     return auctionInfo;
   } catch (std::exception &e) {
@@ -194,7 +338,58 @@ std::string AuctionManager::getAuctionInfo(std::string auctionID) {
   }
 }
 
+bool AuctionManager::watchAuction(std::string auctionID, int fd,
+                                  uint32_t timeout,
+                                  std::function<void()> released) {
+  TraceSpan traceSpan("AuctionManager::watchAuction", auctionID);
+  if (validateAuctionID(auctionID) == INVALID || timeout == 0 ||
+      timeout > WATCH_TIMEOUT_MAX) {
+    throw InvalidPacketException();
+  }
+
+  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+  if (directory_exists(auctionPath) == INVALID) {
+    if (isAuctionArchived(auctionID) == INVALID) {
+      throw AuctionNotFoundException();
+    }
+    return false; // archived auctions were closed long ago
+  }
+
+  std::string end = auctionPath + SLASH + END_FILE + auctionID + TXT_EXT;
+  if (file_exists(end) != INVALID) {
+    return false;
+  }
+
+  std::vector<std::string> words =
+      splitOnSeparator(getAuctionInfo(auctionID), ' ');
+  time_t closesAt = (time_t)std::stoi(words[words.size() - 1]) +
+                    (time_t)std::stoi(words[4]);
+  time_t deadline = std::time(nullptr) + (time_t)timeout;
+  if (!watchRegistry.add(auctionID, fd, std::min(deadline, closesAt),
+                         closesAt <= deadline, std::move(released))) {
+    throw WatchersLimitExceededException();
+  }
+
+  // closed meanwhile, without the watcher being notified
+  if (checkAuctionValidity(auctionID) == INVALID) {
+    try {
+      createCloseAuctionFile(auctionID, false);
+    } catch (NonActiveAuctionException &e) {
+      // already closed by another request
+    }
+  }
+  if (file_exists(end) != INVALID) {
+    WatchResponse closed;
+    closed.status = WatchResponse::CLS;
+    watchRegistry.notify(auctionID, closed);
+  }
+  return true;
+}
+
+void AuctionManager::expireWatchers(time_t now) { watchRegistry.expire(now); }
+
 int8_t AuctionManager::checkAuctionValidity(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::checkAuctionValidity", auctionID);
   try {
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
     std::string auctionInfo = getAuctionInfo(auctionID);
@@ -218,6 +413,7 @@ int8_t AuctionManager::checkAuctionValidity(std::string auctionID) {
 
 std::vector<std::string>
 AuctionManager::getAuctionBidders(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionBidders", auctionID);
   try {
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
     std::string auctionBidsPath = auctionPath + BID_DIR;
@@ -225,9 +421,21 @@ AuctionManager::getAuctionBidders(std::string auctionID) {
     // iterate over all files in BIDS directory
     std::vector<std::string> auctionsBidders;
 
+    if (directory_exists(auctionPath) == INVALID &&
+        isAuctionArchived(auctionID) == VALID) {
+      for (auto bid : getArchivedAuctionBids(auctionID, UINT32_MAX)) {
+        auctionsBidders.push_back(std::get<0>(bid));
+      }
+      if (auctionsBidders.size() == 0) {
+        throw NoOngoingBidsException();
+      }
+      return auctionsBidders;
+    }
+
     int i = 0;
     for (const auto &entry :
          std::filesystem::directory_iterator(auctionBidsPath)) {
+      threadIO.dirEntries++;
       if (entry.is_regular_file() && entry.path().extension() == TXT_EXT) {
 
         std::string auctionBidFile = entry.path();
@@ -252,6 +460,7 @@ AuctionManager::getAuctionBidders(std::string auctionID) {
 // my bids
 std::vector<std::pair<std::string, uint8_t>>
 AuctionManager::getAuctionsBiddedByUser(std::string userID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionsBiddedByUser", userID);
 
   std::vector<std::pair<std::string, uint8_t>> auctions;
   std::vector<std::pair<std::string, uint8_t>> auctionsBiddedByUser;
@@ -289,12 +498,26 @@ AuctionManager::getAuctionsBiddedByUser(std::string userID) {
   }
 }
 
+std::vector<std::pair<std::string, uint8_t>>
+AuctionManager::getAuctionsBiddedByUserPage(std::string userID,
+                                            const std::string &cursor,
+                                            uint32_t limit) {
+  TraceSpan traceSpan("AuctionManager::getAuctionsBiddedByUserPage", userID);
+  return listAuctionsPage(cursor, limit, [&](const std::string &auctionID) {
+    try {
+      std::vector<std::string> bidders = getAuctionBidders(auctionID);
+      return std::find(bidders.begin(), bidders.end(), userID) !=
+             bidders.end();
+    } catch (NoOngoingBidsException &e) {
+      return false;
+    }
+  });
+}
+
 std::string AuctionManager::getAuctionOwner(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionOwner", auctionID);
   try {
-    std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
-    std::string start = auctionPath + SLASH + START_FILE + auctionID + TXT_EXT;
-    std::string auctionInfo;
-    read_from_file(start, auctionInfo);
+    std::string auctionInfo = getAuctionInfo(auctionID);
     std::string auctionOwner = auctionInfo.substr(0, auctionInfo.find(" "));
     return auctionOwner;
   } catch (std::exception &e) {
@@ -304,6 +527,7 @@ std::string AuctionManager::getAuctionOwner(std::string auctionID) {
 
 void AuctionManager::createCloseAuctionFile(std::string auctionID,
                                             bool earlyClosure) {
+  TraceSpan traceSpan("AuctionManager::createCloseAuctionFile", auctionID);
   try {
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
     std::string end = auctionPath + SLASH + END_FILE + auctionID + TXT_EXT;
@@ -340,6 +564,12 @@ void AuctionManager::createCloseAuctionFile(std::string auctionID,
       write_to_file(end, end_datetime + " " + timeActive);
     }
 
+    listingCache.markClosed(auctionID);
+
+    WatchResponse closed;
+    closed.status = WatchResponse::CLS;
+    watchRegistry.notify(auctionID, closed);
+
   } catch (std::exception &e) {
     throw;
   }
@@ -347,6 +577,7 @@ void AuctionManager::createCloseAuctionFile(std::string auctionID,
 
 void AuctionManager::closeAuction(std::string userID, std::string password,
                                   std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::closeAuction", auctionID);
   try {
     UserManager userManager;
 
@@ -356,8 +587,8 @@ void AuctionManager::closeAuction(std::string userID, std::string password,
       throw InvalidPacketException();
     }
 
-    if (userManager.userExists(userID) == INVALID ||
-        userManager.getUserPassword(userID) != password) {
+    // unregistered users have no password, so one lookup covers both checks
+    if (userManager.getUserPassword(userID) != password) {
       throw InvalidCredentialsException();
     }
 
@@ -366,14 +597,22 @@ void AuctionManager::closeAuction(std::string userID, std::string password,
     }
 
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+    bool archived = false;
     if (directory_exists(auctionPath) == INVALID) {
-      throw AuctionNotFoundException();
+      if (isAuctionArchived(auctionID) == INVALID) {
+        throw AuctionNotFoundException();
+      }
+      archived = true;
     }
 
     if (getAuctionOwner(auctionID) != userID) {
       throw IncorrectAuctionOwnerException();
     }
 
+    if (archived) { // archived auctions were closed long ago
+      throw NonActiveAuctionException();
+    }
+
     // check if auction has already expired
     if (checkAuctionValidity(auctionID) == INVALID) {
       createCloseAuctionFile(auctionID, false);
@@ -391,41 +630,22 @@ void AuctionManager::closeAuction(std::string userID, std::string password,
 }
 
 uint32_t AuctionManager::getLargestBid(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getLargestBid", auctionID);
+  uint32_t largestBid = topBids.getLargestBid(auctionID);
 
-  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
-  std::string auctionBidsPath = auctionPath + BID_DIR;
-  std::string max_filename;
-  uintmax_t max = 0;
-
-  for (const auto &entry : fs::directory_iterator(auctionBidsPath)) {
-    if (entry.is_regular_file() && entry.path().extension() == TXT_EXT) {
-      std::string filename = entry.path().stem().string();
-      try {
-        uintmax_t curr = std::stoull(filename);
-        if (curr > max) {
-          max = curr;
-          max_filename = entry.path().string();
-        }
-      } catch (const std::invalid_argument &) {
-        // ignore, filename that is not composed by digits
-      }
-    }
-  }
   // no bids yet
-  if (max_filename.empty()) {
+  if (largestBid == 0) {
     std::string auctionInfo = getAuctionInfo(auctionID);
     std::vector<std::string> words = splitOnSeparator(auctionInfo, ' ');
     return (uint32_t)std::stoi(words[3]);
   }
 
-  std::string bidValue = max_filename.substr(0, max_filename.find_last_of("."));
-  bidValue = bidValue.substr(bidValue.find_last_of(SLASH) + 1);
-
-  return (uint32_t)std::stoi(bidValue);
+  return largestBid;
 }
 
 void AuctionManager::bidOnAuction(std::string userID, std::string password,
                                   std::string auctionID, uint32_t bidValue) {
+  TraceSpan traceSpan("AuctionManager::bidOnAuction", auctionID);
   try {
     UserManager userManager;
 
@@ -436,8 +656,8 @@ void AuctionManager::bidOnAuction(std::string userID, std::string password,
       throw InvalidPacketException();
     }
 
-    if (userManager.userExists(userID) == INVALID ||
-        userManager.getUserPassword(userID) != password) {
+    // unregistered users have no password, so one lookup covers both checks
+    if (userManager.getUserPassword(userID) != password) {
       throw InvalidCredentialsException();
     }
 
@@ -447,7 +667,10 @@ void AuctionManager::bidOnAuction(std::string userID, std::string password,
 
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
     std::string end = auctionPath + SLASH + END_FILE + auctionID + TXT_EXT;
-    if (file_exists(end) != INVALID) { // auction is closed
+    if (file_exists(end) != INVALID ||
+        isAuctionArchived(auctionID) == VALID) { // auction is closed
+      throw NonActiveAuctionException();
+    } else if (directory_exists(auctionPath) == INVALID) { // no such auction
       throw NonActiveAuctionException();
     } else if (checkAuctionValidity(auctionID) == INVALID) {
       try {
@@ -462,27 +685,39 @@ void AuctionManager::bidOnAuction(std::string userID, std::string password,
       throw IllegalBidException();
     }
 
-    if (bidValue <= getLargestBid(auctionID)) { // bid value is too low
-      throw BidRefusedException();
-    }
+    std::string bidDateTime = getCurrentTimeFormated();
+    std::string bidTimeSeconds = std::to_string(std::time(nullptr));
+
+    std::string auctionInfo = getAuctionInfo(auctionID);
+    std::vector<std::string> words = splitOnSeparator(auctionInfo, ' ');
+    uint32_t startValue = (uint32_t)std::stoi(words[3]);
+    std::string startTimeSeconds = auctionInfo.substr(
+        auctionInfo.find_last_of(" ") + 1, auctionInfo.length());
+    std::string bidSecTime =
+        getTimeDifferenceStr(startTimeSeconds, bidTimeSeconds);
 
     std::string auctionBidsPath = auctionPath + BID_DIR;
     std::string bidPath =
         auctionBidsPath +
         intToStringWithZeros((int)bidValue, BID_VALLUE_LENGTH) + TXT_EXT;
-    create_new_file(bidPath);
 
-    std::string bidDateTime = getCurrentTimeFormated();
-    std::string bidTimeSeconds = std::to_string(std::time(nullptr));
+    std::tuple<std::string, uint32_t, std::string, uint32_t> bid =
+        std::make_tuple(userID, bidValue, bidDateTime,
+                        (uint32_t)std::stoi(bidSecTime));
+    bool placed = topBids.placeBid(auctionID, bid, startValue, [&]() {
+      create_new_file(bidPath);
+      write_to_file(bidPath, userID + " " + std::to_string(bidValue) + " " +
+                                 bidDateTime + " " + bidSecTime);
+    });
 
-    std::string auctionInfo = getAuctionInfo(auctionID);
-    std::string startTimeSeconds = auctionInfo.substr(
-        auctionInfo.find_last_of(" ") + 1, auctionInfo.length());
+    if (!placed) { // bid value is too low
+      throw BidRefusedException();
+    }
 
-    write_to_file(bidPath,
-                  userID + " " + std::to_string(bidValue) + " " + bidDateTime +
-                      " " +
-                      getTimeDifferenceStr(startTimeSeconds, bidTimeSeconds));
+    WatchResponse newBid;
+    newBid.status = WatchResponse::BID;
+    newBid.bidValue = bidValue;
+    watchRegistry.notify(auctionID, newBid);
 
     return;
   } catch (std::exception &e) {
@@ -490,8 +725,9 @@ void AuctionManager::bidOnAuction(std::string userID, std::string password,
   }
 }
 
-std::tuple<std::string, uint32_t, std::string>
+std::tuple<std::string, uint32_t, std::string, uint32_t>
 AuctionManager::getAuctionAsset(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionAsset", auctionID);
   try {
     if (validateAuctionID(auctionID) == INVALID) { // check auctionID
       throw InvalidPacketException();
@@ -500,7 +736,17 @@ AuctionManager::getAuctionAsset(std::string auctionID) {
     std::string auctionPath = AUCTION_DIR;
     auctionPath += SLASH + auctionID;
     if (directory_exists(auctionPath) == INVALID) { // check auction exists
-      throw AuctionNotFoundException();
+      if (isAuctionArchived(auctionID) == INVALID) {
+        throw AuctionNotFoundException();
+      }
+
+      // served straight from its section of the archive
+      std::string auctionInfo = readArchiveSection(auctionID, ARCHIVE_START);
+      std::pair<uint32_t, uint32_t> asset =
+          getArchiveSectionRange(auctionID, ARCHIVE_ASSET);
+      return std::make_tuple(splitOnSeparator(auctionInfo, ' ')[2],
+                             asset.second, getArchivePath(auctionID),
+                             asset.first);
     }
 
     if (checkAuctionValidity(auctionID) == INVALID) { // check auction validity
@@ -525,7 +771,7 @@ AuctionManager::getAuctionAsset(std::string auctionID) {
     }
 
     uint32_t assetSize = getFileSize(assetPath);
-    return std::make_tuple(assetFilename, assetSize, assetPath);
+    return std::make_tuple(assetFilename, assetSize, assetPath, (uint32_t)0);
   } catch (std::exception &e) {
     throw;
   }
@@ -536,17 +782,23 @@ std::tuple<
     std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>,
     std::pair<std::string, uint32_t>>
 AuctionManager::getAuctionRecord(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::getAuctionRecord", auctionID);
   try {
     if (validateAuctionID(auctionID) == INVALID) { // check auctionID
       throw InvalidPacketException();
     }
 
     std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+    bool archived = false;
     if (directory_exists(auctionPath) == INVALID) { // check auction exists
-      throw AuctionNotFoundException();
+      if (isAuctionArchived(auctionID) == INVALID) {
+        throw AuctionNotFoundException();
+      }
+      archived = true;
     }
 
-    if (checkAuctionValidity(auctionID) == INVALID) { // check auction validity
+    if (!archived &&
+        checkAuctionValidity(auctionID) == INVALID) { // check auction validity
       try {
         createCloseAuctionFile(auctionID, false);
       } catch (NonActiveAuctionException &e) {
@@ -564,13 +816,14 @@ AuctionManager::getAuctionRecord(std::string auctionID) {
     std::string start_datetime = words[5] + " " + words[6];
     uint32_t timeActive = (uint32_t)std::stoi(words[4]);
 
+    // top 50 bids, sorted by bidValue
     std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
-        auctionBids = getAuctionBids(auctionID);
-
-    std::pair<std::string, uint32_t> auctionEnd = getAuctionEndInfo(auctionID);
+        auctionBids = archived ? getArchivedAuctionBids(auctionID, TOP_BIDS_MAX)
+                               : topBids.getTopBids(auctionID);
 
-    sortAuctionBids(auctionBids);   // sort by bidValue
-    getTopNumBids(auctionBids, 50); // get top 50 bids
+    std::pair<std::string, uint32_t> auctionEnd =
+        archived ? getArchivedAuctionEnd(auctionID)
+                 : getAuctionEndInfo(auctionID);
 
     return std::make_tuple(auctionOwner, auctionName, assetFilename, startValue,
                            start_datetime, timeActive, auctionBids, auctionEnd);
@@ -578,3 +831,104 @@ AuctionManager::getAuctionRecord(std::string auctionID) {
     throw;
   }
 }
+
+std::tuple<
+    uint64_t,
+    std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>,
+    std::pair<std::string, uint32_t>>
+AuctionManager::getAuctionRecordChanges(std::string auctionID,
+                                        uint64_t since) {
+  TraceSpan traceSpan("AuctionManager::getAuctionRecordChanges", auctionID);
+  if (validateAuctionID(auctionID) == INVALID) { // check auctionID
+    throw InvalidPacketException();
+  }
+
+  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+  bool archived = false;
+  if (directory_exists(auctionPath) == INVALID) { // check auction exists
+    if (isAuctionArchived(auctionID) == INVALID) {
+      throw AuctionNotFoundException();
+    }
+    archived = true;
+  }
+
+  if (!archived && checkAuctionValidity(auctionID) == INVALID) {
+    try {
+      createCloseAuctionFile(auctionID, false);
+    } catch (NonActiveAuctionException &e) {
+      // if auction was closed, ignore it
+    }
+  }
+
+  uint64_t seen = since / 2;
+  bool endSeen = since % 2 == 1;
+  uint32_t count = 0;
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
+  if (archived) {
+    bids = getArchivedAuctionBids(auctionID, UINT32_MAX);
+    count = (uint32_t)bids.size();
+    // largest first, so the newer bids are at the front
+    size_t newer = seen < count ? count - (size_t)seen : 0;
+    bids.resize(std::min(newer, (size_t)TOP_BIDS_MAX));
+  } else {
+    bids = topBids.getBidsSince(
+        auctionID, (uint32_t)std::min<uint64_t>(seen, UINT32_MAX), count);
+  }
+
+  std::pair<std::string, uint32_t> end =
+      archived ? getArchivedAuctionEnd(auctionID)
+               : getAuctionEndInfo(auctionID);
+  bool closed = end.first != "";
+  uint64_t version = (uint64_t)count * 2 + closed;
+
+  if (seen > count || (endSeen && !closed)) {
+    // not a version of this auction, send the whole record instead
+    return getAuctionRecordChanges(auctionID, 0);
+  }
+  if (endSeen) {
+    end = std::make_pair("", 0);
+  }
+  return std::make_tuple(version, bids, end);
+}
+
+std::vector<std::string>
+AuctionManager::getArchivableAuctions(uint32_t archiveAfter) {
+  TraceSpan traceSpan("AuctionManager::getArchivableAuctions");
+  std::vector<std::string> archivable;
+  int currentTimeSeconds = (int)std::time(nullptr);
+
+  for (uint32_t i = 1; i <= getAuctionCount(); i++) {
+    std::string auctionID = intToStringWithZeros((int)i, AUCTION_ID_LENGTH);
+    std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+    std::string end = auctionPath + SLASH + END_FILE + auctionID + TXT_EXT;
+    if (directory_exists(auctionPath) == INVALID ||
+        file_exists(end) == INVALID) {
+      continue; // archived, being opened or still active
+    }
+
+    try {
+      // closed at the start time plus the seconds it was active
+      std::string auctionInfo = getAuctionInfo(auctionID);
+      int startTimeSeconds =
+          std::stoi(auctionInfo.substr(auctionInfo.find_last_of(" ") + 1));
+      int closedTimeSeconds =
+          startTimeSeconds + (int)getAuctionEndInfo(auctionID).second;
+
+      if (currentTimeSeconds - closedTimeSeconds >= (int)archiveAfter) {
+        archivable.push_back(auctionID);
+      }
+    } catch (std::exception &e) {
+      // END file still being written, try again on the next pass
+    }
+  }
+  return archivable;
+}
+
+void AuctionManager::removeArchivedAuction(std::string auctionID) {
+  TraceSpan traceSpan("AuctionManager::removeArchivedAuction", auctionID);
+  if (isAuctionArchived(auctionID) == INVALID) {
+    return;
+  }
+  delete_directory(AUCTION_DIR + SLASH + auctionID);
+  topBids.forget(auctionID);
+}
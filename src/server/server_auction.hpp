@@ -4,10 +4,15 @@
 #include "../utils/constants.hpp"
 #include "../utils/protocol.hpp"
 #include "../utils/utils.hpp"
+#include "auction_archive.hpp"
+#include "listing_cache.hpp"
 #include "server_user.hpp"
+#include "top_bids.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <random>
@@ -39,6 +44,13 @@ public:
    */
   std::string getNextAuctionID();
 
+  /**
+   * @brief Get the number of auction IDs handed out so far
+   *
+   * @return The number of auctions, including the ones still being opened
+   */
+  uint32_t getAuctionCount();
+
   /**
    * @brief Lists all auctions.
    *
@@ -46,6 +58,49 @@ public:
    */
   std::vector<std::pair<std::string, uint8_t>> listAuctions();
 
+  /**
+   * @brief Lists the auctions after a cursor, in order of auction ID.
+   *
+   * @param cursor  the auction ID the page starts after, 000 for the first
+   * @param limit  the maximum number of auctions in the page
+   * @param filter  only the auctions it accepts are listed, all if empty
+   * @return A vector of pairs containing the auction ID and the auction status
+   */
+  std::vector<std::pair<std::string, uint8_t>>
+  listAuctionsPage(const std::string &cursor, uint32_t limit,
+                   const std::function<bool(const std::string &)> &filter);
+
+  /**
+   * @brief Gets the cursor of the page following a listed page.
+   *
+   * @param page  the auctions listed in the page
+   * @param limit  the maximum number of auctions the page could have
+   * @return The cursor of the next page, or 000 if this was the last one
+   */
+  std::string
+  getNextCursor(const std::vector<std::pair<std::string, uint8_t>> &page,
+                uint32_t limit);
+
+  /**
+   * @brief Serializes the reply to a list auctions request.
+   *
+   * The reply is copied from a cache, and only built again when an auction was
+   * opened or expired since.
+   *
+   * @param buffer the buffer to write the reply to
+   */
+  void serializeAuctionList(PacketBuffer &buffer);
+
+  /**
+   * @brief Lists the auctions whose state changed after a catalog version.
+   *
+   * @param since the catalog version the client has seen
+   * @param version set to the catalog version of the changes
+   * @return A vector of pairs containing the auction ID and the auction status
+   */
+  std::vector<std::pair<std::string, uint8_t>>
+  getAuctionListChanges(uint64_t since, uint64_t &version);
+
   /**
    * @brief Lists all auctions in which an user has bidded.
    *
@@ -55,6 +110,18 @@ public:
   std::vector<std::pair<std::string, uint8_t>>
   listUserAuctions(std::string userID);
 
+  /**
+   * @brief Lists a page of the auctions of an user.
+   *
+   * @param userID the user ID to check
+   * @param cursor the auction ID the page starts after, 000 for the first
+   * @param limit the maximum number of auctions in the page
+   * @return A vector of pairs containing the auction ID and the auction status
+   */
+  std::vector<std::pair<std::string, uint8_t>>
+  listUserAuctionsPage(std::string userID, const std::string &cursor,
+                       uint32_t limit);
+
   /**
    * @brief Gets the auction info.
    *
@@ -80,6 +147,18 @@ public:
   std::vector<std::pair<std::string, uint8_t>>
   getAuctionsBiddedByUser(std::string userID);
 
+  /**
+   * @brief Get a page of the auctions in which an user has bidded
+   *
+   * @param userID  the user ID to check
+   * @param cursor  the auction ID the page starts after, 000 for the first
+   * @param limit  the maximum number of auctions in the page
+   * @return A vector of pairs containing the auction ID and the auction status
+   */
+  std::vector<std::pair<std::string, uint8_t>>
+  getAuctionsBiddedByUserPage(std::string userID, const std::string &cursor,
+                              uint32_t limit);
+
   /**
    * @brief Get the Auction Owner
    *
@@ -121,9 +200,10 @@ public:
    * @brief Get the Auction Asset object
    *
    * @param auctionID  the auction ID to check
-   * @return A tuple containing the asset filename, asset size and asset path
+   * @return A tuple containing the asset filename, asset size, the path of the
+   * file it is stored in and its offset in that file
    */
-  std::tuple<std::string, uint32_t, std::string>
+  std::tuple<std::string, uint32_t, std::string, uint32_t>
   getAuctionAsset(std::string auctionID);
 
   /**
@@ -138,6 +218,43 @@ public:
       std::pair<std::string, uint32_t>>
   getAuctionRecord(std::string auctionID);
 
+  /**
+   * @brief Get the changes to the record of an auction after a version.
+   *
+   * The record version of an auction is twice the number of bids placed on
+   * it, plus one once it is closed, so it only grows.
+   *
+   * @param auctionID  the auction ID to check
+   * @param since  the record version the client has seen
+   * @return A tuple containing the record version, the bids placed after it,
+   * largest first, and the end of the auction if it closed after it
+   */
+  std::tuple<
+      uint64_t,
+      std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>,
+      std::pair<std::string, uint32_t>>
+  getAuctionRecordChanges(std::string auctionID, uint64_t since);
+
+  /**
+   * @brief Waits for an auction to receive a bid or close, keeping the
+   * connection of the watch request open until it does.
+   *
+   * @param auctionID  the auction ID to watch
+   * @param fd  the connection of the watch request
+   * @param timeout  the seconds to wait for at most
+   * @param released  called once the watch request is answered, if it was kept
+   * @return false if the auction is already closed, and nothing was kept
+   */
+  bool watchAuction(std::string auctionID, int fd, uint32_t timeout,
+                    std::function<void()> released);
+
+  /**
+   * @brief Answers the watch requests whose timeout has expired.
+   *
+   * @param now  the current time
+   */
+  void expireWatchers(time_t now);
+
   /**
    * @brief Check if an auction is past its deadline
    *
@@ -153,6 +270,22 @@ public:
    */
   void createCloseAuctionFile(std::string auctionID, bool automaticClosure);
 
+  /**
+   * @brief Get the auctions that have been closed for long enough to be
+   * archived.
+   *
+   * @param archiveAfter  the seconds an auction must have been closed for
+   * @return The IDs of the auctions to archive
+   */
+  std::vector<std::string> getArchivableAuctions(uint32_t archiveAfter);
+
+  /**
+   * @brief Removes the live data of an auction, once its archive was written.
+   *
+   * @param auctionID  the archived auction ID
+   */
+  void removeArchivedAuction(std::string auctionID);
+
   /**
    * @brief Construct a new Auction Manager object
    *
@@ -164,6 +297,20 @@ public:
    *
    */
   ~AuctionManager() = default;
+
+private:
+  /**
+   * @brief Loads the auction ID counter from the database.
+   */
+  static void loadAuctionCounter();
+
+  /**
+   * @brief Reserves a new batch of auction IDs in the database, up to and
+   * including the given ID.
+   *
+   * @param auctionID the auction ID that must be reserved
+   */
+  void reserveAuctionIDs(uint32_t auctionID);
 };
 
 /**
@@ -214,6 +361,17 @@ public:
                            "auctions") {}
 };
 
+/**
+ * @brief Exception thrown when the server is holding too many watch requests.
+ *
+ */
+class WatchersLimitExceededException : public std::runtime_error {
+public:
+  WatchersLimitExceededException()
+      : std::runtime_error("The server is holding the maximum number of "
+                           "watch requests") {}
+};
+
 /**
  * @brief Exception thrown when the auction owner is not the user.
  *
@@ -7,11 +7,24 @@
 #include <unistd.h>
 
 #include "../utils/protocol.hpp"
+#include "../utils/tracer.hpp"
 #include "../utils/utils.hpp"
 #include "handlers.hpp"
 
 AuctionServerState::AuctionServerState(std::string &port, bool _verbose)
-    : verbose{VerboseStream(_verbose)} {
+    : logger{_verbose ? LOG_DEBUG : LOG_INFO}, verbose{logger, LOG_DEBUG},
+      info{logger, LOG_INFO}, warning{logger, LOG_WARNING},
+      error{logger, LOG_ERROR},
+      requestStats{{LoginRequest::ID, LogoutRequest::ID, UnregisterRequest::ID,
+                    ListUserAuctionsRequest::ID, ListUserBidsRequest::ID,
+                    ListAuctionsRequest::ID, ShowRecordRequest::ID,
+                    ListAuctionsPageRequest::ID,
+                    ListUserAuctionsPageRequest::ID,
+                    ListUserBidsPageRequest::ID, ListAuctionsDeltaRequest::ID,
+                    ShowRecordDeltaRequest::ID, StatsRequest::ID,
+                    OpenAuctionRequest::ID, CloseAuctionRequest::ID,
+                    ShowAssetRequest::ID, BidRequest::ID,
+                    ListAuctionsStreamRequest::ID, WatchRequest::ID}} {
   this->setupUdpSocket();
   this->setupTcpSocket();
   this->resolveServerAddress(port);
@@ -67,7 +80,7 @@ void AuctionServerState::resolveServerAddress(std::string &port) {
     throw FatalError("Failed to bind TCP address", errno);
   }
 
-  std::cout << "Listening for connections on port " << port << std::endl;
+  info << "Listening for connections on port " << port << std::endl;
 }
 
 void AuctionServerState::setupUdpSocket() {
@@ -110,49 +123,105 @@ void AuctionServerState::setupTcpSocket() {
   }
 }
 
-void AuctionServerState::registerHandlers() {
-  registerUdpPacketHandlers();
-  registerTcpPacketHandlers();
-}
-
-void AuctionServerState::registerUdpPacketHandlers() {
-  // add to UDP packet handlers
-  UdpPacketHandlers.insert({LoginRequest::ID, handleLogin});
-  UdpPacketHandlers.insert({LogoutRequest::ID, handleLogout});
-  UdpPacketHandlers.insert({UnregisterRequest::ID, handleUnregister});
-  UdpPacketHandlers.insert(
-      {ListUserAuctionsRequest::ID, handleListUserAuctions});
-  UdpPacketHandlers.insert({ListUserBidsRequest::ID, handleListUserBids});
-  UdpPacketHandlers.insert({ListAuctionsRequest::ID, handleListAuctions});
-  UdpPacketHandlers.insert({ShowRecordRequest::ID, handleShowRecord});
-}
-
-void AuctionServerState::registerTcpPacketHandlers() {
-  // add to TCP packet handlers
-  TcpPacketHandlers.insert({OpenAuctionRequest::ID, handleOpenAuction});
-  TcpPacketHandlers.insert({CloseAuctionRequest::ID, handleCloseAuction});
-  TcpPacketHandlers.insert({ShowAssetRequest::ID, handleShowAsset});
-  TcpPacketHandlers.insert({BidRequest::ID, handleBid});
-}
-
-void AuctionServerState::callUdpPacketHandler(std::string packet_id,
-                                              std::stringstream &stream,
+void AuctionServerState::callUdpPacketHandler(uint32_t packet_id,
+                                              std::string_view packet,
                                               SocketAddress &source_addr) {
-  auto handler = this->UdpPacketHandlers.find(packet_id);
-  if (handler == this->UdpPacketHandlers.end()) {
+  UdpPacketHandler handler;
+  switch (packet_id) {
+  case packPacketID(LoginRequest::ID):
+    handler = handleLogin;
+    break;
+  case packPacketID(LogoutRequest::ID):
+    handler = handleLogout;
+    break;
+  case packPacketID(UnregisterRequest::ID):
+    handler = handleUnregister;
+    break;
+  case packPacketID(ListUserAuctionsRequest::ID):
+    handler = handleListUserAuctions;
+    break;
+  case packPacketID(ListUserBidsRequest::ID):
+    handler = handleListUserBids;
+    break;
+  case packPacketID(ListAuctionsRequest::ID):
+    handler = handleListAuctions;
+    break;
+  case packPacketID(ShowRecordRequest::ID):
+    handler = handleShowRecord;
+    break;
+  case packPacketID(ListAuctionsPageRequest::ID):
+    handler = handleListAuctionsPage;
+    break;
+  case packPacketID(ListUserAuctionsPageRequest::ID):
+    handler = handleListUserAuctionsPage;
+    break;
+  case packPacketID(ListUserBidsPageRequest::ID):
+    handler = handleListUserBidsPage;
+    break;
+  case packPacketID(ListAuctionsDeltaRequest::ID):
+    handler = handleListAuctionsDelta;
+    break;
+  case packPacketID(ShowRecordDeltaRequest::ID):
+    handler = handleShowRecordDelta;
+    break;
+  case packPacketID(StatsRequest::ID):
+    handler = handleStats;
+    break;
+  default:
+    requestStats.countUnknown();
     verbose << "Received unknown Packet ID" << std::endl;
     throw InvalidPacketException();
   }
 
-  handler->second(*this, stream, source_addr);
+  // the whole datagram, as received
+  size_t bytesIn = PACKET_ID_LEN + packet.length();
+  if (source_addr.encoding == BINARY_ENCODING) {
+    bytesIn += BINARY_HEADER_LEN;
+  }
+  HandlerStats &stats = *requestStats.find(packet_id);
+  RequestTimer timer(stats, bytesIn);
+  TraceRequest trace(stats.name.c_str(), "UDP");
+  handler(*this, packet, source_addr);
 }
 
-void AuctionServerState::callTcpPacketHandler(std::string packet_id, int fd) {
-  auto handler = this->TcpPacketHandlers.find(packet_id);
-  if (handler == this->TcpPacketHandlers.end()) {
+void AuctionServerState::callTcpPacketHandler(uint32_t packet_id, int fd) {
+  TcpPacketHandler handler;
+  switch (packet_id) {
+  case packPacketID(OpenAuctionRequest::ID):
+    handler = handleOpenAuction;
+    break;
+  case packPacketID(CloseAuctionRequest::ID):
+    handler = handleCloseAuction;
+    break;
+  case packPacketID(ShowAssetRequest::ID):
+    handler = handleShowAsset;
+    break;
+  case packPacketID(BidRequest::ID):
+    handler = handleBid;
+    break;
+  case packPacketID(ListAuctionsStreamRequest::ID):
+    handler = handleListAuctionsStream;
+    break;
+  case packPacketID(WatchRequest::ID):
+    handler = handleWatch;
+    break;
+  default:
+    requestStats.countUnknown();
     verbose << "Received unknown Packet ID" << std::endl;
     throw InvalidPacketException();
   }
 
-  handler->second(*this, fd);
-}
\ No newline at end of file
+  HandlerStats &stats = *requestStats.find(packet_id);
+  RequestTimer timer(stats, fd);
+  TraceRequest trace(stats.name.c_str(), "TCP");
+  handler(*this, fd);
+}
+
+std::shared_lock<std::shared_mutex> AuctionServerState::lockArchive() {
+  std::shared_lock<std::shared_mutex> lock(archiveLock, std::defer_lock);
+  {
+    TraceSpan traceSpan("archiveLock wait");
+    lock.lock();
+  }
+  return lock;
+}
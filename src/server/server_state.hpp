@@ -6,13 +6,16 @@
 #include <mutex>
 #include <netdb.h>
 #include <optional>
+#include <shared_mutex>
 #include <stdexcept>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
+#include "admission_control.hpp"
+#include "async_logger.hpp"
+#include "request_stats.hpp"
 #include "server_auction.hpp"
 #include "server_user.hpp"
-#include "verbose_stream.hpp"
 
 class AuctionServerState;
 
@@ -26,9 +29,11 @@ public:
   int socket;
   struct sockaddr_in addr;
   socklen_t size;
+  PacketEncoding encoding = TEXT_ENCODING; // the encoding of the request
+  uint32_t requestID = 0; // of a binary request, echoed in its reply
 };
 
-typedef void (*UdpPacketHandler)(AuctionServerState &, std::stringstream &,
+typedef void (*UdpPacketHandler)(AuctionServerState &, std::string_view,
                                  SocketAddress &);
 typedef void (*TcpPacketHandler)(AuctionServerState &, int fd);
 
@@ -41,19 +46,24 @@ typedef void (*TcpPacketHandler)(AuctionServerState &, int fd);
  * server's port, word file path, and a map of usernames to passwords.
  */
 class AuctionServerState {
-
-  // Maps the command string to the handler type
-  std::unordered_map<std::string, UdpPacketHandler> UdpPacketHandlers;
-  std::unordered_map<std::string, TcpPacketHandler> TcpPacketHandlers;
-
 public:
   int udpSocketFD = -1;
   int tcpSocketFD = -1;
   struct addrinfo *serverUdpAddr = NULL;
   struct addrinfo *serverTcpAddr = NULL;
-  VerboseStream verbose;
+  AsyncLogger logger; // constructed before, and destroyed after, its streams
+  LogStream verbose;  // only written in verbose mode
+  LogStream info;
+  LogStream warning;
+  LogStream error;
   UserManager usersManager;
   AuctionManager auctionManager;
+  RequestStats requestStats; // of every request, recorded by the dispatchers
+  AdmissionControl admission; // of the UDP requests and TCP connections
+
+  // held shared while a request looks up and reads auctions, and exclusively
+  // by the archiver while it removes the live data of an archived auction
+  std::shared_mutex archiveLock;
 
   AuctionServerState(std::string &port, bool _verbose);
 
@@ -77,37 +87,30 @@ public:
    */
   void resolveServerAddress(std::string &port);
 
-  /**
-   * @brief Registers all server handlers
-   */
-  void registerHandlers();
-
-  /**
-   * @brief Registers a UDP packet handler with the server.
-   */
-  void registerUdpPacketHandlers();
-
-  /**
-   * @brief Registers a TCP packet handler with the server.
-   */
-  void registerTcpPacketHandlers();
-
   /**
    * @brief Calls the handler for the given UDP packet.
    *
-   * @param packet_id  The packet ID.
-   * @param stream  The packet stream.
+   * @param packet_id  The packet ID, packed by packPacketID.
+   * @param packet  The packet, after its ID.
    * @param addr_from  The address the packet came from.
    */
-  void callUdpPacketHandler(std::string packet_id, std::stringstream &stream,
+  void callUdpPacketHandler(uint32_t packet_id, std::string_view packet,
                             SocketAddress &addr_from);
 
   /**
    * @brief Calls the handler for the given TCP packet.
    *
-   * @param packet_id  The packet ID.
+   * @param packet_id  The packet ID, packed by packPacketID.
    * @param fd  The file descriptor the packet came from
    */
-  void callTcpPacketHandler(std::string packet_id, int fd);
+  void callTcpPacketHandler(uint32_t packet_id, int fd);
+
+  /**
+   * @brief Holds off the archiver while a request looks up auctions, live or
+   * archived, and reads them, never while it waits on its socket.
+   *
+   * @return the shared lock of the archive, held until it goes out of scope
+   */
+  std::shared_lock<std::shared_mutex> lockArchive();
 };
 #endif
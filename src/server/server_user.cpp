@@ -1,69 +1,87 @@
 #include "server_user.hpp"
 #include "../utils/protocol.hpp"
+#include "../utils/tracer.hpp"
+
+// State of every user, shared by all UserManagers
+UserTable userTable;
 
 int8_t UserManager::isUserLoggedIn(std::string userID) {
-  std::string loginFile =
-      USER_DIR + SLASH + userID + SLASH + userID + LOGIN_FILE;
+  TraceSpan traceSpan("UserManager::isUserLoggedIn", userID);
+  int32_t index = UserTable::indexOf(userID);
+  if (index == -1) {
+    return INVALID;
+  }
 
-  return file_exists(loginFile) == INVALID ? INVALID : VALID;
+  UserRecord record = userTable.read((uint32_t)index);
+  return (record.flags & USER_LOGGED_IN) ? VALID : INVALID;
 }
 
 std::string UserManager::getUserPassword(std::string userID) {
-  try {
-    std::string validPassword;
-    std::string passwordPath =
-        USER_DIR + SLASH + userID + SLASH + userID + PASS_FILE;
-    read_from_file(passwordPath, validPassword);
-    return validPassword;
-  } catch (...) {
-    throw std::exception();
+  TraceSpan traceSpan("UserManager::getUserPassword", userID);
+  int32_t index = UserTable::indexOf(userID);
+  if (index == -1) {
+    return "";
   }
+
+  // unregistered users have no password, so it never matches
+  UserRecord record = userTable.read((uint32_t)index);
+  if (!(record.flags & USER_REGISTERED)) {
+    return "";
+  }
+  return std::string(record.password, PASSWORD_LENGTH);
 }
 
 void UserManager::login(std::string userID, std::string password) {
+  TraceSpan traceSpan("UserManager::login", userID);
   if (validateUserID(userID) == INVALID ||
       validatePassword(password) == INVALID) {
     throw InvalidPacketException();
   }
 
-  try {
-    if (password != getUserPassword(userID)) { // check if password is valid
-      throw InvalidCredentialsException();
-    }
-
-    std::string loginPath =
-        USER_DIR + SLASH + userID + SLASH + userID + LOGIN_FILE;
-    create_new_file(loginPath);
-  } catch (std::exception &e) {
-    throw;
+  bool validPassword = false;
+  userTable.update((uint32_t)UserTable::indexOf(userID),
+                   [&](UserRecord &record) {
+                     validPassword =
+                         (record.flags & USER_REGISTERED) &&
+                         password.compare(0, PASSWORD_LENGTH, record.password,
+                                          PASSWORD_LENGTH) == 0;
+                     if (validPassword) {
+                       record.flags |= USER_LOGGED_IN;
+                     }
+                   });
+
+  if (!validPassword) { // check if password is valid
+    throw InvalidCredentialsException();
   }
 }
 
 void UserManager::registerUser(std::string userID, std::string password) {
+  TraceSpan traceSpan("UserManager::registerUser", userID);
   if (validateUserID(userID) == INVALID ||
       validatePassword(password) == INVALID) {
     throw InvalidPacketException();
   }
 
-  try {
-    std::string userPath = USER_DIR + SLASH + userID;
-    create_new_directory(userPath);
-
-    std::string passwordPath = userPath + SLASH + userID + PASS_FILE;
-    create_new_file(passwordPath);
-    write_to_file(passwordPath, password);
-    login(userID, password);
-  } catch (std::exception &e) {
-    throw;
-  }
+  userTable.update((uint32_t)UserTable::indexOf(userID),
+                   [&](UserRecord &record) {
+                     record.flags = USER_REGISTERED | USER_LOGGED_IN;
+                     password.copy(record.password, PASSWORD_LENGTH);
+                   });
 }
 
 int8_t UserManager::userExists(std::string userID) {
-  std::string userPath = USER_DIR + SLASH + userID + SLASH + userID + PASS_FILE;
-  return file_exists(userPath) == INVALID ? INVALID : VALID;
+  TraceSpan traceSpan("UserManager::userExists", userID);
+  int32_t index = UserTable::indexOf(userID);
+  if (index == -1) {
+    return INVALID;
+  }
+
+  UserRecord record = userTable.read((uint32_t)index);
+  return (record.flags & USER_REGISTERED) ? VALID : INVALID;
 }
 
 void UserManager::logout(std::string userID, std::string password) {
+  TraceSpan traceSpan("UserManager::logout", userID);
   if (validateUserID(userID) == INVALID ||
       validatePassword(password) == INVALID) {
     throw InvalidPacketException();
@@ -73,16 +91,13 @@ void UserManager::logout(std::string userID, std::string password) {
     throw InvalidCredentialsException();
   }
 
-  try {
-    std::string loginPath =
-        USER_DIR + SLASH + userID + SLASH + userID + LOGIN_FILE;
-    delete_file(loginPath);
-  } catch (std::exception &e) {
-    throw;
-  }
+  userTable.update(
+      (uint32_t)UserTable::indexOf(userID),
+      [](UserRecord &record) { record.flags &= (uint8_t)~USER_LOGGED_IN; });
 }
 
 void UserManager::unregisterUser(std::string userID, std::string password) {
+  TraceSpan traceSpan("UserManager::unregisterUser", userID);
   if (validateUserID(userID) == INVALID ||
       validatePassword(password) == INVALID) {
     throw InvalidPacketException();
@@ -92,14 +107,32 @@ void UserManager::unregisterUser(std::string userID, std::string password) {
     throw InvalidCredentialsException();
   }
 
-  try {
-    std::string userPath = USER_DIR + SLASH + userID;
-    std::string loginPath = userPath + SLASH + userID + LOGIN_FILE;
-    delete_file(loginPath);
+  // the auction count is kept, the auctions still belong to the user ID
+  userTable.update((uint32_t)UserTable::indexOf(userID),
+                   [](UserRecord &record) {
+                     record.flags = 0;
+                     std::fill(record.password,
+                               record.password + PASSWORD_LENGTH, 0);
+                   });
+}
 
-    std::string passwordPath = userPath + SLASH + userID + PASS_FILE;
-    delete_file(passwordPath);
-  } catch (std::exception &e) {
-    throw;
+void UserManager::addOwnedAuction(std::string userID) {
+  TraceSpan traceSpan("UserManager::addOwnedAuction", userID);
+  int32_t index = UserTable::indexOf(userID);
+  if (index == -1) {
+    throw InvalidPacketException();
   }
-}
\ No newline at end of file
+
+  userTable.update((uint32_t)index,
+                   [](UserRecord &record) { record.auctionCount++; });
+}
+
+uint16_t UserManager::getOwnedAuctionCount(std::string userID) {
+  TraceSpan traceSpan("UserManager::getOwnedAuctionCount", userID);
+  int32_t index = UserTable::indexOf(userID);
+  if (index == -1) {
+    return 0;
+  }
+
+  return userTable.read((uint32_t)index).auctionCount;
+}
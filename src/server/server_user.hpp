@@ -4,6 +4,8 @@
 #include "../utils/constants.hpp"
 #include "../utils/protocol.hpp"
 #include "../utils/utils.hpp"
+#include "user_table.hpp"
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
@@ -64,6 +66,21 @@ public:
    */
   std::string getUserPassword(std::string userID);
 
+  /**
+   * @brief Registers a new auction opened by an user.
+   *
+   * @param userID the user ID of the auction owner
+   */
+  void addOwnedAuction(std::string userID);
+
+  /**
+   * @brief Gets the number of auctions opened by an user.
+   *
+   * @param userID the user ID to check
+   * @return the number of auctions owned by the user
+   */
+  uint16_t getOwnedAuctionCount(std::string userID);
+
   /**
    * @brief Constructs a new User Manager object.
    */
@@ -1,6 +1,10 @@
 #include "tcp_worker_pool.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 Worker::Worker() { thread = std::thread(&Worker::execute, this); }
@@ -25,30 +29,75 @@ void Worker::execute() {
         return;
       }
 
-      std::string packet_id = read_packet_id(tcpSocketFD);
+      // however slowly the request trickles in, the worker is set free soon,
+      // and however fast its upload does, it is stopped once over the limit
+      ReadDeadline deadline(TCP_REQUEST_DEADLINE_SECONDS, [this](size_t bytes) {
+        uploadCharged += bytes;
+        return pool->state.admission.chargeUpload(sourceAddr, bytes);
+      });
+      uint32_t packet_id = read_packet_id(tcpSocketFD);
 
       pool->state.callTcpPacketHandler(packet_id, tcpSocketFD);
 
+      if (deadline.missed()) { // given up on by the handler
+        throw SlowConnectionException();
+      }
+      if (deadline.refused()) {
+        throw UploadRefusedException();
+      }
+    } catch (SlowConnectionException &e) {
+      pool->state.requestStats.countEvicted();
+      pool->state.warning << "Worker number " << workerID
+                          << " evicted a connection too slow to send its "
+                             "request"
+                          << std::endl;
+    } catch (UploadRefusedException &e) {
+      pool->state.requestStats.countRejected(UPLOAD_RATE_EXCEEDED);
+      pool->state.warning << "Worker number " << workerID
+                          << " refused an upload over the upload rate of its "
+                             "source"
+                          << std::endl;
+    } catch (OperationCancelledException &e) {
+      pool->state.verbose << "Worker number " << workerID
+                          << " gave up on a request, as the AS is shutting "
+                             "down"
+                          << std::endl;
     } catch (InvalidPacketException &e) {
+      pool->state.warning << "Invalid packet received by worker number "
+                          << workerID << std::endl;
       try {
         ErrorTcpPacket error_packet;
         error_packet.send(tcpSocketFD);
       } catch (...) {
-        std::cerr << "Failed to reply with ERR packet" << std::endl;
+        pool->state.error << "Failed to reply with ERR packet" << std::endl;
       }
     } catch (std::exception &e) {
-      std::cerr << "Worker number " << workerID
-                << " encountered an exception while running: " << e.what()
-                << std::endl;
+      pool->state.error << "Worker number " << workerID
+                        << " encountered an exception while running: "
+                        << e.what() << std::endl;
     } catch (...) {
-      std::cerr << "Worker number " << workerID
-                << " encountered an unknown exception while running."
-                << std::endl;
+      pool->state.error << "Worker number " << workerID
+                        << " encountered an unknown exception while running."
+                        << std::endl;
     }
 
     pool->state.verbose << "Worker number " << workerID
                         << " Closing connection..." << std::endl;
+    // the rest of what the source sent is charged to it, so it cannot upload
+    // too fast
+    uint64_t bytesIn = 0;
+    if (!isLoopback(sourceAddr)) {
+      struct tcp_info info = {};
+      socklen_t length = sizeof(info);
+      if (getsockopt(tcpSocketFD, IPPROTO_TCP, TCP_INFO, &info, &length) ==
+          0) {
+        bytesIn = info.tcpi_bytes_received;
+      }
+    }
+    bytesIn -= std::min(bytesIn, uploadCharged);
+    uploadCharged = 0;
     close(tcpSocketFD);
+    pool->state.admission.releaseConnection(sourceAddr, bytesIn);
     to_execute = false;
     pool->freeWorker(workerID);
   }
@@ -63,21 +112,19 @@ TcpWorkerPool::TcpWorkerPool(AuctionServerState &auctionState)
   }
 }
 
-std::string read_packet_id(int fd) {
-  char id[PACKET_ID_LEN + 1];
+uint32_t read_packet_id(int fd) {
+  char id[PACKET_ID_LEN];
   size_t to_read = PACKET_ID_LEN;
 
   while (to_read > 0) {
-    ssize_t n = read(fd, &id[PACKET_ID_LEN - to_read], to_read);
-    if (n <= 0) {
-      std::cerr << "Invalid packet ID received" << std::endl;
+    ssize_t n = ReadDeadline::read(fd, &id[PACKET_ID_LEN - to_read], to_read);
+    if (n <= 0) { // logged by the worker, which replies with ERR
       throw InvalidPacketException();
     }
     to_read -= (size_t)n;
   }
 
-  id[PACKET_ID_LEN] = '\0';
-  return std::string(id);
+  return packPacketID(std::string_view(id, PACKET_ID_LEN));
 }
 void TcpWorkerPool::freeWorker(uint32_t workerID) {
   std::scoped_lock<std::mutex> slock(busy_workers_lock);
@@ -86,7 +133,7 @@ void TcpWorkerPool::freeWorker(uint32_t workerID) {
   }
 }
 
-void TcpWorkerPool::giveConnection(int fd) {
+void TcpWorkerPool::giveConnection(int fd, const struct sockaddr_in &addr) {
   std::scoped_lock<std::mutex> slock(busy_workers_lock);
 
   for (size_t i = 0; i < POOL_SIZE; ++i) {
@@ -96,6 +143,7 @@ void TcpWorkerPool::giveConnection(int fd) {
 
       busy_workers[i] = true;
       workers[i].tcpSocketFD = fd;
+      workers[i].sourceAddr = addr;
       workers[i].to_execute = true;
       workers[i].cond.notify_one();
 
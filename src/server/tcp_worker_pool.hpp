@@ -13,11 +13,13 @@ class TcpWorkerPool;
 
 class Worker {
   std::thread thread;
+  uint64_t uploadCharged = 0; // of the connection, as its upload arrived
 
   void execute();
 
 public:
   int tcpSocketFD = -1;
+  struct sockaddr_in sourceAddr; // of the connection
   bool is_exiting = false;
   bool to_execute = false;
   TcpWorkerPool *pool;
@@ -43,8 +45,9 @@ public:
    * @brief Attributes a socket to a worker that  is available.
    *
    * @param fd socket file descriptor.
+   * @param addr address the connection came from.
    */
-  void giveConnection(int fd);
+  void giveConnection(int fd, const struct sockaddr_in &addr);
 
   /**
    * @brief Frees a busy worker.
@@ -58,9 +61,9 @@ public:
  * @brief Get the packet ID of a TCP message from a socket.
  *
  * @param fd TCP socket file descriptor.
- * @return packet ID.
+ * @return packet ID, packed by packPacketID.
  */
-std::string read_packet_id(int fd);
+uint32_t read_packet_id(int fd);
 
 class AllWorkersBusyException : public std::runtime_error {
 public:
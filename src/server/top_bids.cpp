@@ -0,0 +1,120 @@
+#include "top_bids.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#include "../utils/io_counters.hpp"
+#include "../utils/protocol.hpp"
+#include "../utils/utils.hpp"
+
+TopBidsTable::Slot &TopBidsTable::slotOf(const std::string &auctionID) {
+  return slots[std::stoi(auctionID)];
+}
+
+void TopBidsTable::load(const std::string &auctionID, Slot &slot) {
+  if (slot.loaded) {
+    return;
+  }
+
+  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+  std::string topBidsPath =
+      auctionPath + SLASH + TOP_BIDS_FILE + auctionID + TXT_EXT;
+
+  slot.bids.clear();
+  slot.count = 0;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(auctionPath + BID_DIR)) {
+    threadIO.dirEntries++;
+    if (entry.is_regular_file() && entry.path().extension() == TXT_EXT) {
+      slot.count++;
+    }
+  }
+
+  if (file_exists(topBidsPath) == VALID) {
+    // one bid per line: UID bid_value bid_datetime bid_sec_time
+    std::string topBids;
+    read_from_file(topBidsPath, topBids);
+    for (auto line : splitOnSeparator(topBids, '\n')) {
+      std::vector<std::string> bidWords = splitOnSeparator(line, ' ');
+      if (bidWords.size() != 5) {
+        continue;
+      }
+      slot.bids.push_back(std::make_tuple(
+          bidWords[0], (uint32_t)std::stoi(bidWords[1]),
+          bidWords[2] + " " + bidWords[3], (uint32_t)std::stoi(bidWords[4])));
+    }
+  } else {
+    // auction opened before the top bids were kept, rebuild them
+    slot.bids = getAuctionBids(auctionID);
+    sortAuctionBids(slot.bids);
+    getTopNumBids(slot.bids, TOP_BIDS_MAX);
+    save(auctionID, slot);
+  }
+
+  slot.loaded = true;
+}
+
+void TopBidsTable::save(const std::string &auctionID, Slot &slot) {
+  std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
+  std::string topBidsPath =
+      auctionPath + SLASH + TOP_BIDS_FILE + auctionID + TXT_EXT;
+
+  std::string topBids;
+  for (auto bid : slot.bids) {
+    topBids += std::get<0>(bid) + " " + std::to_string(std::get<1>(bid)) +
+               " " + std::get<2>(bid) + " " +
+               std::to_string(std::get<3>(bid)) + "\n";
+  }
+
+  // written aside and renamed, so the file is never seen half-written, even
+  // if the AS stops meanwhile
+  std::string tmpPath = topBidsPath + ".tmp";
+  std::ofstream file(tmpPath, std::ios::out | std::ios::trunc);
+  file << topBids;
+  file.close();
+  threadIO.opens++;
+  threadIO.bytesWritten += topBids.length();
+  if (!file) {
+    delete_file(tmpPath);
+    throw IOException();
+  }
+  rename_file(tmpPath, topBidsPath);
+}
+
+std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+TopBidsTable::getTopBids(const std::string &auctionID) {
+  Slot &slot = slotOf(auctionID);
+  std::lock_guard<std::mutex> guard(slot.lock);
+  load(auctionID, slot);
+  return slot.bids;
+}
+
+std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+TopBidsTable::getBidsSince(const std::string &auctionID, uint32_t seen,
+                           uint32_t &count) {
+  Slot &slot = slotOf(auctionID);
+  std::lock_guard<std::mutex> guard(slot.lock);
+  load(auctionID, slot);
+
+  count = slot.count;
+  size_t newer = std::min((size_t)(count - std::min(seen, count)),
+                          slot.bids.size());
+  return std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>(
+      slot.bids.begin(), slot.bids.begin() + (std::ptrdiff_t)newer);
+}
+
+uint32_t TopBidsTable::getLargestBid(const std::string &auctionID) {
+  Slot &slot = slotOf(auctionID);
+  std::lock_guard<std::mutex> guard(slot.lock);
+  load(auctionID, slot);
+  return slot.bids.empty() ? 0 : std::get<1>(slot.bids.front());
+}
+
+void TopBidsTable::forget(const std::string &auctionID) {
+  Slot &slot = slotOf(auctionID);
+  std::lock_guard<std::mutex> guard(slot.lock);
+  slot.bids.clear();
+  slot.bids.shrink_to_fit();
+  slot.count = 0;
+  slot.loaded = false;
+}
@@ -0,0 +1,136 @@
+#ifndef TOP_BIDS_H
+#define TOP_BIDS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../utils/constants.hpp"
+
+/**
+ * @class TopBidsTable
+ *
+ * @brief Keeps the largest bids of every auction, ordered by bid value.
+ *
+ * Each auction holds at most TOP_BIDS_MAX bids, the ones shown by a show record
+ * request. They are persisted in the TOP_<aid>.txt file of the auction and
+ * loaded on first use, or rebuilt from the BIDS directory if that file does
+ * not exist yet.
+ */
+class TopBidsTable {
+  struct Slot {
+    std::mutex lock;
+    bool loaded = false;
+    uint32_t count = 0; // every bid ever placed, not only the top ones
+    // bidder ID, bid value, bid date-time, bid seconds, largest first
+    std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
+  };
+
+  Slot slots[AUCTION_ID_MAX + 1];
+
+  /**
+   * @brief Loads the top bids of an auction, if not loaded yet.
+   *
+   * @param auctionID the auction ID to load
+   * @param slot the slot of the auction
+   */
+  void load(const std::string &auctionID, Slot &slot);
+
+  /**
+   * @brief Writes the top bids of an auction to its file, replacing it at once.
+   *
+   * @param auctionID the auction ID to save
+   * @param slot the slot of the auction
+   */
+  void save(const std::string &auctionID, Slot &slot);
+
+  /**
+   * @brief Gets the slot of an auction.
+   *
+   * @param auctionID the auction ID, which must be valid
+   * @return the slot of the auction
+   */
+  Slot &slotOf(const std::string &auctionID);
+
+public:
+  /**
+   * @brief Gets the top bids of an auction.
+   *
+   * @param auctionID the auction ID to check
+   * @return the bids, largest first
+   */
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+  getTopBids(const std::string &auctionID);
+
+  /**
+   * @brief Gets the bids placed on an auction after the first ones.
+   *
+   * As every bid is larger than the ones before, these are its largest bids.
+   *
+   * @param auctionID the auction ID to check
+   * @param seen the number of bids already seen, which are left out
+   * @param count set to the number of bids placed on the auction
+   * @return the newer bids, largest first, up to TOP_BIDS_MAX of them
+   */
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
+  getBidsSince(const std::string &auctionID, uint32_t seen, uint32_t &count);
+
+  /**
+   * @brief Gets the largest bid value of an auction.
+   *
+   * @param auctionID the auction ID to check
+   * @return the largest bid value, or 0 if there are no bids
+   */
+  uint32_t getLargestBid(const std::string &auctionID);
+
+  /**
+   * @brief Drops the bids of an auction from memory, after it was archived.
+   *
+   * @param auctionID the auction ID to drop
+   */
+  void forget(const std::string &auctionID);
+
+  /**
+   * @brief Places a bid, if it is larger than every other bid and the minimum
+   * value.
+   *
+   * The check and the update are done atomically, so concurrent bids on the
+   * same auction cannot both be accepted.
+   *
+   * @param auctionID the auction ID to bid on
+   * @param bid the bidder ID, bid value, bid date-time and bid seconds
+   * @param minValue the value the bid must be larger than
+   * @param store function that stores the bid in the database
+   * @return true if the bid was placed, false if it was refused
+   */
+  template <class Fn>
+  bool placeBid(const std::string &auctionID,
+                const std::tuple<std::string, uint32_t, std::string, uint32_t>
+                    &bid,
+                uint32_t minValue, Fn store) {
+    Slot &slot = slotOf(auctionID);
+    std::lock_guard<std::mutex> guard(slot.lock);
+    load(auctionID, slot);
+
+    uint32_t largest = slot.bids.empty() ? 0 : std::get<1>(slot.bids.front());
+    if (std::get<1>(bid) <= std::max(largest, minValue)) {
+      return false;
+    }
+
+    store();
+
+    // larger than every bid, so it goes in the front
+    slot.bids.insert(slot.bids.begin(), bid);
+    slot.count++;
+    if (slot.bids.size() > TOP_BIDS_MAX) {
+      slot.bids.pop_back();
+    }
+    save(auctionID, slot);
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "user_table.hpp"
+
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../utils/utils.hpp"
+#include "auction_archive.hpp"
+
+UserTable::~UserTable() {
+  if (records != nullptr) {
+    munmap(records, size * sizeof(UserRecord));
+  }
+}
+
+int32_t UserTable::indexOf(const std::string &userID) {
+  if (userID.length() != USER_ID_LENGTH) {
+    return -1;
+  }
+
+  int32_t index = 0;
+  for (char c : userID) {
+    if (c < '0' || c > '9') {
+      return -1;
+    }
+    index = index * 10 + (c - '0');
+  }
+  return index;
+}
+
+UserRecord UserTable::read(uint32_t index) {
+  std::call_once(opened, &UserTable::open, this);
+  std::lock_guard<std::mutex> guard(lock);
+  return records[index];
+}
+
+void UserTable::open() {
+  std::string path = USER_DIR + SLASH + USER_TABLE_FILE;
+  size = (size_t)USER_ID_MAX + 1;
+  off_t length = (off_t)(size * sizeof(UserRecord));
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    throw FatalError("Failed to open the user table", errno);
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == -1) {
+    close(fd);
+    throw FatalError("Failed to stat the user table", errno);
+  }
+
+  bool created = info.st_size == 0;
+  if (created && ftruncate(fd, length) == -1) {
+    close(fd);
+    throw FatalError("Failed to allocate the user table", errno);
+  } else if (!created && info.st_size != length) {
+    close(fd);
+    throw FatalError("The user table is corrupted");
+  }
+
+  void *mapping =
+      mmap(NULL, (size_t)length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd); // the mapping keeps its own reference to the file
+  if (mapping == MAP_FAILED) {
+    throw FatalError("Failed to map the user table", errno);
+  }
+  records = static_cast<UserRecord *>(mapping);
+
+  if (created) {
+    importDatabase();
+  }
+}
+
+void UserTable::importDatabase() {
+  // users, stored as USERS/<uid>/<uid>_pass.txt and <uid>_login.txt
+  for (const auto &entry : std::filesystem::directory_iterator(USER_DIR)) {
+    std::string userID = entry.path().filename().string();
+    int32_t index = indexOf(userID);
+    std::string passwordPath =
+        USER_DIR + SLASH + userID + SLASH + userID + PASS_FILE;
+    if (!entry.is_directory() || index == -1 ||
+        file_exists(passwordPath) == INVALID) {
+      continue;
+    }
+
+    std::string password;
+    read_from_file(passwordPath, password);
+    if (password.length() != PASSWORD_LENGTH) {
+      continue;
+    }
+
+    UserRecord &record = records[index];
+    record.flags = USER_REGISTERED;
+    password.copy(record.password, PASSWORD_LENGTH);
+    std::string loginPath =
+        USER_DIR + SLASH + userID + SLASH + userID + LOGIN_FILE;
+    if (file_exists(loginPath) == VALID) {
+      record.flags |= USER_LOGGED_IN;
+    }
+  }
+
+  // auction owners, the first word of AUCTIONS/<aid>/START_<aid>.txt
+  for (const auto &entry : std::filesystem::directory_iterator(AUCTION_DIR)) {
+    std::string auctionID = entry.path().filename().string();
+    std::string startPath =
+        AUCTION_DIR + SLASH + auctionID + SLASH + START_FILE + auctionID +
+        TXT_EXT;
+    if (!entry.is_directory() || file_exists(startPath) == INVALID) {
+      continue;
+    }
+
+    int32_t index = indexOf(getFirstWord(startPath));
+    if (index != -1) {
+      records[index].auctionCount++;
+    }
+  }
+
+  // archived auction owners, the first word of their START section
+  for (const auto &entry : std::filesystem::directory_iterator(ARCHIVE_DIR)) {
+    if (entry.path().extension() != ARCHIVE_EXT) {
+      continue;
+    }
+
+    std::string auctionInfo =
+        readArchiveSection(entry.path().stem().string(), ARCHIVE_START);
+    int32_t index = indexOf(auctionInfo.substr(0, auctionInfo.find(" ")));
+    if (index != -1) {
+      records[index].auctionCount++;
+    }
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef USER_TABLE_H
+#define USER_TABLE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "../utils/constants.hpp"
+
+#define USER_REGISTERED 0x01
+#define USER_LOGGED_IN 0x02
+
+/**
+ * @struct UserRecord
+ *
+ * @brief Fixed-size entry of the user table, one per possible user ID.
+ */
+struct UserRecord {
+  uint8_t flags;                  // USER_REGISTERED | USER_LOGGED_IN
+  char password[PASSWORD_LENGTH]; // not null terminated
+  uint8_t reserved;
+  uint16_t auctionCount; // number of auctions opened by the user
+};
+
+/**
+ * @class UserTable
+ *
+ * @brief Dense table holding the state of every user, indexed directly by the
+ * numeric user ID.
+ *
+ * The table is a memory mapping of a single file in the users directory, so
+ * every update is persisted without building paths or opening files. It is
+ * opened on first use, importing the users stored in the older one directory
+ * per user layout if the file does not exist yet.
+ */
+class UserTable {
+  UserRecord *records = nullptr;
+  size_t size = 0;
+  std::mutex lock;
+  std::once_flag opened;
+
+  /**
+   * @brief Maps the table file into memory, creating it if needed.
+   */
+  void open();
+
+  /**
+   * @brief Fills a new table with the users and auction owners already in the
+   * database.
+   */
+  void importDatabase();
+
+public:
+  /**
+   * @brief Converts an user ID into its index in the table.
+   *
+   * @param userID the user ID to convert
+   * @return the index of the user, or -1 if the user ID is not valid
+   */
+  static int32_t indexOf(const std::string &userID);
+
+  /**
+   * @brief Reads the record of an user.
+   *
+   * @param index the index of the user
+   * @return a copy of the user record
+   */
+  UserRecord read(uint32_t index);
+
+  /**
+   * @brief Atomically updates the record of an user.
+   *
+   * @param index the index of the user
+   * @param update function applied to the user record
+   */
+  template <class Fn> void update(uint32_t index, Fn update) {
+    std::call_once(opened, &UserTable::open, this);
+    std::lock_guard<std::mutex> guard(lock);
+    update(records[index]);
+  }
+
+  UserTable() = default;
+  ~UserTable();
+};
+
+#endif
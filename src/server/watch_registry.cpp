@@ -0,0 +1,80 @@
+#include "watch_registry.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+void WatchRegistry::answer(const Watcher &watcher, WatchResponse &response) {
+  try {
+    response.send(watcher.fd);
+  } catch (PacketSerializationException &e) {
+    // the watcher hung up, or stopped reading
+  }
+  close(watcher.fd);
+  if (watcher.released) {
+    watcher.released();
+  }
+}
+
+bool WatchRegistry::add(const std::string &auctionID, int fd, time_t deadline,
+                        bool closesAtDeadline,
+                        std::function<void()> released) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (count >= WATCHERS_MAX) {
+    return false;
+  }
+
+  int watchFD = dup(fd);
+  if (watchFD < 0) { // out of file descriptors
+    return false;
+  }
+  fcntl(watchFD, F_SETFL, fcntl(watchFD, F_GETFL) | O_NONBLOCK);
+
+  watchers[std::stoi(auctionID)].push_back(
+      Watcher{watchFD, deadline, closesAtDeadline, std::move(released)});
+  count++;
+  return true;
+}
+
+void WatchRegistry::notify(const std::string &auctionID,
+                           WatchResponse &response) {
+  std::vector<Watcher> notified;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    notified.swap(watchers[std::stoi(auctionID)]);
+    count -= notified.size();
+  }
+
+  // answered without the lock, so new watchers are not held up
+  for (const Watcher &watcher : notified) {
+    answer(watcher, response);
+  }
+}
+
+void WatchRegistry::expire(time_t now) {
+  std::vector<Watcher> expired;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (count == 0) {
+      return;
+    }
+    for (auto &auctionWatchers : watchers) {
+      auto it = std::partition(
+          auctionWatchers.begin(), auctionWatchers.end(),
+          [now](const Watcher &watcher) { return watcher.deadline > now; });
+      expired.insert(expired.end(), it, auctionWatchers.end());
+      auctionWatchers.erase(it, auctionWatchers.end());
+    }
+    count -= expired.size();
+  }
+
+  WatchResponse timedOut;
+  timedOut.status = WatchResponse::TMO;
+  WatchResponse closed;
+  closed.status = WatchResponse::CLS;
+  for (const Watcher &watcher : expired) {
+    answer(watcher, watcher.closesAtDeadline ? closed : timedOut);
+  }
+}
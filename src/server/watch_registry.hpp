@@ -0,0 +1,77 @@
+#ifndef WATCH_REGISTRY_H
+#define WATCH_REGISTRY_H
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/constants.hpp"
+#include "../utils/protocol.hpp"
+
+/**
+ * @class WatchRegistry
+ *
+ * @brief Keeps the connections of the watch requests that are waiting for an
+ * auction to change.
+ *
+ * Every watcher holds a duplicate of its connection, in non-blocking mode, so
+ * the TCP worker that received the request is set free right away and a slow
+ * watcher can never stall the request that notifies it. A watcher is answered
+ * and closed once its auction receives a bid or closes, or once its deadline
+ * passes.
+ */
+class WatchRegistry {
+  struct Watcher {
+    int fd;
+    time_t deadline;
+    bool closesAtDeadline; // the auction expires at the deadline
+    std::function<void()> released; // called once it is answered
+  };
+
+  std::mutex lock;
+  size_t count = 0; // watchers of every auction
+  std::vector<Watcher> watchers[AUCTION_ID_MAX + 1];
+
+  /**
+   * @brief Answers a watcher and closes its connection.
+   *
+   * @param watcher the watcher
+   * @param response the response to send
+   */
+  static void answer(const Watcher &watcher, WatchResponse &response);
+
+public:
+  /**
+   * @brief Adds a watcher of an auction.
+   *
+   * @param auctionID the watched auction ID, which must be valid
+   * @param fd the connection of the watch request, which is left open for the
+   * caller to close
+   * @param deadline when to answer if the auction did not change
+   * @param closesAtDeadline whether the auction expires at the deadline
+   * @param released called once the watcher is answered, if it was added
+   * @return false if there are too many watchers already
+   */
+  bool add(const std::string &auctionID, int fd, time_t deadline,
+           bool closesAtDeadline, std::function<void()> released);
+
+  /**
+   * @brief Answers every watcher of an auction.
+   *
+   * @param auctionID the auction ID that changed
+   * @param response the response to send to its watchers
+   */
+  void notify(const std::string &auctionID, WatchResponse &response);
+
+  /**
+   * @brief Answers every watcher whose deadline has passed.
+   *
+   * @param now the current time
+   */
+  void expire(time_t now);
+};
+
+#endif
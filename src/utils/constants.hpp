@@ -12,28 +12,71 @@
 // Protocol constants
 #define USER_ID_LENGTH 6
 #define USER_ID_MAX ((uint32_t)pow(10, USER_ID_LENGTH) - 1)
+#define PASSWORD_LENGTH 8
 #define AUCTION_ID_LENGTH 3
+#define AUCTION_ID_MAX 999
 #define BID_VALLUE_LENGTH 6
 #define FILENAME_MAX_LENGTH 24
 #define ASSET_NAME_MAX 10
 #define START_VALUE_MAX 6
 #define AUCTION_DURATION_MAX 5
 #define FILESIZE_MAX 7
+#define DATE_TIME_LENGTH 19 // YYYY-MM-DD HH:MM:SS
 
 // UDP constants
-#define UDP_RESEND_TRIES 3
-#define UDP_TIMEOUT_SECONDS 5
+#define UDP_GIVE_UP_SECONDS 15      // a request is sent again until then
+#define UDP_RESEND_TRIES 8          // at most, more than fit in that time
+#define UDP_RTO_INITIAL_MS 1000     // wait for a reply, before any round trip
+#define UDP_RTO_MIN_MS 200          // shortest wait for a reply
+#define UDP_RTO_MAX_MS 10000        // longest wait for a reply, once backed off
+#define UDP_RTO_JITTER 0.25         // of a wait added at random, at most
 #define SOCKET_BUFFER_LEN 8192
+#define LIST_PAGE_SIZE 100      // auctions per paged listing reply
+#define LIST_CURSOR_START "000" // cursor of the first page, and after the last
+
+// Binary encoding constants
+#define BINARY_PACKET_MAGIC ((char)0xB1) // never starts a text packet
+#define BINARY_PROTOCOL_VERSION 2
+#define BINARY_HEADER_LEN 8 // magic, version, length of the rest, request ID
 
 // TCP constants
 #define TCP_WRITE_TIMEOUT_SECONDS 30
 #define TCP_READ_TIMEOUT_SECONDS 15
+#define TCP_REQUEST_DEADLINE_SECONDS 10 // for the AS to read a request, in full
+#define TCP_UPLOAD_MIN_RATE (64 << 10)  // bytes per second, added to it
+#define TCP_UPLOAD_CHARGE (64 << 10)    // bytes of an upload charged at once
+#define WATCH_TIMEOUT_MAX 600 // longest a watch request can be held open
+#define WATCHERS_MAX 4096     // watch requests held open at once
 
 // Server constants
 #define SERVER_TIMEOUT 3
 #define EXCEPTION_RETRY_MAX_TRIALS 3
 #define PACKET_ID_LEN 3
 #define FILE_BUFFER_LEN 512
+#define AUCTION_ID_BATCH 16
+#define TOP_BIDS_MAX 50
+#define ARCHIVE_AFTER_SECONDS 86400
+#define ARCHIVE_INTERVAL_SECONDS 60
+#define STATS_DUMP_INTERVAL_SECONDS 60
+#define STATS_SUB_BUCKETS_BITS 4 // 16 latency buckets per power of two
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKETS_BITS)
+#define STATS_LATENCY_BITS 36 // latencies are counted up to 2^36 us
+#define STATS_LATENCY_BUCKETS                                                  \
+  ((STATS_LATENCY_BITS - STATS_SUB_BUCKETS_BITS + 1) * STATS_SUB_BUCKETS)
+#define STATS_STATUSES_MAX 8 // reply statuses counted per request
+#define LOG_RECORD_LEN 256       // bytes of a log record, as queued
+#define LOG_RING_RECORDS 2048    // log records queued per thread
+#define LOG_FLUSH_INTERVAL_MS 10 // how often the queued records are printed
+#define TRACE_SAMPLING_DEFAULT 100 // 1 in this many requests is traced
+#define TRACE_RING_EVENTS 4096     // spans kept per thread, the oldest dropped
+#define TRACE_DETAIL_LEN 40        // bytes of the detail kept with a span
+#define ADMISSION_UDP_RATE 500          // UDP requests per second, per source
+#define ADMISSION_TCP_RATE 50           // TCP connections per second, likewise
+#define ADMISSION_CONNECTIONS_MAX 8     // TCP connections open per source
+#define ADMISSION_UPLOAD_RATE (4 << 20) // bytes per second sent over TCP
+#define ADMISSION_WATCHERS_MAX 64       // watch requests held open per source
+#define ADMISSION_BURST_SECONDS 2       // of its rates a source can use at once
+#define ADMISSION_SOURCES_SWEEP 4096    // sources kept before sweeping the idle
 
 // TCP thread management
 #define POOL_SIZE 50
@@ -43,16 +86,33 @@
 #define AS_DIR "AS-DB"
 #define USER_DIR (AS_DIR "/USERS")
 #define AUCTION_DIR (AS_DIR "/AUCTIONS")
+#define ARCHIVE_DIR (AS_DIR "/ARCHIVE")
 #define NEXT_AUCTION_FILE "next_auction.txt"
 #define LOGIN_FILE "_login.txt"
 #define PASS_FILE "_pass.txt"
+#define USER_TABLE_FILE "users.db"
 #define START_FILE "START_"
 #define END_FILE "END_"
+#define TOP_BIDS_FILE "TOP_"
 #define TXT_EXT ".txt"
+#define ARCHIVE_EXT ".arc"
+#define STATS_FILE (AS_DIR "/stats.txt")
+#define TRACE_FILE (AS_DIR "/trace.json")
+#define ARCHIVE_MAGIC "ASA1"
 #define SLASH std::string("/")
 #define ASSET_DIR (SLASH + "ASSET" + SLASH)
 #define BID_DIR (SLASH + "BIDS" + SLASH)
 
+// Load generator constants
+#define LOADGEN_USERS 50
+#define LOADGEN_DURATION_SECONDS 10
+#define LOADGEN_FIRST_USER_ID 900000 // simulated users take the IDs after it
+#define LOADGEN_PASSWORD "loadgen1"
+#define LOADGEN_MIX "LIN=1,LST=4,SRC=3,OPA=1,BID=3,SAS=1"
+#define LOADGEN_ASSET_NAME "loadgen.jpg"
+#define LOADGEN_ASSET_SIZE 1024
+#define LOADGEN_AUCTION_DURATION 3600
+
 // Commands arguments number
 #define LOGIN_ARGS_NUM 2
 #define LOGOUT_ARGS_NUM 0
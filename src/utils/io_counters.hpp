@@ -0,0 +1,24 @@
+#ifndef IO_COUNTERS_H
+#define IO_COUNTERS_H
+
+#include <cstdint>
+
+/**
+ * @brief The file system operations made by a thread, counted by the file
+ * helpers, so a request can tell how many it made from the difference between
+ * two readings.
+ */
+struct IOCounters {
+  uint64_t opens = 0;        // files opened
+  uint64_t stats = 0;        // existence and size checks
+  uint64_t changes = 0;      // files and directories created, moved or removed
+  uint64_t bytesRead = 0;    // from files
+  uint64_t bytesWritten = 0; // to files
+  uint64_t dirEntries = 0;   // directory entries iterated over
+  uint64_t locks = 0;        // file mutexes acquired
+};
+
+// the operations made by the calling thread so far
+extern thread_local IOCounters threadIO;
+
+#endif
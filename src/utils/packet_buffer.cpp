@@ -0,0 +1,69 @@
+#include "packet_buffer.hpp"
+
+#include <charconv>
+
+PacketBuffer &PacketBuffer::forThread() {
+  thread_local PacketBuffer buffer;
+  buffer.clear();
+  return buffer;
+}
+
+void PacketBuffer::clear() { bytes.clear(); }
+
+PacketBuffer &PacketBuffer::write(std::string_view str) {
+  bytes.append(str);
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeChar(char chr) {
+  bytes.push_back(chr);
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeInt(uint32_t value) {
+  return writeInt(value, 0);
+}
+
+PacketBuffer &PacketBuffer::writeInt64(uint64_t value) {
+  char digits[20]; // enough for any uint64_t
+  char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+  bytes.append(digits, (size_t)(end - digits));
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeInt(uint32_t value, size_t width) {
+  char digits[10]; // enough for any uint32_t
+  char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+  size_t length = (size_t)(end - digits);
+  if (length < width) {
+    bytes.append(width - length, '0');
+  }
+  bytes.append(digits, length);
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeUint8(uint8_t value) {
+  bytes.push_back((char)value);
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeUint16(uint16_t value) {
+  bytes.push_back((char)(value >> 8));
+  bytes.push_back((char)(value & 0xFF));
+  return *this;
+}
+
+PacketBuffer &PacketBuffer::writeUint32(uint32_t value) {
+  writeUint16((uint16_t)(value >> 16));
+  return writeUint16((uint16_t)(value & 0xFFFF));
+}
+
+PacketBuffer &PacketBuffer::writeUint64(uint64_t value) {
+  writeUint32((uint32_t)(value >> 32));
+  return writeUint32((uint32_t)(value & 0xFFFFFFFF));
+}
+
+void PacketBuffer::patchUint16(size_t offset, uint16_t value) {
+  bytes[offset] = (char)(value >> 8);
+  bytes[offset + 1] = (char)(value & 0xFF);
+}
@@ -0,0 +1,131 @@
+#ifndef PACKET_BUFFER_H
+#define PACKET_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @class PacketBuffer
+ *
+ * @brief Growable byte buffer packets are serialized into before being sent.
+ *
+ * Clearing the buffer keeps its capacity, so a buffer that is reused, like the
+ * one returned by forThread(), stops allocating once it has grown to fit the
+ * largest packet.
+ */
+class PacketBuffer {
+  std::string bytes;
+
+public:
+  /**
+   * @brief Gets the buffer of the calling thread, emptied.
+   *
+   * @return The buffer, valid until the next call on the same thread.
+   */
+  static PacketBuffer &forThread();
+
+  /**
+   * @brief Empties the buffer, keeping its capacity.
+   */
+  void clear();
+
+  /**
+   * @brief Appends a string to the buffer.
+   *
+   * @param str The string to append.
+   * @return The buffer.
+   */
+  PacketBuffer &write(std::string_view str);
+
+  /**
+   * @brief Appends a character to the buffer.
+   *
+   * @param chr The character to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeChar(char chr);
+
+  /**
+   * @brief Appends the decimal representation of an integer to the buffer.
+   *
+   * @param value The integer to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeInt(uint32_t value);
+
+  /**
+   * @brief Appends the decimal representation of a 64 bit integer to the
+   * buffer.
+   *
+   * @param value The integer to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeInt64(uint64_t value);
+
+  /**
+   * @brief Appends an integer to the buffer, padded with zeros on the left.
+   *
+   * @param value The integer to append.
+   * @param width The minimum number of digits.
+   * @return The buffer.
+   */
+  PacketBuffer &writeInt(uint32_t value, size_t width);
+
+  /**
+   * @brief Appends a byte to the buffer.
+   *
+   * @param value The byte to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeUint8(uint8_t value);
+
+  /**
+   * @brief Appends a 16 bit integer to the buffer, in network byte order.
+   *
+   * @param value The integer to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeUint16(uint16_t value);
+
+  /**
+   * @brief Appends a 32 bit integer to the buffer, in network byte order.
+   *
+   * @param value The integer to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeUint32(uint32_t value);
+
+  /**
+   * @brief Appends a 64 bit integer to the buffer, in network byte order.
+   *
+   * @param value The integer to append.
+   * @return The buffer.
+   */
+  PacketBuffer &writeUint64(uint64_t value);
+
+  /**
+   * @brief Overwrites a 16 bit integer written before, in network byte order.
+   *
+   * @param offset The offset of the integer in the buffer.
+   * @param value The new value of the integer.
+   */
+  void patchUint16(size_t offset, uint16_t value);
+
+  /**
+   * @brief Gets the number of bytes written so far.
+   *
+   * @return The number of bytes.
+   */
+  size_t length() const { return bytes.length(); }
+
+  /**
+   * @brief Gets the bytes written so far.
+   *
+   * @return A view of the bytes, valid until the buffer is changed.
+   */
+  std::string_view view() const { return bytes; }
+};
+
+#endif
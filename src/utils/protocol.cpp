@@ -1,8 +1,14 @@
 #include "protocol.hpp"
+#include "io_counters.hpp"
+#include "tokenizer.hpp"
+#include "tracer.hpp"
 
+#include <poll.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <cstring>
 #include <fstream>
@@ -109,11 +115,183 @@ std::string UdpPacket::readTime(std::stringstream &buffer) {
   return date + " " + time;
 }
 
-std::stringstream LoginRequest::serialize() {
-  std::stringstream buffer;
-  buffer << LoginRequest::ID << " " << this->userID << " " << this->password
-         << std::endl;
-  return buffer;
+void UdpPacket::readChar(std::string_view &buffer, char chr) {
+  if (buffer.empty() || buffer.front() != chr) {
+    throw InvalidPacketException();
+  }
+  buffer.remove_prefix(1);
+}
+
+void UdpPacket::readSpace(std::string_view &buffer) { readChar(buffer, ' '); }
+
+void UdpPacket::readPacketDelimiter(std::string_view &buffer) {
+  readChar(buffer, '\n');
+  if (!buffer.empty()) {
+    throw InvalidPacketException();
+  }
+}
+
+std::string_view UdpPacket::readString(std::string_view &buffer,
+                                       uint32_t max_len) {
+  size_t i = find_delimiter(buffer, max_len);
+  if (i == buffer.length() && i < max_len) { // ran out before a delimiter
+    throw InvalidPacketException();
+  }
+  std::string_view str = buffer.substr(0, i);
+  buffer.remove_prefix(i);
+  return str;
+}
+
+/**
+ * @brief Consumes a number of bytes from the front of a binary packet.
+ *
+ * @param buffer The buffer to read from.
+ * @param length The number of bytes to read.
+ * @return The bytes that were read, pointing into the buffer.
+ */
+static std::string_view consumeBytes(std::string_view &buffer, size_t length) {
+  if (buffer.length() < length) {
+    throw InvalidPacketException();
+  }
+  std::string_view bytes = buffer.substr(0, length);
+  buffer.remove_prefix(length);
+  return bytes;
+}
+
+void UdpPacket::readBinaryPacketId(std::string_view &buffer, const char *id) {
+  if (buffer.length() < PACKET_ID_LEN ||
+      buffer.substr(0, PACKET_ID_LEN) != std::string_view(id)) {
+    throw UnexpectedPacketException();
+  }
+  buffer.remove_prefix(PACKET_ID_LEN);
+}
+
+uint8_t UdpPacket::readUint8(std::string_view &buffer) {
+  return (uint8_t)consumeBytes(buffer, 1)[0];
+}
+
+uint16_t UdpPacket::readUint16(std::string_view &buffer) {
+  std::string_view bytes = consumeBytes(buffer, 2);
+  return (uint16_t)((uint8_t)bytes[0] << 8 | (uint8_t)bytes[1]);
+}
+
+uint32_t UdpPacket::readUint32(std::string_view &buffer) {
+  uint32_t high = readUint16(buffer);
+  return high << 16 | readUint16(buffer);
+}
+
+uint64_t UdpPacket::readUint64(std::string_view &buffer) {
+  uint64_t high = readUint32(buffer);
+  return high << 32 | readUint32(buffer);
+}
+
+uint8_t UdpPacket::readBinaryStatus(std::string_view &buffer, uint8_t max) {
+  uint8_t status = readUint8(buffer);
+  if (status > max) {
+    throw InvalidPacketException();
+  }
+  return status;
+}
+
+std::string_view UdpPacket::readShortString(std::string_view &buffer,
+                                            uint8_t max_len) {
+  uint8_t length = readUint8(buffer);
+  if (length > max_len) {
+    throw InvalidPacketException();
+  }
+  return consumeBytes(buffer, length);
+}
+
+/**
+ * @brief Formats a numeric ID in its text form, padded with zeros.
+ *
+ * @param value The value of the ID, already checked to fit.
+ * @param length The number of digits of the ID.
+ * @return The ID, in its text form.
+ */
+static std::string formatNumericID(uint32_t value, size_t length) {
+  std::string id(length, '0');
+  for (size_t i = length; i > 0 && value > 0; i--, value /= 10) {
+    id[i - 1] = (char)('0' + value % 10);
+  }
+  return id;
+}
+
+std::string UdpPacket::readBinaryUserID(std::string_view &buffer) {
+  uint32_t userID = readUint32(buffer);
+  if (userID > USER_ID_MAX) {
+    throw InvalidPacketException();
+  }
+  return formatNumericID(userID, USER_ID_LENGTH);
+}
+
+std::string UdpPacket::readBinaryAuctionID(std::string_view &buffer) {
+  uint16_t auctionID = readUint16(buffer);
+  if (auctionID > AUCTION_ID_MAX) {
+    throw InvalidPacketException();
+  }
+  return formatNumericID(auctionID, AUCTION_ID_LENGTH);
+}
+
+void UdpPacket::readBinaryEnd(std::string_view buffer) {
+  if (!buffer.empty()) {
+    throw InvalidPacketException();
+  }
+}
+
+void UdpPacket::writeShortString(PacketBuffer &buffer, std::string_view str) {
+  if (str.length() > UINT8_MAX) {
+    throw PacketSerializationException();
+  }
+  buffer.writeUint8((uint8_t)str.length()).write(str);
+}
+
+/**
+ * @brief Parses the text form of a numeric ID.
+ *
+ * @param id The ID, in its text form.
+ * @param length The number of digits of the ID.
+ * @return The value of the ID.
+ */
+static uint32_t parseNumericID(const std::string &id, size_t length) {
+  uint32_t value = 0;
+  if (id.length() != length ||
+      std::from_chars(id.data(), id.data() + id.length(), value).ptr !=
+          id.data() + id.length()) {
+    throw PacketSerializationException();
+  }
+  return value;
+}
+
+void UdpPacket::writeBinaryUserID(PacketBuffer &buffer,
+                                  const std::string &userID) {
+  buffer.writeUint32(parseNumericID(userID, USER_ID_LENGTH));
+}
+
+void UdpPacket::writeBinaryAuctionID(PacketBuffer &buffer,
+                                     const std::string &auctionID) {
+  buffer.writeUint16((uint16_t)parseNumericID(auctionID, AUCTION_ID_LENGTH));
+}
+
+void UdpPacket::serializeBinary(PacketBuffer &buffer) {
+  (void)buffer;
+  throw InvalidPacketException();
+}
+
+void UdpPacket::deserializeBinary(std::string_view buffer) {
+  (void)buffer;
+  throw InvalidPacketException();
+}
+
+std::stringstream UdpPacket::serialize() {
+  PacketBuffer buffer;
+  serialize(buffer);
+  return std::stringstream(std::string(buffer.view()));
+}
+
+void LoginRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(LoginRequest::ID).writeChar(' ').write(userID).writeChar(' ');
+  buffer.write(password).writeChar('\n');
 }
 
 void LoginRequest::deserialize(std::stringstream &buffer) {
@@ -126,23 +304,29 @@ void LoginRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream LoginResponse::serialize() {
-  std::stringstream buffer;
-  buffer << LoginResponse::ID << " ";
+void LoginRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  password = readString(buffer, 8);
+  readPacketDelimiter(buffer);
+}
+
+void LoginResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(LoginResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
+    buffer.write("OK");
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == REG) {
-    buffer << "REG";
+    buffer.write("REG");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void LoginResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -163,11 +347,9 @@ void LoginResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream LogoutRequest::serialize() {
-  std::stringstream buffer;
-  buffer << LogoutRequest::ID << " " << this->userID << " " << this->password
-         << std::endl;
-  return buffer;
+void LogoutRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(LogoutRequest::ID).writeChar(' ').write(userID).writeChar(' ');
+  buffer.write(password).writeChar('\n');
 }
 
 void LogoutRequest::deserialize(std::stringstream &buffer) {
@@ -180,23 +362,29 @@ void LogoutRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream LogoutResponse::serialize() {
-  std::stringstream buffer;
-  buffer << LogoutResponse::ID << " ";
+void LogoutRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  password = readString(buffer, 8);
+  readPacketDelimiter(buffer);
+}
+
+void LogoutResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(LogoutResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
+    buffer.write("OK");
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == UNR) {
-    buffer << "UNR";
+    buffer.write("UNR");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void LogoutResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -217,11 +405,9 @@ void LogoutResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream UnregisterRequest::serialize() {
-  std::stringstream buffer;
-  buffer << UnregisterRequest::ID << " " << this->userID << " "
-         << this->password << std::endl;
-  return buffer;
+void UnregisterRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(UnregisterRequest::ID).writeChar(' ').write(userID);
+  buffer.writeChar(' ').write(password).writeChar('\n');
 }
 
 void UnregisterRequest::deserialize(std::stringstream &buffer) {
@@ -234,23 +420,29 @@ void UnregisterRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream UnregisterResponse::serialize() {
-  std::stringstream buffer;
-  buffer << UnregisterResponse::ID << " ";
+void UnregisterRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  password = readString(buffer, 8);
+  readPacketDelimiter(buffer);
+}
+
+void UnregisterResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(UnregisterResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
+    buffer.write("OK");
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == UNR) {
-    buffer << "UNR";
+    buffer.write("UNR");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void UnregisterResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -271,10 +463,9 @@ void UnregisterResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream ListUserAuctionsRequest::serialize() {
-  std::stringstream buffer;
-  buffer << ListUserAuctionsRequest::ID << " " << this->userID << std::endl;
-  return buffer;
+void ListUserAuctionsRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsRequest::ID).writeChar(' ').write(userID);
+  buffer.writeChar('\n');
 }
 
 void ListUserAuctionsRequest::deserialize(std::stringstream &buffer) {
@@ -284,26 +475,31 @@ void ListUserAuctionsRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream ListUserAuctionsResponse::serialize() {
-  std::stringstream buffer;
-  buffer << ListUserAuctionsResponse::ID << " ";
+void ListUserAuctionsRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserAuctionsResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
-    for (auto auction : auctions) {
-      buffer << " " << auction.first << " " << std::to_string(auction.second);
+    buffer.write("OK");
+    for (const auto &auction : auctions) {
+      buffer.writeChar(' ').write(auction.first).writeChar(' ');
+      buffer.writeInt(auction.second);
     }
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == NLG) {
-    buffer << "NLG";
+    buffer.write("NLG");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void ListUserAuctionsResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -332,10 +528,9 @@ void ListUserAuctionsResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream ListUserBidsRequest::serialize() {
-  std::stringstream buffer;
-  buffer << ListUserBidsRequest::ID << " " << this->userID << std::endl;
-  return buffer;
+void ListUserBidsRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsRequest::ID).writeChar(' ').write(userID);
+  buffer.writeChar('\n');
 }
 
 void ListUserBidsRequest::deserialize(std::stringstream &buffer) {
@@ -345,26 +540,31 @@ void ListUserBidsRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream ListUserBidsResponse::serialize() {
-  std::stringstream buffer;
-  buffer << ListUserBidsResponse::ID << " ";
+void ListUserBidsRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserBidsResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
-    for (auto auction : auctions) {
-      buffer << " " << auction.first << " " << std::to_string(auction.second);
+    buffer.write("OK");
+    for (const auto &auction : auctions) {
+      buffer.writeChar(' ').write(auction.first).writeChar(' ');
+      buffer.writeInt(auction.second);
     }
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == NLG) {
-    buffer << "NLG";
+    buffer.write("NLG");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void ListUserBidsResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -393,10 +593,8 @@ void ListUserBidsResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream ListAuctionsRequest::serialize() {
-  std::stringstream buffer;
-  buffer << ListAuctionsRequest::ID << std::endl;
-  return buffer;
+void ListAuctionsRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsRequest::ID).writeChar('\n');
 }
 
 void ListAuctionsRequest::deserialize(std::stringstream &buffer) {
@@ -404,27 +602,27 @@ void ListAuctionsRequest::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 }
 
-std::stringstream ListAuctionsResponse::serialize() {
-  std::stringstream buffer;
-  buffer << ListAuctionsResponse::ID << " ";
+void ListAuctionsRequest::deserialize(std::string_view buffer) {
+  readPacketDelimiter(buffer);
+}
 
+void ListAuctionsResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsResponse::ID).writeChar(' ');
   if (status == OK) {
-    buffer << "OK";
-    for (auto auction : this->auctions) {
-      buffer << " " << auction.first << " " << std::to_string(auction.second);
+    buffer.write("OK");
+    for (const auto &auction : auctions) {
+      buffer.writeChar(' ').write(auction.first).writeChar(' ');
+      buffer.writeInt(auction.second);
     }
   } else if (status == NOK) {
-    buffer << "NOK";
+    buffer.write("NOK");
   } else if (status == ERR) {
-    buffer << "ERR";
+    buffer.write("ERR");
   } else {
-    std::cout << "InvalidPacketException" << std::endl;
     throw InvalidPacketException();
   }
-
-  buffer << std::endl;
-  return buffer;
-};
+  buffer.writeChar('\n');
+}
 
 void ListAuctionsResponse::deserialize(std::stringstream &buffer) {
   buffer >> std::noskipws;
@@ -451,115 +649,984 @@ void ListAuctionsResponse::deserialize(std::stringstream &buffer) {
   readPacketDelimiter(buffer);
 };
 
-std::stringstream ShowRecordRequest::serialize() {
-  std::stringstream buffer;
-  buffer << ShowRecordRequest::ID << " " << this->auctionID << std::endl;
-  return buffer;
+/**
+ * @brief Checks that a listing cursor is an auction ID, or the start cursor.
+ *
+ * @param cursor The cursor to check.
+ */
+static void validateCursor(std::string_view cursor) {
+  if (cursor.length() != AUCTION_ID_LENGTH) {
+    throw InvalidPacketException();
+  }
+  for (char c : cursor) {
+    if (c < '0' || c > '9') {
+      throw InvalidPacketException();
+    }
+  }
+}
+
+void ListAuctionsPageRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsPageRequest::ID).writeChar(' ').write(cursor);
+  buffer.writeChar('\n');
+}
+
+void ListAuctionsPageRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListAuctionsPageRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserAuctionsPageRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsPageRequest::ID).writeChar(' ').write(userID);
+  buffer.writeChar(' ').write(cursor).writeChar('\n');
+}
+
+void ListUserAuctionsPageRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserAuctionsPageRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserBidsPageRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsPageRequest::ID).writeChar(' ').write(userID);
+  buffer.writeChar(' ').write(cursor).writeChar('\n');
+}
+
+void ListUserBidsPageRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListUserBidsPageRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  userID = readString(buffer, 6);
+  readSpace(buffer);
+  cursor = readString(buffer, 3);
+  validateCursor(cursor);
+  readPacketDelimiter(buffer);
+}
+
+void ListingPageResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(packetID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK ").write(nextCursor);
+    for (const auto &auction : auctions) {
+      buffer.writeChar(' ').write(auction.first).writeChar(' ');
+      buffer.writeInt(auction.second);
+    }
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == NLG) {
+    buffer.write("NLG");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+}
+
+void ListingPageResponse::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  // the same response may be read again for the following page
+  nextCursor = LIST_CURSOR_START;
+  auctions.clear();
+  readPacketId(buffer, packetID);
+  readSpace(buffer);
+  auto status_str = readString(buffer, 3);
+  if (status_str == "OK") {
+    status = OK;
+    readSpace(buffer);
+    nextCursor = readString(buffer, 3);
+    validateCursor(nextCursor);
+
+    while (buffer.peek() != '\n') {
+      readSpace(buffer);
+      auto auction_id = readString(buffer, 3);
+      readSpace(buffer);
+      auto state = readInt(buffer);
+      auctions.push_back(std::make_pair(auction_id, (uint8_t)state));
+    }
+  } else if (status_str == "NOK") {
+    status = NOK;
+  } else if (status_str == "NLG") {
+    status = NLG;
+  } else if (status_str == "ERR") {
+    status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ShowRecordRequest::ID).writeChar(' ').write(auctionID);
+  buffer.writeChar('\n');
+}
+
+void ShowRecordRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  auctionID = readString(buffer, 3);
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  auctionID = readString(buffer, 3);
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ShowRecordResponse::ID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK ").write(hostUID).writeChar(' ').write(auctionName);
+    buffer.writeChar(' ').write(assetFileName).writeChar(' ');
+    buffer.writeInt(startValue).writeChar(' ').write(startDate).writeChar(' ');
+    buffer.writeInt(timeActive);
+    for (const auto &bid : bids) {
+      buffer.write(" B ").write(std::get<0>(bid)).writeChar(' ');
+      buffer.writeInt(std::get<1>(bid)).writeChar(' ').write(std::get<2>(bid));
+      buffer.writeChar(' ').writeInt(std::get<3>(bid));
+    }
+    if (end.first != "") {
+      buffer.write(" E ").write(end.first).writeChar(' ').writeInt(end.second);
+    }
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+}
+
+void ShowRecordResponse::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readPacketId(buffer, ShowRecordResponse::ID);
+  readSpace(buffer);
+  auto status_str = readString(buffer, 3);
+  if (status_str == "OK") {
+    status = OK;
+    readSpace(buffer);
+    auto user_id = readString(buffer, 6);
+    hostUID = user_id;
+    readSpace(buffer);
+    auto auction_name = readString(buffer, 10);
+    auctionName = auction_name;
+    readSpace(buffer);
+    auto asset_filename = readString(buffer, 24);
+    assetFileName = asset_filename;
+    readSpace(buffer);
+    auto start_price = readInt(buffer);
+    startValue = start_price;
+    readSpace(buffer);
+    auto start_date = readTime(buffer);
+    startDate = start_date;
+    readSpace(buffer);
+    auto active_time = readInt(buffer);
+    timeActive = active_time;
+
+    while (buffer.peek() != '\n') {
+      readSpace(buffer);
+      char b_or_e = readChar(buffer);
+      if (b_or_e == 'B') {
+        readSpace(buffer);
+        auto bidder_id = readString(buffer, 6);
+        readSpace(buffer);
+        auto bid_value = readInt(buffer);
+        readSpace(buffer);
+        auto bid_date = readTime(buffer);
+        readSpace(buffer);
+        auto bid_sec_time = readInt(buffer);
+        bids.push_back(
+            std::make_tuple(bidder_id, bid_value, bid_date, bid_sec_time));
+      } else if (b_or_e == 'E') {
+        readSpace(buffer);
+        auto end_date_time = readTime(buffer);
+        readSpace(buffer);
+        auto end_sec_time = readInt(buffer);
+        end = std::make_pair(end_date_time, end_sec_time);
+      } else {
+        continue;
+      }
+    }
+  } else if (status_str == "NOK") {
+    status = NOK;
+  } else if (status_str == "ERR") {
+    status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(buffer);
+};
+
+/**
+ * @brief Parses the decimal text form of a catalog or record version.
+ *
+ * @param digits The version, in its text form.
+ * @return The value of the version.
+ */
+static uint64_t parseVersion(std::string_view digits) {
+  uint64_t version = 0;
+  if (digits.empty() ||
+      std::from_chars(digits.data(), digits.data() + digits.length(), version)
+              .ptr != digits.data() + digits.length()) {
+    throw InvalidPacketException();
+  }
+  return version;
+}
+
+void ListAuctionsDeltaRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsDeltaRequest::ID).writeChar(' ');
+  buffer.writeInt64(version).writeChar('\n');
+}
+
+void ListAuctionsDeltaRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  version = parseVersion(readString(buffer, 20));
+  readPacketDelimiter(buffer);
+}
+
+void ListAuctionsDeltaRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  version = parseVersion(readString(buffer, 20));
+  readPacketDelimiter(buffer);
+}
+
+void ListAuctionsDeltaResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsDeltaResponse::ID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK ").writeInt64(version);
+    for (const auto &auction : auctions) {
+      buffer.writeChar(' ').write(auction.first).writeChar(' ');
+      buffer.writeInt(auction.second);
+    }
+  } else if (status == NMD) {
+    buffer.write("NMD ").writeInt64(version);
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+}
+
+void ListAuctionsDeltaResponse::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readPacketId(buffer, ListAuctionsDeltaResponse::ID);
+  readSpace(buffer);
+  auto status_str = readString(buffer, 3);
+  if (status_str == "OK") {
+    status = OK;
+    readSpace(buffer);
+    version = parseVersion(readString(buffer, 20));
+
+    while (buffer.peek() != '\n') {
+      readSpace(buffer);
+      auto auction_id = readString(buffer, 3);
+      readSpace(buffer);
+      auto state = readInt(buffer);
+      auctions.push_back(std::make_pair(auction_id, (uint8_t)state));
+    }
+  } else if (status_str == "NMD") {
+    status = NMD;
+    readSpace(buffer);
+    version = parseVersion(readString(buffer, 20));
+  } else if (status_str == "NOK") {
+    status = NOK;
+  } else if (status_str == "ERR") {
+    status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordDeltaRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(ShowRecordDeltaRequest::ID).writeChar(' ').write(auctionID);
+  buffer.writeChar(' ').writeInt64(version).writeChar('\n');
+}
+
+void ShowRecordDeltaRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readSpace(buffer);
+  auctionID = readString(buffer, 3);
+  readSpace(buffer);
+  version = parseVersion(readString(buffer, 20));
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordDeltaRequest::deserialize(std::string_view buffer) {
+  readSpace(buffer);
+  auctionID = readString(buffer, 3);
+  readSpace(buffer);
+  version = parseVersion(readString(buffer, 20));
+  readPacketDelimiter(buffer);
+}
+
+void ShowRecordDeltaResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(ShowRecordDeltaResponse::ID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK ").writeInt64(version);
+    for (const auto &bid : bids) {
+      buffer.write(" B ").write(std::get<0>(bid)).writeChar(' ');
+      buffer.writeInt(std::get<1>(bid)).writeChar(' ').write(std::get<2>(bid));
+      buffer.writeChar(' ').writeInt(std::get<3>(bid));
+    }
+    if (end.first != "") {
+      buffer.write(" E ").write(end.first).writeChar(' ').writeInt(end.second);
+    }
+  } else if (status == NMD) {
+    buffer.write("NMD ").writeInt64(version);
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+}
+
+void ShowRecordDeltaResponse::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readPacketId(buffer, ShowRecordDeltaResponse::ID);
+  readSpace(buffer);
+  auto status_str = readString(buffer, 3);
+  if (status_str == "OK") {
+    status = OK;
+    readSpace(buffer);
+    version = parseVersion(readString(buffer, 20));
+
+    while (buffer.peek() != '\n') {
+      readSpace(buffer);
+      char b_or_e = readChar(buffer);
+      if (b_or_e == 'B') {
+        readSpace(buffer);
+        auto bidder_id = readString(buffer, 6);
+        readSpace(buffer);
+        auto bid_value = readInt(buffer);
+        readSpace(buffer);
+        auto bid_date = readTime(buffer);
+        readSpace(buffer);
+        auto bid_sec_time = readInt(buffer);
+        bids.push_back(
+            std::make_tuple(bidder_id, bid_value, bid_date, bid_sec_time));
+      } else if (b_or_e == 'E') {
+        readSpace(buffer);
+        auto end_date_time = readTime(buffer);
+        readSpace(buffer);
+        auto end_sec_time = readInt(buffer);
+        end = std::make_pair(end_date_time, end_sec_time);
+      } else {
+        throw InvalidPacketException();
+      }
+    }
+  } else if (status_str == "NMD") {
+    status = NMD;
+    readSpace(buffer);
+    version = parseVersion(readString(buffer, 20));
+  } else if (status_str == "NOK") {
+    status = NOK;
+  } else if (status_str == "ERR") {
+    status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(buffer);
+}
+
+void StatsRequest::serialize(PacketBuffer &buffer) {
+  buffer.write(StatsRequest::ID).writeChar('\n');
+}
+
+void StatsRequest::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readPacketDelimiter(buffer);
+}
+
+void StatsRequest::deserialize(std::string_view buffer) {
+  readPacketDelimiter(buffer);
+}
+
+void StatsResponse::serialize(PacketBuffer &buffer) {
+  buffer.write(StatsResponse::ID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK ").writeInt((uint32_t)report.length()).writeChar(' ');
+    buffer.write(report);
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+}
+
+void StatsResponse::deserialize(std::stringstream &buffer) {
+  buffer >> std::noskipws;
+  readPacketId(buffer, StatsResponse::ID);
+  readSpace(buffer);
+  auto status_str = readString(buffer, 3);
+  if (status_str == "OK") {
+    status = OK;
+    readSpace(buffer);
+    uint32_t length = readInt(buffer);
+    readSpace(buffer);
+    report.resize(length);
+    buffer.read(report.data(), (std::streamsize)length);
+    if ((uint32_t)buffer.gcount() != length) {
+      throw InvalidPacketException();
+    }
+  } else if (status_str == "NOK") {
+    status = NOK;
+  } else if (status_str == "ERR") {
+    status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(buffer);
+}
+
+void ErrorUdpPacket::serialize(PacketBuffer &buffer) {
+  buffer.write(ErrorUdpPacket::ID).writeChar('\n');
+}
+
+void ErrorUdpPacket::deserialize(std::stringstream &buffer) { (void)buffer; };
+
+// Binary encoding
+void LoginRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(LoginRequest::ID);
+  writeBinaryUserID(buffer, userID);
+  if (password.length() != PASSWORD_LENGTH) {
+    throw PacketSerializationException();
+  }
+  buffer.write(password);
+}
+
+void LoginRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  password = consumeBytes(buffer, PASSWORD_LENGTH);
+  readBinaryEnd(buffer);
+}
+
+void LoginResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(LoginResponse::ID).writeUint8((uint8_t)status);
+}
+
+void LoginResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, LoginResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  readBinaryEnd(buffer);
+}
+
+void LogoutRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(LogoutRequest::ID);
+  writeBinaryUserID(buffer, userID);
+  if (password.length() != PASSWORD_LENGTH) {
+    throw PacketSerializationException();
+  }
+  buffer.write(password);
+}
+
+void LogoutRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  password = consumeBytes(buffer, PASSWORD_LENGTH);
+  readBinaryEnd(buffer);
+}
+
+void LogoutResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(LogoutResponse::ID).writeUint8((uint8_t)status);
+}
+
+void LogoutResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, LogoutResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  readBinaryEnd(buffer);
+}
+
+void UnregisterRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(UnregisterRequest::ID);
+  writeBinaryUserID(buffer, userID);
+  if (password.length() != PASSWORD_LENGTH) {
+    throw PacketSerializationException();
+  }
+  buffer.write(password);
+}
+
+void UnregisterRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  password = consumeBytes(buffer, PASSWORD_LENGTH);
+  readBinaryEnd(buffer);
+}
+
+void UnregisterResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(UnregisterResponse::ID).writeUint8((uint8_t)status);
+}
+
+void UnregisterResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, UnregisterResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  readBinaryEnd(buffer);
+}
+
+void UdpPacket::writeBinaryAuctions(
+    PacketBuffer &buffer,
+    const std::vector<std::pair<std::string, uint8_t>> &auctions) {
+  buffer.writeUint16((uint16_t)auctions.size());
+  for (const auto &auction : auctions) {
+    writeBinaryAuctionID(buffer, auction.first);
+    buffer.writeUint8(auction.second);
+  }
+}
+
+void UdpPacket::readBinaryAuctions(
+    std::string_view &buffer,
+    std::vector<std::pair<std::string, uint8_t>> &auctions) {
+  uint16_t count = readUint16(buffer);
+  for (uint16_t i = 0; i < count; i++) {
+    std::string auctionID = readBinaryAuctionID(buffer);
+    auctions.push_back(std::make_pair(auctionID, readUint8(buffer)));
+  }
+}
+
+void ListUserAuctionsRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsRequest::ID);
+  writeBinaryUserID(buffer, userID);
+}
+
+void ListUserAuctionsRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListUserAuctionsResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK) {
+    writeBinaryAuctions(buffer, auctions);
+  }
+}
+
+void ListUserAuctionsResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ListUserAuctionsResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    readBinaryAuctions(buffer, auctions);
+  }
+  readBinaryEnd(buffer);
+}
+
+void ListUserBidsRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsRequest::ID);
+  writeBinaryUserID(buffer, userID);
+}
+
+void ListUserBidsRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListUserBidsResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK) {
+    writeBinaryAuctions(buffer, auctions);
+  }
+}
+
+void ListUserBidsResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ListUserBidsResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    readBinaryAuctions(buffer, auctions);
+  }
+  readBinaryEnd(buffer);
+}
+
+void ListAuctionsRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsRequest::ID);
+}
+
+void ListAuctionsRequest::deserializeBinary(std::string_view buffer) {
+  readBinaryEnd(buffer);
+}
+
+void ListAuctionsResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK) {
+    writeBinaryAuctions(buffer, auctions);
+  }
+}
+
+void ListAuctionsResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ListAuctionsResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    readBinaryAuctions(buffer, auctions);
+  }
+  readBinaryEnd(buffer);
+}
+
+void ListAuctionsPageRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsPageRequest::ID);
+  writeBinaryAuctionID(buffer, cursor);
+}
+
+void ListAuctionsPageRequest::deserializeBinary(std::string_view buffer) {
+  cursor = readBinaryAuctionID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListUserAuctionsPageRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserAuctionsPageRequest::ID);
+  writeBinaryUserID(buffer, userID);
+  writeBinaryAuctionID(buffer, cursor);
+}
+
+void ListUserAuctionsPageRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  cursor = readBinaryAuctionID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListUserBidsPageRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListUserBidsPageRequest::ID);
+  writeBinaryUserID(buffer, userID);
+  writeBinaryAuctionID(buffer, cursor);
+}
+
+void ListUserBidsPageRequest::deserializeBinary(std::string_view buffer) {
+  userID = readBinaryUserID(buffer);
+  cursor = readBinaryAuctionID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListingPageResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(packetID).writeUint8((uint8_t)status);
+  if (status == OK) {
+    writeBinaryAuctionID(buffer, nextCursor);
+    writeBinaryAuctions(buffer, auctions);
+  }
+}
+
+void ListingPageResponse::deserializeBinary(std::string_view buffer) {
+  nextCursor = LIST_CURSOR_START;
+  auctions.clear();
+  readBinaryPacketId(buffer, packetID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    nextCursor = readBinaryAuctionID(buffer);
+    readBinaryAuctions(buffer, auctions);
+  }
+  readBinaryEnd(buffer);
+}
+
+void ShowRecordRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ShowRecordRequest::ID);
+  writeBinaryAuctionID(buffer, auctionID);
+}
+
+void ShowRecordRequest::deserializeBinary(std::string_view buffer) {
+  auctionID = readBinaryAuctionID(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ShowRecordResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ShowRecordResponse::ID).writeUint8((uint8_t)status);
+  if (status != OK) {
+    return;
+  }
+  writeBinaryUserID(buffer, hostUID);
+  writeShortString(buffer, auctionName);
+  writeShortString(buffer, assetFileName);
+  buffer.writeUint32(startValue);
+  writeShortString(buffer, startDate);
+  buffer.writeUint32(timeActive);
+  buffer.writeUint16((uint16_t)bids.size());
+  for (const auto &bid : bids) {
+    writeBinaryUserID(buffer, std::get<0>(bid));
+    buffer.writeUint32(std::get<1>(bid));
+    writeShortString(buffer, std::get<2>(bid));
+    buffer.writeUint32(std::get<3>(bid));
+  }
+  // a closed auction ends with its end date-time and duration
+  buffer.writeUint8(end.first != "");
+  if (end.first != "") {
+    writeShortString(buffer, end.first);
+    buffer.writeUint32(end.second);
+  }
+}
+
+void ShowRecordResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ShowRecordResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    hostUID = readBinaryUserID(buffer);
+    auctionName = readShortString(buffer, ASSET_NAME_MAX);
+    assetFileName = readShortString(buffer, FILENAME_MAX_LENGTH);
+    startValue = readUint32(buffer);
+    startDate = readShortString(buffer, DATE_TIME_LENGTH);
+    timeActive = readUint32(buffer);
+    uint16_t count = readUint16(buffer);
+    for (uint16_t i = 0; i < count; i++) {
+      std::string bidderID = readBinaryUserID(buffer);
+      uint32_t bidValue = readUint32(buffer);
+      std::string bidDate(readShortString(buffer, DATE_TIME_LENGTH));
+      bids.push_back(
+          std::make_tuple(bidderID, bidValue, bidDate, readUint32(buffer)));
+    }
+    if (readUint8(buffer) != 0) {
+      std::string endDate(readShortString(buffer, DATE_TIME_LENGTH));
+      end = std::make_pair(endDate, readUint32(buffer));
+    }
+  }
+  readBinaryEnd(buffer);
+}
+
+void ListAuctionsDeltaRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsDeltaRequest::ID).writeUint64(version);
+}
+
+void ListAuctionsDeltaRequest::deserializeBinary(std::string_view buffer) {
+  version = readUint64(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ListAuctionsDeltaResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ListAuctionsDeltaResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK || status == NMD) {
+    buffer.writeUint64(version);
+  }
+  if (status == OK) {
+    writeBinaryAuctions(buffer, auctions);
+  }
+}
+
+void ListAuctionsDeltaResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ListAuctionsDeltaResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK || status == NMD) {
+    version = readUint64(buffer);
+  }
+  if (status == OK) {
+    readBinaryAuctions(buffer, auctions);
+  }
+  readBinaryEnd(buffer);
+}
+
+void ShowRecordDeltaRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ShowRecordDeltaRequest::ID);
+  writeBinaryAuctionID(buffer, auctionID);
+  buffer.writeUint64(version);
+}
+
+void ShowRecordDeltaRequest::deserializeBinary(std::string_view buffer) {
+  auctionID = readBinaryAuctionID(buffer);
+  version = readUint64(buffer);
+  readBinaryEnd(buffer);
+}
+
+void ShowRecordDeltaResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ShowRecordDeltaResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK || status == NMD) {
+    buffer.writeUint64(version);
+  }
+  if (status != OK) {
+    return;
+  }
+  buffer.writeUint16((uint16_t)bids.size());
+  for (const auto &bid : bids) {
+    writeBinaryUserID(buffer, std::get<0>(bid));
+    buffer.writeUint32(std::get<1>(bid));
+    writeShortString(buffer, std::get<2>(bid));
+    buffer.writeUint32(std::get<3>(bid));
+  }
+  buffer.writeUint8(end.first != "");
+  if (end.first != "") {
+    writeShortString(buffer, end.first);
+    buffer.writeUint32(end.second);
+  }
+}
+
+void ShowRecordDeltaResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ShowRecordDeltaResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK || status == NMD) {
+    version = readUint64(buffer);
+  }
+  if (status == OK) {
+    uint16_t count = readUint16(buffer);
+    for (uint16_t i = 0; i < count; i++) {
+      std::string bidderID = readBinaryUserID(buffer);
+      uint32_t bidValue = readUint32(buffer);
+      std::string bidDate(readShortString(buffer, DATE_TIME_LENGTH));
+      bids.push_back(
+          std::make_tuple(bidderID, bidValue, bidDate, readUint32(buffer)));
+    }
+    if (readUint8(buffer) != 0) {
+      std::string endDate(readShortString(buffer, DATE_TIME_LENGTH));
+      end = std::make_pair(endDate, readUint32(buffer));
+    }
+  }
+  readBinaryEnd(buffer);
+}
+
+void StatsRequest::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(StatsRequest::ID);
+}
+
+void StatsRequest::deserializeBinary(std::string_view buffer) {
+  readBinaryEnd(buffer);
+}
+
+void StatsResponse::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(StatsResponse::ID).writeUint8((uint8_t)status);
+  if (status == OK) {
+    if (report.length() > UINT16_MAX) {
+      throw PacketSerializationException();
+    }
+    buffer.writeUint16((uint16_t)report.length()).write(report);
+  }
+}
+
+void StatsResponse::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, StatsResponse::ID);
+  status = static_cast<enum status>(readBinaryStatus(buffer, ERR));
+  if (status == OK) {
+    report = std::string(consumeBytes(buffer, readUint16(buffer)));
+  }
+  readBinaryEnd(buffer);
+}
+
+void ErrorUdpPacket::serializeBinary(PacketBuffer &buffer) {
+  buffer.write(ErrorUdpPacket::ID);
+}
+
+void ErrorUdpPacket::deserializeBinary(std::string_view buffer) {
+  readBinaryPacketId(buffer, ErrorUdpPacket::ID);
+  readBinaryEnd(buffer);
+}
+
+// TCP
+// the deadline of the request being read by the thread, or max if none
+static thread_local std::chrono::steady_clock::time_point readDeadline =
+    std::chrono::steady_clock::time_point::max();
+static thread_local bool readDeadlineMissed = false;
+// what the upload of the request is charged to, and what was not charged yet
+static thread_local std::function<bool(size_t)> uploadCharge;
+static thread_local size_t uploadUncharged = 0;
+static thread_local bool uploadRefused = false;
+
+ReadDeadline::ReadDeadline(uint32_t seconds,
+                           std::function<bool(size_t)> charge) {
+  readDeadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  readDeadlineMissed = false;
+  uploadCharge = std::move(charge);
+  uploadUncharged = 0;
+  uploadRefused = false;
+}
+
+ReadDeadline::~ReadDeadline() {
+  readDeadline = std::chrono::steady_clock::time_point::max();
+  uploadCharge = nullptr;
+}
+
+bool ReadDeadline::missed() const { return readDeadlineMissed; }
+
+bool ReadDeadline::refused() const { return uploadRefused; }
+
+bool ReadDeadline::active() {
+  return readDeadline != std::chrono::steady_clock::time_point::max();
+}
+
+void ReadDeadline::extendFor(size_t bytes) {
+  if (!active()) {
+    return;
+  }
+  std::chrono::duration<double> upload((double)bytes / TCP_UPLOAD_MIN_RATE);
+  readDeadline +=
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(upload);
 }
 
-void ShowRecordRequest::deserialize(std::stringstream &buffer) {
-  buffer >> std::noskipws;
-  readSpace(buffer);
-  auctionID = readString(buffer, 3);
-  readPacketDelimiter(buffer);
+void ReadDeadline::chargeUpload(size_t bytes) {
+  if (!active() || !uploadCharge) {
+    return;
+  }
+  uploadUncharged += bytes;
+  if (uploadUncharged < TCP_UPLOAD_CHARGE) {
+    return;
+  }
+  size_t charged = uploadUncharged;
+  uploadUncharged = 0;
+  if (!uploadCharge(charged)) {
+    uploadRefused = true;
+    throw UploadRefusedException();
+  }
 }
 
-std::stringstream ShowRecordResponse::serialize() {
-  std::stringstream buffer;
-  buffer << ShowRecordResponse::ID << " ";
-  if (status == OK) {
-    buffer << "OK"
-           << " " << hostUID << " " << auctionName << " " << assetFileName
-           << " " << startValue << " " << startDate << " " << timeActive;
-    for (auto bid : bids) {
-      buffer << " B " << std::get<0>(bid) << " " << std::get<1>(bid) << " "
-             << std::get<2>(bid) << " " << std::get<3>(bid);
-    }
-    if (end.first != "") {
-      buffer << " E " << end.first << " " << end.second;
-    }
-  } else if (status == NOK) {
-    buffer << "NOK";
-  } else if (status == ERR) {
-    buffer << "ERR";
-  } else {
-    throw InvalidPacketException();
+ssize_t ReadDeadline::read(int fd, char *buffer, size_t length) {
+  if (!active()) {
+    return ::read(fd, buffer, length);
   }
-  buffer << std::endl;
-  return buffer;
-};
 
-void ShowRecordResponse::deserialize(std::stringstream &buffer) {
-  buffer >> std::noskipws;
-  readPacketId(buffer, ShowRecordResponse::ID);
-  readSpace(buffer);
-  auto status_str = readString(buffer, 3);
-  if (status_str == "OK") {
-    status = OK;
-    readSpace(buffer);
-    auto user_id = readString(buffer, 6);
-    hostUID = user_id;
-    readSpace(buffer);
-    auto auction_name = readString(buffer, 10);
-    auctionName = auction_name;
-    readSpace(buffer);
-    auto asset_filename = readString(buffer, 24);
-    assetFileName = asset_filename;
-    readSpace(buffer);
-    auto start_price = readInt(buffer);
-    startValue = start_price;
-    readSpace(buffer);
-    auto start_date = readTime(buffer);
-    startDate = start_date;
-    readSpace(buffer);
-    auto active_time = readInt(buffer);
-    timeActive = active_time;
+  while (true) {
+    // the bytes have usually arrived already, so it only waits if they have not
+    ssize_t n = recv(fd, buffer, length, MSG_DONTWAIT);
+    if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      return n;
+    }
 
-    while (buffer.peek() != '\n') {
-      readSpace(buffer);
-      char b_or_e = readChar(buffer);
-      if (b_or_e == 'B') {
-        readSpace(buffer);
-        auto bidder_id = readString(buffer, 6);
-        readSpace(buffer);
-        auto bid_value = readInt(buffer);
-        readSpace(buffer);
-        auto bid_date = readTime(buffer);
-        readSpace(buffer);
-        auto bid_sec_time = readInt(buffer);
-        bids.push_back(
-            std::make_tuple(bidder_id, bid_value, bid_date, bid_sec_time));
-      } else if (b_or_e == 'E') {
-        readSpace(buffer);
-        auto end_date_time = readTime(buffer);
-        readSpace(buffer);
-        auto end_sec_time = readInt(buffer);
-        end = std::make_pair(end_date_time, end_sec_time);
-      } else {
-        continue;
-      }
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(
+        readDeadline - std::chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      readDeadlineMissed = true;
+      throw SlowConnectionException();
     }
-  } else if (status_str == "NOK") {
-    status = NOK;
-  } else if (status_str == "ERR") {
-    status = ERR;
-  } else {
-    throw InvalidPacketException();
+    if (is_exiting) {
+      throw OperationCancelledException();
+    }
+    // wakes up every second, to notice the application shutting down
+    struct pollfd pollFD = {fd, POLLIN, 0};
+    poll(&pollFD, 1, (int)std::min<int64_t>(left.count(), 1000));
   }
-  readPacketDelimiter(buffer);
-};
-
-std::stringstream ErrorUdpPacket::serialize() {
-  std::stringstream buffer;
-  buffer << ErrorUdpPacket::ID << std::endl;
-  return buffer;
-};
-
-void ErrorUdpPacket::deserialize(std::stringstream &buffer) { (void)buffer; };
+}
 
-// TCP
-void TcpPacket::writeString(int fd, const std::string &str) {
-  const char *buffer = str.c_str();
+void TcpPacket::writeString(int fd, std::string_view str) {
+  TraceSpan traceSpan("write");
+  const char *buffer = str.data();
   ssize_t bytes_to_send = (ssize_t)str.length();
   ssize_t bytes_sent = 0;
   while (bytes_sent < bytes_to_send) {
@@ -575,7 +1642,8 @@ void TcpPacket::writeString(int fd, const std::string &str) {
 void TcpPacket::readPacketId(int fd, const char *packet_id) {
   char current_char;
   while (*packet_id != '\0') {
-    if (read(fd, &current_char, 1) != 1 || current_char != *packet_id) {
+    if (ReadDeadline::read(fd, &current_char, 1) != 1 ||
+        current_char != *packet_id) {
       throw UnexpectedPacketException();
     }
     ++packet_id;
@@ -596,7 +1664,7 @@ char TcpPacket::readChar(int fd) {
     delimiter = 0;
     return c;
   }
-  if (read(fd, &c, 1) != 1) {
+  if (ReadDeadline::read(fd, &c, 1) != 1) {
     throw InvalidPacketException();
   }
   return c;
@@ -611,7 +1679,7 @@ std::string TcpPacket::readString(const int fd) {
   char c = 0;
 
   while (!std::iswspace((wint_t)c)) {
-    if (read(fd, &c, 1) != 1) {
+    if (ReadDeadline::read(fd, &c, 1) != 1) {
       throw InvalidPacketException();
     }
     result += c;
@@ -641,8 +1709,9 @@ uint32_t TcpPacket::readInt(const int fd) {
 }
 
 void ErrorTcpPacket::send(int fd) {
-  writeString(fd, ErrorTcpPacket::ID);
-  writeString(fd, "\n");
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(ErrorTcpPacket::ID).writeChar('\n');
+  writeString(fd, buffer.view());
 }
 
 void ErrorTcpPacket::receive(int fd) { (void)fd; }
@@ -675,56 +1744,71 @@ std::string TcpPacket::readAndSaveToFile(const int fd, std::string &file_name,
   if (!file.good()) {
     throw IOException();
   }
+  threadIO.opens++;
 
   size_t remaining_size = file_size;
   size_t to_read;
   ssize_t n;
   char buffer[FILE_BUFFER_LEN];
 
-  while (remaining_size > 0) {
-    fd_set file_descriptors;
-    FD_ZERO(&file_descriptors);
-    FD_SET(fd, &file_descriptors);
-
-    struct timeval timeout;
-    timeout.tv_sec = TCP_READ_TIMEOUT_SECONDS;
-    timeout.tv_usec = 0;
+  try {
+    while (remaining_size > 0) {
+      // the AS reads until its deadline, and has no terminal to cancel from
+      if (!ReadDeadline::active()) {
+        fd_set file_descriptors;
+        FD_ZERO(&file_descriptors);
+        FD_SET(fd, &file_descriptors);
+
+        struct timeval timeout;
+        timeout.tv_sec = TCP_READ_TIMEOUT_SECONDS;
+        timeout.tv_usec = 0;
+
+        int ready_fd = select(std::max(fd, fileno(stdin)) + 1,
+                              &file_descriptors, NULL, NULL, &timeout);
+        if (is_exiting) {
+          std::cout << "Cancelling TCP download, player is shutting down..."
+                    << std::endl;
+          throw OperationCancelledException();
+        }
+        if (ready_fd == -1) {
+          perror("select");
+          throw ConnectionTimeoutException();
+        } else if (!FD_ISSET(fd, &file_descriptors)) {
+          if (!FD_ISSET(fileno(stdin), &file_descriptors)) {
+            throw ConnectionTimeoutException();
+          }
+          if (std::cin.peek() != '\n') {
+            continue;
+          }
+          std::cin.get();
+          std::cout << "Cancelling TCP download" << std::endl;
+          throw OperationCancelledException();
+        }
+      }
 
-    int ready_fd = select(std::max(fd, fileno(stdin)) + 1, &file_descriptors,
-                          NULL, NULL, &timeout);
-    if (is_exiting) {
-      std::cout << "Cancelling TCP download, player is shutting down..."
-                << std::endl;
-      throw OperationCancelledException();
-    }
-    if (ready_fd == -1) {
-      perror("select");
-      throw ConnectionTimeoutException();
-    } else if (FD_ISSET(fd, &file_descriptors)) {
       // Read from socket
+
       to_read = std::min(remaining_size, (size_t)FILE_BUFFER_LEN);
-      n = read(fd, buffer, to_read);
+      n = ReadDeadline::read(fd, buffer, to_read);
       if (n <= 0) {
-        file.close();
         throw InvalidPacketException();
       }
       file.write(buffer, n);
       if (!file.good()) {
-        file.close();
         throw IOException();
       }
       remaining_size -= (size_t)n;
-
-    } else if (FD_ISSET(fileno(stdin), &file_descriptors)) {
-      if (std::cin.peek() != '\n') {
-        continue;
-      }
-      std::cin.get();
-      std::cout << "Cancelling TCP download" << std::endl;
-      throw OperationCancelledException();
-    } else {
-      throw ConnectionTimeoutException();
+      threadIO.bytesWritten += (uint64_t)n;
+      // only the bytes that arrived earn time, not the size the client claims
+      ReadDeadline::extendFor((size_t)n);
+      ReadDeadline::chargeUpload((size_t)n);
+    }
+  } catch (...) {
+    file.close();
+    if (flag) { // the unique directory of an asset that never arrived
+      delete_directory(file_name.substr(0, file_name.find_first_of(SLASH)));
     }
+    throw;
   }
 
   file.close();
@@ -744,26 +1828,29 @@ void ShowAssetRequest::receive(int fd) {
 }
 
 void ShowAssetResponse::send(int fd) {
-  std::stringstream stream;
-  stream << ShowAssetResponse::ID << " ";
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(ShowAssetResponse::ID).writeChar(' ');
 
   if (status == OK) {
-    stream << "OK";
-    stream << " " << assetFileName << " " << assetSize << " ";
-    writeString(fd, stream.str());
+    buffer.write("OK ").write(assetFileName).writeChar(' ');
+    buffer.writeInt(assetSize).writeChar(' ');
+    writeString(fd, buffer.view());
 
-    stream.str(std::string());
-    stream.clear();
-    sendFile(fd, assetPath);
+    buffer.clear();
+    if (assetFile.is_open()) {
+      sendFile(fd, assetFile, assetOffset, assetSize);
+    } else {
+      sendFile(fd, assetPath, assetOffset, assetSize);
+    }
   } else if (status == NOK) {
-    stream << "NOK";
+    buffer.write("NOK");
   } else if (status == ERR) {
-    stream << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  stream << std::endl;
-  writeString(fd, stream.str());
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
 }
 
 void ShowAssetResponse::receive(int fd) {
@@ -796,7 +1883,8 @@ void OpenAuctionRequest::send(int fd) {
 
   stream.str(std::string());
   stream.clear();
-  sendFile(fd, this->assetFileName);
+  // the asset is read from the working directory unless a path is given
+  sendFile(fd, this->assetPath.empty() ? this->assetFileName : this->assetPath);
 
   stream << std::endl;
   writeString(fd, stream.str());
@@ -807,12 +1895,6 @@ void OpenAuctionRequest::receive(int fd) {
   userID = readString(fd);
   readSpace(fd);
   password = readString(fd);
-
-  // must confirm the user password is correct
-  if (this->password != getUserPassword(userID)) {
-    throw InvalidPacketException();
-  }
-
   readSpace(fd);
   auctionName = readString(fd);
   readSpace(fd);
@@ -835,22 +1917,21 @@ void OpenAuctionRequest::receive(int fd) {
 }
 
 void OpenAuctionResponse::send(int fd) {
-  std::stringstream stream;
-  stream << OpenAuctionResponse::ID << " ";
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(OpenAuctionResponse::ID).writeChar(' ');
   if (status == OK) {
-    stream << "OK";
-    stream << " " << auctionID;
+    buffer.write("OK ").write(auctionID);
   } else if (status == NOK) {
-    stream << "NOK";
+    buffer.write("NOK");
   } else if (status == NLG) {
-    stream << "NLG";
+    buffer.write("NLG");
   } else if (status == ERR) {
-    stream << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  stream << std::endl;
-  writeString(fd, stream.str());
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
 }
 
 void OpenAuctionResponse::receive(int fd) {
@@ -891,26 +1972,27 @@ void CloseAuctionRequest::receive(int fd) {
 }
 
 void CloseAuctionResponse::send(int fd) {
-  std::stringstream stream;
-  stream << CloseAuctionResponse::ID << " ";
-
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(CloseAuctionResponse::ID).writeChar(' ');
   if (status == OK) {
-    stream << "OK";
+    buffer.write("OK");
+  } else if (status == NOK) {
+    buffer.write("NOK");
   } else if (status == EAU) {
-    stream << "EAU";
+    buffer.write("EAU");
   } else if (status == NLG) {
-    stream << "NLG";
+    buffer.write("NLG");
   } else if (status == EOW) {
-    stream << "EOW";
+    buffer.write("EOW");
   } else if (status == END) {
-    stream << "END";
+    buffer.write("END");
   } else if (status == ERR) {
-    stream << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  stream << std::endl;
-  writeString(fd, stream.str());
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
 }
 
 void CloseAuctionResponse::receive(int fd) {
@@ -919,6 +2001,8 @@ void CloseAuctionResponse::receive(int fd) {
   auto status_str = readString(fd);
   if (status_str == "OK") {
     this->status = OK;
+  } else if (status_str == "NOK") {
+    this->status = NOK;
   } else if (status_str == "EAU") {
     this->status = EAU;
   } else if (status_str == "EOW") {
@@ -955,26 +2039,25 @@ void BidRequest::receive(int fd) {
 }
 
 void BidResponse::send(int fd) {
-  std::stringstream stream;
-  stream << BidResponse::ID << " ";
-
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(BidResponse::ID).writeChar(' ');
   if (status == ACC) {
-    stream << "ACC";
+    buffer.write("ACC");
   } else if (status == NOK) {
-    stream << "NOK";
+    buffer.write("NOK");
   } else if (status == NLG) {
-    stream << "NLG";
+    buffer.write("NLG");
   } else if (status == REF) {
-    stream << "REF";
+    buffer.write("REF");
   } else if (status == ILG) {
-    stream << "ILG";
+    buffer.write("ILG");
   } else if (status == ERR) {
-    stream << "ERR";
+    buffer.write("ERR");
   } else {
     throw InvalidPacketException();
   }
-  stream << std::endl;
-  writeString(fd, stream.str());
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
 }
 
 void BidResponse::receive(int fd) {
@@ -999,62 +2082,310 @@ void BidResponse::receive(int fd) {
   readPacketDelimiter(fd);
 }
 
+void WatchRequest::send(int fd) {
+  std::stringstream stream;
+  stream << WatchRequest::ID << " " << this->auctionID << " " << this->timeout
+         << std::endl;
+  writeString(fd, stream.str());
+}
+
+void WatchRequest::receive(int fd) {
+  readSpace(fd);
+  auctionID = readString(fd);
+  readSpace(fd);
+  timeout = readInt(fd);
+  readPacketDelimiter(fd);
+}
+
+void WatchResponse::send(int fd) {
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(WatchResponse::ID).writeChar(' ');
+  if (status == BID) {
+    buffer.write("BID ").writeInt(bidValue);
+  } else if (status == CLS) {
+    buffer.write("CLS");
+  } else if (status == TMO) {
+    buffer.write("TMO");
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
+}
+
+void WatchResponse::receive(int fd) {
+  readPacketId(fd, WatchResponse::ID);
+  readSpace(fd);
+  auto status_str = readString(fd);
+  if (status_str == "BID") {
+    this->status = BID;
+    readSpace(fd);
+    bidValue = readInt(fd);
+  } else if (status_str == "CLS") {
+    this->status = CLS;
+  } else if (status_str == "TMO") {
+    this->status = TMO;
+  } else if (status_str == "NOK") {
+    this->status = NOK;
+  } else if (status_str == "ERR") {
+    this->status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(fd);
+}
+
 // TCP END
 
+void ListAuctionsStreamRequest::send(int fd) {
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(ListAuctionsStreamRequest::ID).writeChar('\n');
+  writeString(fd, buffer.view());
+}
+
+void ListAuctionsStreamRequest::receive(int fd) { readPacketDelimiter(fd); }
+
+void ListAuctionsStreamResponse::send(int fd) {
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  buffer.write(ListAuctionsStreamResponse::ID).writeChar(' ');
+  if (status == OK) {
+    buffer.write("OK");
+    const std::vector<std::pair<std::string, uint8_t>> *page = &auctions;
+    std::vector<std::pair<std::string, uint8_t>> next;
+    while (!page->empty()) {
+      for (const auto &auction : *page) {
+        buffer.writeChar(' ').write(auction.first).writeChar(' ');
+        buffer.writeInt(auction.second);
+      }
+      // flush every page, so only one is ever buffered
+      writeString(fd, buffer.view());
+      buffer.clear();
+      if (!nextPage) {
+        break;
+      }
+      next = nextPage(page->back().first);
+      page = &next;
+    }
+  } else if (status == NOK) {
+    buffer.write("NOK");
+  } else if (status == ERR) {
+    buffer.write("ERR");
+  } else {
+    throw InvalidPacketException();
+  }
+  buffer.writeChar('\n');
+  writeString(fd, buffer.view());
+}
+
+void ListAuctionsStreamResponse::receive(int fd) {
+  readPacketId(fd, ListAuctionsStreamResponse::ID);
+  readSpace(fd);
+  auto status_str = readString(fd);
+  if (status_str == "OK") {
+    this->status = OK;
+    char c = readChar(fd);
+    while (c == ' ') {
+      auto auction_id = readString(fd);
+      readSpace(fd);
+      auto state = readInt(fd);
+      auctions.push_back(std::make_pair(auction_id, (uint8_t)state));
+      c = readChar(fd);
+    }
+    if (c != '\n') {
+      throw InvalidPacketException();
+    }
+    return;
+  } else if (status_str == "NOK") {
+    this->status = NOK;
+  } else if (status_str == "ERR") {
+    this->status = ERR;
+  } else {
+    throw InvalidPacketException();
+  }
+  readPacketDelimiter(fd);
+}
+
 // Packet sending and receiving
 void send_packet(UdpPacket &packet, int socket, struct sockaddr *address,
+                 socklen_t addrlen, PacketEncoding encoding,
+                 uint32_t requestID) {
+  PacketBuffer &buffer = PacketBuffer::forThread();
+  encode_packet(packet, buffer, encoding, requestID);
+  send_buffer(buffer.view(), socket, address, addrlen);
+}
+
+void encode_packet(UdpPacket &packet, PacketBuffer &buffer,
+                   PacketEncoding encoding, uint32_t requestID) {
+  if (encoding == TEXT_ENCODING) {
+    packet.serialize(buffer);
+    return;
+  }
+  size_t start = buffer.length();
+  buffer.writeChar(BINARY_PACKET_MAGIC).writeUint8(BINARY_PROTOCOL_VERSION);
+  buffer.writeUint16(0); // patched once the length is known
+  buffer.writeUint32(requestID);
+  packet.serializeBinary(buffer);
+  size_t length = buffer.length() - start - BINARY_HEADER_LEN;
+  if (length > UINT16_MAX) {
+    throw PacketSerializationException();
+  }
+  buffer.patchUint16(start + 2, (uint16_t)length);
+}
+
+bool is_binary_packet(std::string_view data) {
+  return !data.empty() && data[0] == BINARY_PACKET_MAGIC;
+}
+
+std::string_view read_binary_frame(std::string_view data,
+                                   uint32_t *requestID) {
+  if (data.length() < BINARY_HEADER_LEN + PACKET_ID_LEN ||
+      data[0] != BINARY_PACKET_MAGIC ||
+      (uint8_t)data[1] != BINARY_PROTOCOL_VERSION ||
+      ((size_t)(uint8_t)data[2] << 8 | (uint8_t)data[3]) !=
+          data.length() - BINARY_HEADER_LEN) {
+    throw InvalidPacketException();
+  }
+  if (requestID != nullptr) {
+    *requestID = (uint32_t)(uint8_t)data[4] << 24 |
+                 (uint32_t)(uint8_t)data[5] << 16 |
+                 (uint32_t)(uint8_t)data[6] << 8 | (uint32_t)(uint8_t)data[7];
+  }
+  return data.substr(BINARY_HEADER_LEN);
+}
+
+void send_buffer(std::string_view buffer, int socket, struct sockaddr *address,
                  socklen_t addrlen) {
-  const std::stringstream buffer = packet.serialize();
-  ssize_t n = sendto(socket, buffer.str().c_str(), buffer.str().length(), 0,
-                     address, addrlen);
+  TraceSpan traceSpan("sendto");
+  ssize_t n =
+      sendto(socket, buffer.data(), buffer.length(), 0, address, addrlen);
   if (n == -1) {
     throw FatalError("Failed to send UDP packet", errno);
   }
 }
 
-void wait_for_packet(UdpPacket &packet, int socket) {
-  fd_set file_descriptors;
-  FD_ZERO(&file_descriptors);
-  FD_SET(socket, &file_descriptors);
+uint32_t wait_for_packet(UdpPacket &packet, int socket, PacketEncoding encoding,
+                         std::chrono::steady_clock::time_point deadline,
+                         uint32_t firstID, uint32_t lastID) {
+  char buffer[SOCKET_BUFFER_LEN];
+  while (true) {
+    auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      throw ConnectionTimeoutException();
+    }
+
+    fd_set file_descriptors;
+    FD_ZERO(&file_descriptors);
+    FD_SET(socket, &file_descriptors);
 
-  struct timeval timeout;
-  timeout.tv_sec = UDP_TIMEOUT_SECONDS; // wait for a response before throwing
-  timeout.tv_usec = 0;
+    struct timeval timeout; // wait for a response before throwing
+    timeout.tv_sec = (time_t)(left.count() / 1000000);
+    timeout.tv_usec = (suseconds_t)(left.count() % 1000000);
 
-  int ready_fd = select(socket + 1, &file_descriptors, NULL, NULL, &timeout);
-  if (is_exiting) {
-    throw OperationCancelledException();
-  }
-  if (ready_fd == -1) {
-    throw FatalError("Failed waiting for UDP packet on select", errno);
-  } else if (ready_fd == 0) {
-    throw ConnectionTimeoutException();
-  }
+    int ready_fd = select(socket + 1, &file_descriptors, NULL, NULL, &timeout);
+    if (is_exiting) {
+      throw OperationCancelledException();
+    }
+    if (ready_fd == -1) {
+      throw FatalError("Failed waiting for UDP packet on select", errno);
+    } else if (ready_fd == 0) {
+      throw ConnectionTimeoutException();
+    }
 
-  std::stringstream data;
-  char buffer[SOCKET_BUFFER_LEN];
+    ssize_t n = recvfrom(socket, buffer, SOCKET_BUFFER_LEN, 0, NULL, NULL);
+    if (n == -1) {
+      throw FatalError("Failed waiting for UDP packet on recvfrom", errno);
+    }
+    std::string_view received(buffer, (size_t)n);
 
-  ssize_t n = recvfrom(socket, buffer, SOCKET_BUFFER_LEN, 0, NULL, NULL);
-  if (n == -1) {
-    throw FatalError("Failed waiting for UDP packet on recvfrom", errno);
-  }
+    if (encoding == BINARY_ENCODING) {
+      uint32_t requestID = 0;
+      std::string_view frame = read_binary_frame(received, &requestID);
+      // a reply to an earlier request, or to an attempt it gave up on
+      if (requestID - firstID > lastID - firstID) {
+        continue;
+      }
+      packet.deserializeBinary(frame);
+      return requestID;
+    }
 
-  data.write(buffer, n);
+    std::stringstream data;
+    data.write(buffer, n);
+    try {
+      packet.deserialize(data);
+      return 0;
+    } catch (UnexpectedPacketException &e) {
+      // the reply to another kind of request, unless it is an error
+      if (received.substr(0, PACKET_ID_LEN) == ErrorUdpPacket::ID) {
+        throw;
+      }
+    }
+  }
+}
 
-  packet.deserialize(data);
+void drain_packets(int socket) {
+  char buffer[SOCKET_BUFFER_LEN];
+  while (recv(socket, buffer, SOCKET_BUFFER_LEN, MSG_DONTWAIT) >= 0) {
+  }
 }
 
 void sendFile(int fd, std::filesystem::path file_path) {
+  TraceSpan traceSpan("sendFile", file_path.native());
   std::ifstream file(file_path, std::ios::in | std::ios::binary);
   if (!file) {
     std::cerr << "Error opening file: " << file_path << std::endl;
     throw PacketSerializationException();
   }
+  threadIO.opens++;
   char buffer[FILE_BUFFER_LEN];
 
   while (file) {
     file.read(buffer, FILE_BUFFER_LEN);
     ssize_t bytes_read = (ssize_t)file.gcount();
+    threadIO.bytesRead += (uint64_t)std::max<ssize_t>(bytes_read, 0);
+    ssize_t bytes_sent = 0;
+    while (bytes_sent < bytes_read) {
+      ssize_t sent =
+          write(fd, buffer + bytes_sent, (size_t)(bytes_read - bytes_sent));
+      if (sent < 0) {
+        throw PacketSerializationException();
+      }
+      bytes_sent += sent;
+    }
+  }
+}
+
+void sendFile(int fd, std::filesystem::path file_path, uint32_t offset,
+              uint32_t size) {
+  TraceSpan traceSpan("sendFile", file_path.native());
+  std::ifstream file(file_path, std::ios::in | std::ios::binary);
+  if (!file) {
+    std::cerr << "Error opening file: " << file_path << std::endl;
+    throw PacketSerializationException();
+  }
+  threadIO.opens++;
+  sendFile(fd, file, offset, size);
+}
+
+void sendFile(int fd, std::ifstream &file, uint32_t offset, uint32_t size) {
+  if (!file || !file.seekg(offset)) {
+    std::cerr << "Error seeking file to offset " << offset << std::endl;
+    throw PacketSerializationException();
+  }
+  char buffer[FILE_BUFFER_LEN];
+
+  uint32_t remaining = size;
+  while (remaining > 0) {
+    file.read(buffer, std::min(remaining, (uint32_t)FILE_BUFFER_LEN));
+    ssize_t bytes_read = (ssize_t)file.gcount();
+    threadIO.bytesRead += (uint64_t)std::max<ssize_t>(bytes_read, 0);
+    if (bytes_read <= 0) { // file is shorter than expected
+      throw PacketSerializationException();
+    }
     ssize_t bytes_sent = 0;
     while (bytes_sent < bytes_read) {
       ssize_t sent =
@@ -1064,10 +2395,12 @@ void sendFile(int fd, std::filesystem::path file_path) {
       }
       bytes_sent += sent;
     }
+    remaining -= (uint32_t)bytes_read;
   }
 }
 
 uint32_t getFileSize(std::filesystem::path file_path) {
+  threadIO.stats++;
   try {
     return (uint32_t)std::filesystem::file_size(file_path);
   } catch (...) {
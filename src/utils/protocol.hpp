@@ -5,20 +5,50 @@
 #include <string>
 #include <sys/socket.h>
 
+#include <chrono>
 #include <cstdint>
 #include <ctime>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
 #include "../server/server_auction.hpp"
 #include "constants.hpp"
+#include "packet_buffer.hpp"
 #include "utils.hpp"
 
+/**
+ * @brief Packs a packet ID into an integer, so that IDs can be compared at
+ * once and used as switch cases.
+ *
+ * @param id The packet ID, PACKET_ID_LEN characters long.
+ * @return The packed ID.
+ */
+constexpr uint32_t packPacketID(std::string_view id) {
+  return (uint32_t)(unsigned char)id[0] << 16 |
+         (uint32_t)(unsigned char)id[1] << 8 | (uint32_t)(unsigned char)id[2];
+}
+
+/**
+ * @brief Encodings a UDP packet can be sent in.
+ *
+ * Binary packets are framed by a header of BINARY_HEADER_LEN bytes: the
+ * BINARY_PACKET_MAGIC byte, the protocol version, the length of the rest of
+ * the packet, as a 16 bit integer, and the ID of the request, as a 32 bit
+ * integer, which the reply echoes. The rest is the packet ID, followed by its
+ * fields: integers in network byte order, user IDs as 32 bit integers, auction
+ * IDs as 16 bit integers, statuses as the index of the status in the packet
+ * and other strings prefixed by their length in a byte.
+ */
+enum PacketEncoding { TEXT_ENCODING, BINARY_ENCODING };
+
 /**
  * @class UnexpectedPacketException
  *
@@ -64,6 +94,33 @@ public:
                            "connection and try again.") {}
 };
 
+/**
+ * @class SlowConnectionException
+ *
+ * @brief Represents an exception thrown when a connection did not send its
+ * request before its deadline, so the AS stops reading from it.
+ *
+ */
+class SlowConnectionException : public std::runtime_error {
+public:
+  SlowConnectionException()
+      : std::runtime_error("The connection was too slow to send its request") {
+  }
+};
+
+/**
+ * @class UploadRefusedException
+ *
+ * @brief Represents an exception thrown when a connection uploads more than its
+ * source is allowed, so the AS stops reading from it.
+ *
+ */
+class UploadRefusedException : public std::runtime_error {
+public:
+  UploadRefusedException()
+      : std::runtime_error("The connection uploaded more than it is allowed") {}
+};
+
 /**
  * @class OperationCancelledException
  *
@@ -124,6 +181,15 @@ private:
    */
   void readChar(std::stringstream &buffer, char chr);
 
+  /**
+   * @brief Consumes a character from the front of the buffer and checks if it
+   * is equal to the given character.
+   *
+   * @param buffer The buffer to read from.
+   * @param chr The character to check for.
+   */
+  void readChar(std::string_view &buffer, char chr);
+
 protected:
   /**
    * @brief Reads the packet ID from the buffer and checks if it is equal to the
@@ -199,13 +265,175 @@ protected:
    */
   std::string readTime(std::stringstream &buffer);
 
+  /**
+   * @brief Consumes a space character from the front of the buffer.
+   *
+   * @param buffer The buffer to read from.
+   */
+  void readSpace(std::string_view &buffer);
+
+  /**
+   * @brief Consumes the packet delimiter, which must end the buffer.
+   *
+   * @param buffer The buffer to read from.
+   */
+  void readPacketDelimiter(std::string_view &buffer);
+
+  /**
+   * @brief Consumes a string from the front of the buffer, without copying it.
+   *
+   * @param buffer The buffer to read from.
+   * @param max_len The maximum length of the string.
+   * @return The string that was read, pointing into the buffer.
+   */
+  std::string_view readString(std::string_view &buffer, uint32_t max_len);
+
+  /**
+   * @brief Consumes the packet ID of a binary packet and checks if it is equal
+   * to the given ID.
+   *
+   * @param buffer The buffer to read from.
+   * @param id The ID to check for.
+   */
+  void readBinaryPacketId(std::string_view &buffer, const char *id);
+
+  /**
+   * @brief Consumes a byte from the front of the buffer.
+   *
+   * @param buffer The buffer to read from.
+   * @return The byte that was read.
+   */
+  uint8_t readUint8(std::string_view &buffer);
+
+  /**
+   * @brief Consumes a 16 bit integer, in network byte order, from the front of
+   * the buffer.
+   *
+   * @param buffer The buffer to read from.
+   * @return The integer that was read.
+   */
+  uint16_t readUint16(std::string_view &buffer);
+
+  /**
+   * @brief Consumes a 32 bit integer, in network byte order, from the front of
+   * the buffer.
+   *
+   * @param buffer The buffer to read from.
+   * @return The integer that was read.
+   */
+  uint32_t readUint32(std::string_view &buffer);
+
+  /**
+   * @brief Consumes a 64 bit integer, in network byte order, from the front of
+   * the buffer.
+   *
+   * @param buffer The buffer to read from.
+   * @return The integer that was read.
+   */
+  uint64_t readUint64(std::string_view &buffer);
+
+  /**
+   * @brief Consumes a status of a binary packet, checking it is in range.
+   *
+   * @param buffer The buffer to read from.
+   * @param max The largest valid status.
+   * @return The status that was read.
+   */
+  uint8_t readBinaryStatus(std::string_view &buffer, uint8_t max);
+
+  /**
+   * @brief Consumes a string prefixed by its length, without copying it.
+   *
+   * @param buffer The buffer to read from.
+   * @param max_len The maximum length of the string.
+   * @return The string that was read, pointing into the buffer.
+   */
+  std::string_view readShortString(std::string_view &buffer, uint8_t max_len);
+
+  /**
+   * @brief Consumes a user ID of a binary packet.
+   *
+   * @param buffer The buffer to read from.
+   * @return The user ID, in its text form.
+   */
+  std::string readBinaryUserID(std::string_view &buffer);
+
+  /**
+   * @brief Consumes an auction ID of a binary packet.
+   *
+   * @param buffer The buffer to read from.
+   * @return The auction ID, in its text form.
+   */
+  std::string readBinaryAuctionID(std::string_view &buffer);
+
+  /**
+   * @brief Checks that every field of a binary packet was read.
+   *
+   * @param buffer The bytes left in the packet.
+   */
+  void readBinaryEnd(std::string_view buffer);
+
+  /**
+   * @brief Appends a string prefixed by its length to the buffer.
+   *
+   * @param buffer The buffer to write to.
+   * @param str The string to write.
+   */
+  static void writeShortString(PacketBuffer &buffer, std::string_view str);
+
+  /**
+   * @brief Appends a user ID, as a 32 bit integer, to the buffer.
+   *
+   * @param buffer The buffer to write to.
+   * @param userID The user ID, in its text form.
+   */
+  static void writeBinaryUserID(PacketBuffer &buffer,
+                                const std::string &userID);
+
+  /**
+   * @brief Appends an auction ID, as a 16 bit integer, to the buffer.
+   *
+   * @param buffer The buffer to write to.
+   * @param auctionID The auction ID, in its text form.
+   */
+  static void writeBinaryAuctionID(PacketBuffer &buffer,
+                                   const std::string &auctionID);
+
+  /**
+   * @brief Consumes a list of auctions of a binary packet, prefixed by their
+   * count.
+   *
+   * @param buffer The buffer to read from.
+   * @param auctions The vector to add the auction IDs and states to.
+   */
+  void
+  readBinaryAuctions(std::string_view &buffer,
+                     std::vector<std::pair<std::string, uint8_t>> &auctions);
+
+  /**
+   * @brief Appends a list of auctions, prefixed by their count, to the buffer.
+   *
+   * @param buffer The buffer to write to.
+   * @param auctions The auction IDs and states.
+   */
+  static void writeBinaryAuctions(
+      PacketBuffer &buffer,
+      const std::vector<std::pair<std::string, uint8_t>> &auctions);
+
 public:
   /**
    * @brief Serializes the packet into a stringstream.
    *
    * @return The serialized packet.
    */
-  virtual std::stringstream serialize() = 0;
+  std::stringstream serialize();
+
+  /**
+   * @brief Serializes the packet at the end of a buffer.
+   *
+   * @param buffer The buffer to write the packet to.
+   */
+  virtual void serialize(PacketBuffer &buffer) = 0;
 
   /**
    * @brief Deserializes the packet from a stringstream.
@@ -214,6 +442,27 @@ public:
    */
   virtual void deserialize(std::stringstream &buffer) = 0;
 
+  /**
+   * @brief Serializes the packet, in the binary encoding, at the end of a
+   * buffer. The frame header is written by encode_packet.
+   *
+   * Packets that have no binary encoding throw InvalidPacketException.
+   *
+   * @param buffer The buffer to write the packet to.
+   */
+  virtual void serializeBinary(PacketBuffer &buffer);
+
+  /**
+   * @brief Deserializes the packet from the binary encoding, without the frame
+   * header. Requests are given the bytes after their packet ID, like in the
+   * text encoding.
+   *
+   * Packets that have no binary encoding throw InvalidPacketException.
+   *
+   * @param buffer The received bytes.
+   */
+  virtual void deserializeBinary(std::string_view buffer);
+
   /**
    * @brief Destroys the UdpPacket object.
    *
@@ -235,8 +484,19 @@ public:
   std::string userID;
   std::string password;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -250,11 +510,15 @@ public:
 class LoginResponse : public UdpPacket {
 public:
   enum status { OK, NOK, REG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "REG", "ERR"};
   static constexpr const char *ID = "RLI";
   status status;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -271,8 +535,19 @@ public:
   std::string userID;
   std::string password;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -286,11 +561,15 @@ public:
 class LogoutResponse : public UdpPacket {
 public:
   enum status { OK, NOK, UNR, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "UNR", "ERR"};
   static constexpr const char *ID = "RLO";
   status status;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -307,8 +586,19 @@ public:
   std::string userID;
   std::string password;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -322,11 +612,15 @@ public:
 class UnregisterResponse : public UdpPacket {
 public:
   enum status { OK, NOK, UNR, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "UNR", "ERR"};
   static constexpr const char *ID = "RUR";
   status status;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -342,8 +636,19 @@ public:
   static constexpr const char *ID = "LMA";
   std::string userID;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -358,12 +663,16 @@ public:
 class ListUserAuctionsResponse : public UdpPacket {
 public:
   enum status { OK, NOK, NLG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "NLG", "ERR"};
   static constexpr const char *ID = "RMA";
   status status;
   std::vector<std::pair<std::string, uint8_t>> auctions;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -379,8 +688,19 @@ public:
   static constexpr const char *ID = "LMB";
   std::string userID;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -395,12 +715,16 @@ public:
 class ListUserBidsResponse : public UdpPacket {
 public:
   enum status { OK, NOK, NLG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "NLG", "ERR"};
   static constexpr const char *ID = "RMB";
   status status;
   std::vector<std::pair<std::string, uint8_t>> auctions;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -415,8 +739,19 @@ class ListAuctionsRequest : public UdpPacket {
 public:
   static constexpr const char *ID = "LST";
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -431,12 +766,152 @@ public:
 class ListAuctionsResponse : public UdpPacket {
 public:
   enum status { OK, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "ERR"};
   static constexpr const char *ID = "RLS";
   status status;
   std::vector<std::pair<std::string, uint8_t>> auctions;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListAuctionsPageRequest
+ *
+ * @brief Represents a UDP packet for listing a page of all auctions.
+ * The packet has the following format:
+ * LSP <cursor>
+ * cursor is the last auction ID of the previous page, or 000 for the first.
+ *
+ */
+class ListAuctionsPageRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "LSP";
+  std::string cursor = LIST_CURSOR_START;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListUserAuctionsPageRequest
+ *
+ * @brief Represents a UDP packet for listing a page of the auctions of a user.
+ * The packet has the following format:
+ * LMP <user_id> <cursor>
+ *
+ */
+class ListUserAuctionsPageRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "LMP";
+  std::string userID;
+  std::string cursor = LIST_CURSOR_START;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListUserBidsPageRequest
+ *
+ * @brief Represents a UDP packet for listing a page of the bids of a user.
+ * The packet has the following format:
+ * LBP <user_id> <cursor>
+ *
+ */
+class ListUserBidsPageRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "LBP";
+  std::string userID;
+  std::string cursor = LIST_CURSOR_START;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListingPageResponse
+ *
+ * @brief Represents a UDP packet for responding to a paged listing request.
+ * The packet has the following format:
+ * <id> <status> [<next_cursor> [ AID state]*]
+ * next_cursor is the cursor of the following page, or 000 after the last one.
+ * At most LIST_PAGE_SIZE auctions are sent in a page.
+ *
+ */
+class ListingPageResponse : public UdpPacket {
+public:
+  enum status { OK, NOK, NLG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "NLG", "ERR"};
+  status status;
+  std::string nextCursor = LIST_CURSOR_START;
+  std::vector<std::pair<std::string, uint8_t>> auctions;
+
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+protected:
+  explicit ListingPageResponse(const char *id) : packetID(id) {}
+
+private:
+  const char *packetID;
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+class ListAuctionsPageResponse : public ListingPageResponse {
+public:
+  static constexpr const char *ID = "RSP";
+  ListAuctionsPageResponse() : ListingPageResponse(ID) {}
+};
+
+class ListUserAuctionsPageResponse : public ListingPageResponse {
+public:
+  static constexpr const char *ID = "RMP";
+  ListUserAuctionsPageResponse() : ListingPageResponse(ID) {}
+};
+
+class ListUserBidsPageResponse : public ListingPageResponse {
+public:
+  static constexpr const char *ID = "RBP";
+  ListUserBidsPageResponse() : ListingPageResponse(ID) {}
 };
 
 /**
@@ -452,8 +927,19 @@ public:
   static constexpr const char *ID = "SRC";
   std::string auctionID;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 /**
@@ -469,6 +955,7 @@ public:
 class ShowRecordResponse : public UdpPacket {
 public:
   enum status { OK, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "ERR"};
   static constexpr const char *ID = "RRC";
   status status;
   std::string hostUID;
@@ -480,16 +967,265 @@ public:
   std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
   std::pair<std::string, uint32_t> end;
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListAuctionsDeltaRequest
+ *
+ * @brief Represents a UDP packet for listing the auctions whose state changed
+ * since a catalog version.
+ * The packet has the following format:
+ * LSD <version>
+ * version is the one of the last reply, or 0 to list every auction.
+ *
+ */
+class ListAuctionsDeltaRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "LSD";
+  uint64_t version = 0;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ListAuctionsDeltaResponse
+ *
+ * @brief Represents a UDP packet for responding to a list auctions delta
+ * request. The packet has the following format:
+ * RSD <status> [<version> [ AID state]*]
+ * status is NMD, with the same version, if no auction changed since.
+ *
+ */
+class ListAuctionsDeltaResponse : public UdpPacket {
+public:
+  enum status { OK, NMD, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NMD", "NOK", "ERR"};
+  static constexpr const char *ID = "RSD";
+  status status;
+  uint64_t version = 0;
+  std::vector<std::pair<std::string, uint8_t>> auctions;
+
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ShowRecordDeltaRequest
+ *
+ * @brief Represents a UDP packet for showing the changes to the record of an
+ * auction since a record version.
+ * The packet has the following format:
+ * SRD <auction_id> <version>
+ * version is the one of the last reply, or 0 to show every bid.
+ *
+ */
+class ShowRecordDeltaRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "SRD";
+  std::string auctionID;
+  uint64_t version = 0;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ShowRecordDeltaResponse
+ *
+ * @brief Represents a UDP packet for responding to a show record delta
+ * request. The packet has the following format:
+ * RRD <status> [<version> [ B bidder_UID bid_value bid_date-time
+ * bid_sec_time]* [ E end_date-time end_sec_time]]
+ * Only the bids placed since the version are sent, and the end only if the
+ * auction closed since. status is NMD, with the same version, if neither
+ * happened.
+ *
+ */
+class ShowRecordDeltaResponse : public UdpPacket {
+public:
+  enum status { OK, NMD, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NMD", "NOK", "ERR"};
+  static constexpr const char *ID = "RRD";
+  status status;
+  uint64_t version = 0;
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>> bids;
+  std::pair<std::string, uint32_t> end;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class StatsRequest
+ *
+ * @brief Represents a UDP packet for asking the AS for the latencies and
+ * counters of the requests it handled. Only answered from the same machine.
+ * The packet has the following format:
+ * STA
+ *
+ */
+class StatsRequest : public UdpPacket {
+public:
+  static constexpr const char *ID = "STA";
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  /**
+   * @brief Deserializes the packet straight from the received bytes, without
+   * the packet ID.
+   *
+   * @param buffer The received bytes.
+   */
+  void deserialize(std::string_view buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class StatsResponse
+ *
+ * @brief Represents a UDP packet for responding to a stats request.
+ * The packet has the following format:
+ * RST <status> [<length> <report>]
+ * report is the text of the report, over many lines, of length bytes. status
+ * is NOK if the request did not come from the same machine.
+ *
+ */
+class StatsResponse : public UdpPacket {
+public:
+  enum status { OK, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "ERR"};
+  static constexpr const char *ID = "RST";
+  status status;
+  std::string report;
+
+  void serialize(PacketBuffer &buffer);
+  void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
 };
 
 class ErrorUdpPacket : public UdpPacket {
 public:
   static constexpr const char *ID = "ERR";
 
-  std::stringstream serialize();
+  void serialize(PacketBuffer &buffer);
   void deserialize(std::stringstream &buffer);
+
+  void serializeBinary(PacketBuffer &buffer);
+  void deserializeBinary(std::string_view buffer);
+};
+
+/**
+ * @class ReadDeadline
+ *
+ * @brief The time by which the calling thread must have read the TCP request
+ * it is receiving, from its construction to its destruction.
+ *
+ * The request has a few seconds to arrive, however slowly its bytes trickle
+ * in, and every part of its upload that arrives adds the time it takes at the
+ * lowest rate allowed, so a slow client cannot hold the thread for long.
+ * Without a deadline, such as in the user application, every read waits for as
+ * long as the socket allows.
+ */
+class ReadDeadline {
+public:
+  /**
+   * @brief Starts the deadline of the request of the calling thread.
+   *
+   * @param seconds the time the request has to arrive, but for its upload
+   * @param charge what to charge the upload of the request to as it arrives,
+   * returning false to refuse the rest of it
+   */
+  ReadDeadline(uint32_t seconds,
+               std::function<bool(size_t)> charge = nullptr);
+
+  ~ReadDeadline();
+
+  ReadDeadline(const ReadDeadline &) = delete;
+  ReadDeadline &operator=(const ReadDeadline &) = delete;
+
+  /**
+   * @brief Checks if the request missed its deadline, so it was given up on.
+   */
+  bool missed() const;
+
+  /**
+   * @brief Checks if the upload of the request was refused, so it was given up
+   * on.
+   */
+  bool refused() const;
+
+  /**
+   * @brief Checks if the calling thread is reading a request with a deadline.
+   */
+  static bool active();
+
+  /**
+   * @brief Gives the request of the calling thread, if it has a deadline, the
+   * time the bytes of its upload that arrived take at the lowest rate allowed.
+   *
+   * @param bytes the bytes that arrived
+   */
+  static void extendFor(size_t bytes);
+
+  /**
+   * @brief Charges the bytes of an upload that arrived to the request of the
+   * calling thread, if it has a deadline, every TCP_UPLOAD_CHARGE of them.
+   *
+   * @param bytes the bytes that arrived
+   * @throws UploadRefusedException if the rest of the upload was refused.
+   */
+  static void chargeUpload(size_t bytes);
+
+  /**
+   * @brief Reads from a connection, waiting for no longer than the deadline
+   * of the calling thread, if any.
+   *
+   * @param fd The file descriptor of the connection.
+   * @param buffer Where to read into.
+   * @param length The most bytes to read.
+   * @return The bytes read, 0 at the end of the stream, or -1 on errors.
+   * @throws SlowConnectionException if the deadline passed first.
+   */
+  static ssize_t read(int fd, char *buffer, size_t length);
 };
 
 /**
@@ -517,7 +1253,7 @@ protected:
    * @param fd The file descriptor of the connection.
    * @param str The string to write.
    */
-  void writeString(int fd, const std::string &str);
+  void writeString(int fd, std::string_view str);
 
   /**
    * @brief Reads the packet ID from the fd and checks if it is equal to the
@@ -624,11 +1360,14 @@ public:
 class ShowAssetResponse : public TcpPacket {
 public:
   enum status { OK, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "ERR"};
   static constexpr const char *ID = "RSA";
   status status;
   std::string assetFileName;
   uint32_t assetSize;
   std::string assetPath;
+  uint32_t assetOffset = 0; // where the asset starts in the file at assetPath
+  std::ifstream assetFile;  // the file at assetPath, if opened in advance
 
   void send(int fd);
   void receive(int fd);
@@ -654,7 +1393,7 @@ public:
   uint32_t assetSize;
   uint32_t startValue;
   uint32_t timeActive;
-  std::string assetPath;
+  std::string assetPath; // where the asset is read from, or was saved to
 
   void send(int fd);
   void receive(int fd);
@@ -672,6 +1411,7 @@ public:
 class OpenAuctionResponse : public TcpPacket {
 public:
   enum status { OK, NOK, NLG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "NLG", "ERR"};
   static constexpr const char *ID = "ROA";
   status status;
   std::string auctionID;
@@ -712,6 +1452,8 @@ public:
 class CloseAuctionResponse : public TcpPacket {
 public:
   enum status { OK, NOK, EAU, NLG, EOW, END, ERR };
+  static constexpr const char *STATUS_NAMES[] = {
+      "OK", "NOK", "EAU", "NLG", "EOW", "END", "ERR"};
   static constexpr const char *ID = "RCL";
   status status;
 
@@ -752,6 +1494,8 @@ public:
 class BidResponse : public TcpPacket {
 public:
   enum status { ACC, NOK, NLG, REF, ILG, ERR };
+  static constexpr const char *STATUS_NAMES[] = {
+      "ACC", "NOK", "NLG", "REF", "ILG", "ERR"};
   static constexpr const char *ID = "RBD";
   status status;
 
@@ -759,6 +1503,99 @@ public:
   void receive(int fd);
 };
 
+/**
+ * @class WatchRequest
+ *
+ * @brief Represents a TCP packet for waiting until an auction changes.
+ *
+ * The packet has the following format:
+ * WAT <AID> <timeout>
+ * The connection is held open for at most timeout seconds.
+ *
+ */
+class WatchRequest : public TcpPacket {
+public:
+  static constexpr const char *ID = "WAT";
+  std::string auctionID;
+  uint32_t timeout;
+
+  void send(int fd);
+  void receive(int fd);
+};
+
+/**
+ * @class WatchResponse
+ *
+ * @brief Represents a TCP packet for responding to a watch request, once the
+ * auction received a bid, closed, or the timeout expired.
+ *
+ * The packet has the following format:
+ * RWA <status> [<bid_value>]
+ *
+ */
+class WatchResponse : public TcpPacket {
+public:
+  enum status { BID, CLS, TMO, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {
+      "BID", "CLS", "TMO", "NOK", "ERR"};
+  static constexpr const char *ID = "RWA";
+  status status;
+  uint32_t bidValue = 0; // only sent with BID
+
+  void send(int fd);
+  void receive(int fd);
+};
+
+/**
+ * @class ListAuctionsStreamRequest
+ *
+ * @brief Represents a TCP packet for listing all auctions at once, however
+ * many there are.
+ *
+ * The packet has the following format:
+ * LTS
+ *
+ */
+class ListAuctionsStreamRequest : public TcpPacket {
+public:
+  static constexpr const char *ID = "LTS";
+
+  void send(int fd);
+  void receive(int fd);
+};
+
+/**
+ * @class ListAuctionsStreamResponse
+ *
+ * @brief Represents a TCP packet for responding to a streamed list auctions
+ * request.
+ *
+ * The packet has the following format:
+ * RTS <status> [ AID state]*
+ *
+ * The auctions are written a page at a time, so the whole list is never held
+ * in memory.
+ *
+ */
+class ListAuctionsStreamResponse : public TcpPacket {
+public:
+  enum status { OK, NOK, ERR };
+  static constexpr const char *STATUS_NAMES[] = {"OK", "NOK", "ERR"};
+  static constexpr const char *ID = "RTS";
+  status status;
+
+  // the first page, and every auction once received
+  std::vector<std::pair<std::string, uint8_t>> auctions;
+
+  // gets the page after the given cursor when sending, empty after the last
+  std::function<std::vector<std::pair<std::string, uint8_t>>(
+      const std::string &)>
+      nextPage;
+
+  void send(int fd);
+  void receive(int fd);
+};
+
 /**
  * @class ErrorTcpPacket
  *
@@ -783,17 +1620,84 @@ public:
  * @param socket The socket to send the packet on.
  * @param address The address to send the packet to.
  * @param addrlen The length of the address.
+ * @param encoding The encoding to send the packet in.
+ * @param requestID The ID of the request, or of the request replied to, if
+ * the packet is binary.
  */
 void send_packet(UdpPacket &packet, int socket, struct sockaddr *address,
+                 socklen_t addrlen, PacketEncoding encoding = TEXT_ENCODING,
+                 uint32_t requestID = 0);
+
+/**
+ * @brief Serializes a UDP packet at the end of a buffer, in the given
+ * encoding, framing it if it is binary.
+ *
+ * @param packet The packet to serialize.
+ * @param buffer The buffer to write the packet to.
+ * @param encoding The encoding to use.
+ * @param requestID The ID of the request, or of the request replied to, if
+ * the packet is binary.
+ */
+void encode_packet(UdpPacket &packet, PacketBuffer &buffer,
+                   PacketEncoding encoding, uint32_t requestID = 0);
+
+/**
+ * @brief Checks if received bytes are a binary packet.
+ *
+ * @param data The received bytes.
+ * @return true if the bytes start with the binary magic byte.
+ */
+bool is_binary_packet(std::string_view data);
+
+/**
+ * @brief Checks the frame header of a binary packet.
+ *
+ * @param data The received bytes.
+ * @param requestID Where to store the request ID of the packet, if anywhere.
+ * @return The packet ID and fields, after the header.
+ */
+std::string_view read_binary_frame(std::string_view data,
+                                   uint32_t *requestID = nullptr);
+
+/**
+ * @brief Sends an already serialized UDP packet.
+ *
+ * @param buffer The bytes of the packet.
+ * @param socket The socket to send the packet on.
+ * @param address The address to send the packet to.
+ * @param addrlen The length of the address.
+ */
+void send_buffer(std::string_view buffer, int socket, struct sockaddr *address,
                  socklen_t addrlen);
 
 /**
- * @brief waits for a UDP packet.
+ * @brief waits for the reply to a request, skipping the replies to earlier
+ * requests that arrive late.
+ *
+ * Binary replies are told apart by the request ID they echo. Text replies
+ * only by their packet ID, so a late reply to an earlier request of the same
+ * kind cannot be told apart, which is why the socket is drained before a new
+ * request is sent.
  *
  * @param packet  The packet to receive.
  * @param socket  The socket to receive the packet on.
+ * @param encoding  The encoding the packet is expected in.
+ * @param deadline  When to stop waiting.
+ * @param firstID  The ID of the first attempt at the request, if binary.
+ * @param lastID  The ID of the last attempt at the request, if binary.
+ * @return The ID of the attempt replied to, or 0 if the reply is in text.
+ * @throws ConnectionTimeoutException if no reply arrived before the deadline.
  */
-void wait_for_packet(UdpPacket &packet, int socket);
+uint32_t wait_for_packet(UdpPacket &packet, int socket, PacketEncoding encoding,
+                         std::chrono::steady_clock::time_point deadline,
+                         uint32_t firstID = 0, uint32_t lastID = 0);
+
+/**
+ * @brief Discards the packets already received on a socket.
+ *
+ * @param socket  The socket.
+ */
+void drain_packets(int socket);
 
 /**
  * @brief Sends a file over a TCP connection.
@@ -803,6 +1707,27 @@ void wait_for_packet(UdpPacket &packet, int socket);
  */
 void sendFile(int fd, std::filesystem::path image_path);
 
+/**
+ * @brief Sends part of a file over a TCP connection.
+ *
+ * @param fd The file descriptor of the connection.
+ * @param file_path The path to the file.
+ * @param offset The offset of the first byte to send.
+ * @param size The number of bytes to send.
+ */
+void sendFile(int fd, std::filesystem::path file_path, uint32_t offset,
+              uint32_t size);
+
+/**
+ * @brief Sends part of an open file over a TCP connection.
+ *
+ * @param fd The file descriptor of the connection.
+ * @param file The open file.
+ * @param offset The offset of the first byte to send.
+ * @param size The number of bytes to send.
+ */
+void sendFile(int fd, std::ifstream &file, uint32_t offset, uint32_t size);
+
 /**
  * @brief Receives a file over a TCP connection.
  *
@@ -0,0 +1,155 @@
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+#define CHUNK_LEN 16
+
+/**
+ * @brief Gets the mask of the first bytes of a chunk.
+ *
+ * @param length The number of bytes, which is capped to a chunk.
+ * @return A bit set for each of the bytes.
+ */
+static uint32_t chunkBits(size_t length) {
+  return length >= CHUNK_LEN ? 0xFFFF : (1u << length) - 1;
+}
+
+/**
+ * @brief Loads a chunk of a buffer, padded with zeros if it is short.
+ *
+ * Zero is neither a delimiter nor in any class, and the padding is masked out
+ * by chunkBits anyway.
+ *
+ * @param data The start of the chunk.
+ * @param length The bytes left in the buffer.
+ * @return The chunk.
+ */
+static __m128i loadChunk(const char *data, size_t length) {
+  if (length >= CHUNK_LEN) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+  }
+  alignas(CHUNK_LEN) char chunk[CHUNK_LEN] = {};
+  std::memcpy(chunk, data, length);
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(chunk));
+}
+
+/**
+ * @brief Gets the bytes of a chunk that are in a range of characters.
+ *
+ * Bytes above 127 compare as negative, so they are never in a range.
+ *
+ * @param chunk The chunk to check.
+ * @param first The first character of the range.
+ * @param last The last character of the range.
+ * @return 0xFF for the bytes in the range, 0 for the others.
+ */
+static __m128i inRange(__m128i chunk, char first, char last) {
+  __m128i aboveFirst = _mm_cmpgt_epi8(chunk, _mm_set1_epi8((char)(first - 1)));
+  __m128i belowLast = _mm_cmplt_epi8(chunk, _mm_set1_epi8((char)(last + 1)));
+  return _mm_and_si128(aboveFirst, belowLast);
+}
+
+/**
+ * @brief Gets the bytes of a chunk that belong to the given classes.
+ *
+ * @param chunk The chunk to check.
+ * @param classes The CharClass values the bytes can belong to.
+ * @return A bit set for each byte in one of the classes.
+ */
+static uint32_t classBits(__m128i chunk, uint8_t classes) {
+  __m128i accepted = _mm_setzero_si128();
+  if (classes & CHAR_DIGIT) {
+    accepted = _mm_or_si128(accepted, inRange(chunk, '0', '9'));
+  }
+  if (classes & CHAR_ALPHA) {
+    // setting the 0x20 bit turns upper case letters into lower case ones
+    __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    accepted = _mm_or_si128(accepted, inRange(lower, 'a', 'z'));
+  }
+  if (classes & CHAR_FILENAME_SYMBOL) {
+    accepted = _mm_or_si128(accepted,
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('-')));
+    accepted = _mm_or_si128(accepted,
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+    accepted = _mm_or_si128(accepted,
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+  }
+  return (uint32_t)_mm_movemask_epi8(accepted);
+}
+
+size_t find_delimiter(std::string_view buffer, size_t max_len) {
+  size_t limit = std::min(max_len, buffer.length());
+  for (size_t pos = 0; pos < limit; pos += CHUNK_LEN) {
+    __m128i chunk = loadChunk(buffer.data() + pos, limit - pos);
+    __m128i spaces = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    __m128i newlines = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+    uint32_t delimiters =
+        (uint32_t)_mm_movemask_epi8(_mm_or_si128(spaces, newlines)) &
+        chunkBits(limit - pos);
+    if (delimiters != 0) {
+      return pos + (size_t)__builtin_ctz(delimiters);
+    }
+  }
+  return limit;
+}
+
+bool has_only(std::string_view str, uint8_t classes) {
+  for (size_t pos = 0; pos < str.length(); pos += CHUNK_LEN) {
+    uint32_t bits = chunkBits(str.length() - pos);
+    __m128i chunk = loadChunk(str.data() + pos, str.length() - pos);
+    if ((classBits(chunk, classes) & bits) != bits) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#else
+
+/**
+ * @brief Builds the class of every byte value.
+ *
+ * @return The CharClass of every byte, 0 if it belongs to none.
+ */
+static constexpr std::array<uint8_t, 256> buildCharClasses() {
+  std::array<uint8_t, 256> classes = {};
+  for (int c = '0'; c <= '9'; c++) {
+    classes[(size_t)c] = CHAR_DIGIT;
+  }
+  for (int c = 'a'; c <= 'z'; c++) {
+    classes[(size_t)c] = CHAR_ALPHA;
+    classes[(size_t)(c - 'a' + 'A')] = CHAR_ALPHA;
+  }
+  classes['-'] = CHAR_FILENAME_SYMBOL;
+  classes['_'] = CHAR_FILENAME_SYMBOL;
+  classes['.'] = CHAR_FILENAME_SYMBOL;
+  return classes;
+}
+
+static constexpr std::array<uint8_t, 256> charClasses = buildCharClasses();
+
+size_t find_delimiter(std::string_view buffer, size_t max_len) {
+  size_t limit = std::min(max_len, buffer.length());
+  for (size_t i = 0; i < limit; i++) {
+    if (buffer[i] == ' ' || buffer[i] == '\n') {
+      return i;
+    }
+  }
+  return limit;
+}
+
+bool has_only(std::string_view str, uint8_t classes) {
+  for (char c : str) {
+    if ((charClasses[(unsigned char)c] & classes) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
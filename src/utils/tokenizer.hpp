@@ -0,0 +1,43 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Classes of the characters a protocol field can be made of, combined
+ * into the mask of the classes a field accepts.
+ */
+enum CharClass : uint8_t {
+  CHAR_DIGIT = 1 << 0,          // 0-9
+  CHAR_ALPHA = 1 << 1,          // a-z and A-Z
+  CHAR_FILENAME_SYMBOL = 1 << 2 // '-', '_' and '.'
+};
+
+/**
+ * @brief Finds the first field delimiter, a space or a newline, in a buffer.
+ *
+ * Scans 16 bytes at a time with SSE2 when it is available, and one byte at a
+ * time otherwise.
+ *
+ * @param buffer The buffer to scan.
+ * @param max_len The number of bytes to scan at most.
+ * @return The index of the delimiter, or the number of bytes scanned if there
+ * is none.
+ */
+size_t find_delimiter(std::string_view buffer, size_t max_len);
+
+/**
+ * @brief Checks if a string is only made of characters of the given classes.
+ *
+ * Classifies 16 bytes at a time with SSE2 when it is available, and looks
+ * every byte up in a table otherwise.
+ *
+ * @param str The string to check.
+ * @param classes The CharClass values the characters can belong to.
+ * @return True if every character belongs to one of the classes.
+ */
+bool has_only(std::string_view str, uint8_t classes);
+
+#endif
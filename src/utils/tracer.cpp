@@ -0,0 +1,146 @@
+#include "tracer.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "utils.hpp"
+
+Tracer tracer;
+
+thread_local bool traceSampled = false;
+
+// the ring of the thread, and the requests it handled
+static thread_local TraceRing *threadRing = nullptr;
+static thread_local uint32_t requestsSeen = 0;
+
+TraceRing &Tracer::ring() {
+  if (threadRing == nullptr) {
+    // left uninitialized, so only the spans that are recorded are paged in
+    std::unique_ptr<TraceRing> ring(new TraceRing);
+    ring->tid = gettid();
+    threadRing = ring.get();
+    std::lock_guard<std::mutex> guard(ringsLock);
+    rings.push_back(std::move(ring));
+  }
+  return *threadRing;
+}
+
+void Tracer::setSampling(uint32_t oneIn) {
+  sampling.store(oneIn, std::memory_order_relaxed);
+}
+
+bool Tracer::sample() {
+  uint32_t oneIn = sampling.load(std::memory_order_relaxed);
+  return oneIn != 0 && requestsSeen++ % oneIn == 0;
+}
+
+void Tracer::record(const char *name,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end,
+                    std::string_view detail) {
+  using std::chrono::nanoseconds;
+  TraceRing &ring = this->ring();
+  std::lock_guard<std::mutex> guard(ring.lock);
+  TraceEvent &event = ring.events[ring.written++ % TRACE_RING_EVENTS];
+  event.name = name;
+  event.start = (uint64_t)std::chrono::duration_cast<nanoseconds>(
+                    start - started)
+                    .count();
+  event.duration =
+      (uint64_t)std::chrono::duration_cast<nanoseconds>(end - start).count();
+  // the end of a long path, with the name of the file, tells the most
+  size_t length = std::min(detail.length(), sizeof(event.detail) - 1);
+  detail.remove_prefix(detail.length() - length);
+  detail.copy(event.detail, length);
+  event.detail[length] = '\0';
+}
+
+/**
+ * @brief Writes a string as a JSON string.
+ *
+ * @param stream the stream to write to
+ * @param str the string
+ */
+static void writeJsonString(std::ostream &stream, const char *str) {
+  stream << '"';
+  for (; *str != '\0'; str++) {
+    if (*str == '"' || *str == '\\') {
+      stream << '\\' << *str;
+    } else if ((unsigned char)*str < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)*str);
+      stream << escaped;
+    } else {
+      stream << *str;
+    }
+  }
+  stream << '"';
+}
+
+/**
+ * @brief Writes a time in nanoseconds as microseconds, as trace events have
+ * their times in.
+ *
+ * @param stream the stream to write to
+ * @param nanos the time
+ */
+static void writeMicros(std::ostream &stream, uint64_t nanos) {
+  char micros[32];
+  snprintf(micros, sizeof(micros), "%llu.%03u",
+           (unsigned long long)(nanos / 1000), (unsigned)(nanos % 1000));
+  stream << micros;
+}
+
+size_t Tracer::exportJson(const std::string &path) {
+  std::string tmpPath = path + ".tmp";
+  std::ofstream file(tmpPath, std::ios::out | std::ios::trunc);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  pid_t pid = getpid();
+  size_t exported = 0;
+  {
+    std::lock_guard<std::mutex> guard(ringsLock);
+    for (auto &ring : rings) {
+      // copied first, so the thread is only held up for as long as it takes
+      std::vector<TraceEvent> events;
+      {
+        std::lock_guard<std::mutex> ringGuard(ring->lock);
+        uint64_t first = ring->written > TRACE_RING_EVENTS
+                             ? ring->written - TRACE_RING_EVENTS
+                             : 0;
+        for (uint64_t i = first; i < ring->written; i++) {
+          events.push_back(ring->events[i % TRACE_RING_EVENTS]);
+        }
+      }
+
+      for (const auto &event : events) {
+        file << (exported++ == 0 ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(file, event.name);
+        file << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << ring->tid
+             << ",\"ts\":";
+        writeMicros(file, event.start);
+        file << ",\"dur\":";
+        writeMicros(file, event.duration);
+        if (event.detail[0] != '\0') {
+          file << ",\"args\":{\"detail\":";
+          writeJsonString(file, event.detail);
+          file << "}";
+        }
+        file << "}";
+      }
+    }
+  }
+
+  file << "\n]}\n";
+  file.close();
+  if (!file) {
+    delete_file(tmpPath);
+    throw IOException();
+  }
+  rename_file(tmpPath, path); // readers never see a half written trace
+  return exported;
+}
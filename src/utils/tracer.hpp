@@ -0,0 +1,185 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <sys/types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "constants.hpp"
+
+/**
+ * @brief A span of a traced request, as recorded by its thread.
+ */
+struct TraceEvent {
+  const char *name;              // never freed, as string literals
+  uint64_t start;                // nanoseconds since the tracer was started
+  uint64_t duration;             // nanoseconds
+  char detail[TRACE_DETAIL_LEN]; // null terminated, its end if too long
+};
+
+/**
+ * @class TraceRing
+ *
+ * @brief The latest spans recorded by a thread, the oldest being overwritten.
+ */
+class TraceRing {
+public:
+  std::mutex lock; // only contended while the spans are being exported
+  std::array<TraceEvent, TRACE_RING_EVENTS> events;
+  uint64_t written = 0;
+  pid_t tid; // of the thread, as shown by the tools of the system
+};
+
+/**
+ * @class Tracer
+ *
+ * @brief Records the spans of a sample of the requests, in a ring per thread,
+ * and exports them as Chrome trace events, to be opened in chrome://tracing or
+ * Perfetto.
+ *
+ * Only 1 in every few requests of a thread is traced, and the spans of the
+ * others only check a thread local flag, so tracing can stay on.
+ */
+class Tracer {
+  std::mutex ringsLock; // only held to add a ring, or to read the rings
+  std::vector<std::unique_ptr<TraceRing>> rings;
+  std::atomic<uint32_t> sampling{TRACE_SAMPLING_DEFAULT};
+  const std::chrono::steady_clock::time_point started =
+      std::chrono::steady_clock::now();
+
+  /**
+   * @brief Gets the ring of the calling thread, adding it on first use.
+   */
+  TraceRing &ring();
+
+public:
+  /**
+   * @brief Sets how many requests there are for every traced one.
+   *
+   * @param oneIn 1 to trace every request, or 0 to trace none
+   */
+  void setSampling(uint32_t oneIn);
+
+  /**
+   * @brief Decides whether to trace the request the calling thread is about
+   * to handle.
+   *
+   * @return true for 1 in every few requests of the thread
+   */
+  bool sample();
+
+  /**
+   * @brief Records a span in the ring of the calling thread.
+   *
+   * @param name the name of the span, which must never be freed
+   * @param start when the span started
+   * @param end when the span ended
+   * @param detail what the span worked on, such as a path, if anything
+   */
+  void record(const char *name, std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end,
+              std::string_view detail);
+
+  /**
+   * @brief Writes the spans kept by every thread to a file, as Chrome trace
+   * event JSON, replacing it at once.
+   *
+   * @param path the path of the file
+   * @return the number of spans written
+   */
+  size_t exportJson(const std::string &path);
+};
+
+extern Tracer tracer;
+
+// whether the request being handled by the thread is traced
+extern thread_local bool traceSampled;
+
+/**
+ * @class TraceSpan
+ *
+ * @brief Records the time from its construction to its destruction as a span,
+ * if the request being handled by the thread is traced.
+ */
+class TraceSpan {
+  const char *name;
+  std::string_view detail;
+  bool recording;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  /**
+   * @brief Starts a span.
+   *
+   * @param _name the name of the span, which must never be freed
+   * @param _detail what the span works on, which must outlive the span
+   */
+  TraceSpan(const char *_name, std::string_view _detail = {})
+      : name{_name}, detail{_detail}, recording{traceSampled} {
+    if (recording) {
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (recording) {
+      tracer.record(name, start, std::chrono::steady_clock::now(), detail);
+    }
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+};
+
+/**
+ * @class TraceRequest
+ *
+ * @brief The outermost span of a request, which decides whether the spans
+ * made while handling it are recorded.
+ */
+class TraceRequest {
+  bool outer; // whether the thread was already tracing a request
+  TraceSpan span;
+
+  /**
+   * @brief Samples the request, unless it is nested in a traced one.
+   *
+   * @param name the name of the request
+   * @return the name of the request
+   */
+  static const char *begin(const char *name) {
+    if (!traceSampled) {
+      traceSampled = tracer.sample();
+    }
+    return name;
+  }
+
+public:
+  /**
+   * @brief Starts handling a request.
+   *
+   * @param name the name of the request, which must never be freed
+   * @param detail what the request works on, which must outlive the span
+   */
+  TraceRequest(const char *name, std::string_view detail = {})
+      : outer{traceSampled}, span{begin(name), detail} {}
+
+  ~TraceRequest() {
+    if (!outer) {
+      traceSampled = false; // the span was started, so it is still recorded
+    }
+  }
+
+  TraceRequest(const TraceRequest &) = delete;
+  TraceRequest &operator=(const TraceRequest &) = delete;
+};
+
+#endif
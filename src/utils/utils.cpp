@@ -1,13 +1,36 @@
 #include "utils.hpp"
+#include "io_counters.hpp"
+#include "tokenizer.hpp"
+#include "tracer.hpp"
+
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <unordered_map>
 
 // Flag to indicate whether the application is terminating
 bool is_exiting = false;
 
+thread_local IOCounters threadIO;
+
 // Define a map to store file-specific mutexes
 std::unordered_map<std::string, std::mutex> fileMutexMap;
 
+/**
+ * @brief Locks the mutex of a file, tracing how long it was waited for.
+ *
+ * @param path the path of the file
+ * @return the mutex, locked
+ */
+static std::mutex &lockFileMutex(const std::string &path) {
+  TraceSpan traceSpan("fileMutex wait", path);
+  std::mutex &mutex = fileMutexMap[path];
+  mutex.lock();
+  threadIO.locks++;
+  return mutex;
+}
+
 void validate_port_number(const std::string &port_number) {
   // Ensure that the port number is a valid number
   for (char c : port_number) {
@@ -29,25 +52,23 @@ void validate_port_number(const std::string &port_number) {
 }
 
 // check if string has only digits
-bool is_digits(const std::string &str) {
-  size_t len = str.length();
-  for (size_t i = 0; i < len; i++) {
-    if (!std::isdigit(str[i])) {
-      return false;
-    }
-  }
-  return true;
-}
+bool is_digits(std::string_view str) { return has_only(str, CHAR_DIGIT); }
 
 // check if string is alphanumeric
-bool is_alphanumeric(const std::string &str) {
-  size_t len = str.length();
-  for (size_t i = 0; i < len; i++) {
-    if (!std::isalnum(str[i])) {
-      return false;
-    }
-  }
-  return true;
+bool is_alphanumeric(std::string_view str) {
+  return has_only(str, CHAR_DIGIT | CHAR_ALPHA);
+}
+
+/**
+ * @brief Parses a field that was already checked to only have digits.
+ *
+ * @param digits the field to parse, with at most 9 digits
+ * @return the value of the field
+ */
+static uint32_t parseDigits(std::string_view digits) {
+  uint32_t value = 0;
+  std::from_chars(digits.data(), digits.data() + digits.length(), value);
+  return value;
 }
 
 void setup_custom_signal_handlers() {
@@ -94,11 +115,14 @@ std::vector<std::string> parse_args(std::string args) {
 }
 
 void create_new_directory(const std::string &path) {
+  TraceSpan traceSpan("create_new_directory", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (!std::filesystem::exists(path)) {
       std::filesystem::create_directory(path);
+      threadIO.changes++;
       return;
     }
   } catch (...) {
@@ -110,12 +134,16 @@ void create_new_directory(const std::string &path) {
 }
 
 void create_new_file(const std::string &path) {
+  TraceSpan traceSpan("create_new_file", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (!std::filesystem::exists(path)) {
       std::ofstream ofs(path);
       ofs.close();
+      threadIO.opens++;
+      threadIO.changes++;
     }
   } catch (...) {
     // Unlock the mutex in case of an exception
@@ -127,9 +155,12 @@ void create_new_file(const std::string &path) {
 }
 
 void rename_file(const std::string &oldPath, const std::string &newPath) {
+  TraceSpan traceSpan("rename_file", newPath);
   try {
+    threadIO.stats++;
     if (std::filesystem::exists(oldPath)) {
       std::filesystem::rename(oldPath, newPath);
+      threadIO.changes++;
     }
   } catch (...) {
     throw std::exception();
@@ -138,11 +169,14 @@ void rename_file(const std::string &oldPath, const std::string &newPath) {
 }
 
 void delete_file(const std::string &path) {
+  TraceSpan traceSpan("delete_file", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (std::filesystem::exists(path)) {
       std::filesystem::remove(path);
+      threadIO.changes++;
     }
   } catch (...) {
     // Unlock the mutex in case of an exception
@@ -153,11 +187,14 @@ void delete_file(const std::string &path) {
 }
 
 void delete_directory(const std::string &path) {
+  TraceSpan traceSpan("delete_directory", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (std::filesystem::exists(path)) {
       std::filesystem::remove_all(path);
+      threadIO.changes++;
     }
   } catch (...) {
     // Unlock the mutex in case of an exception
@@ -169,9 +206,11 @@ void delete_directory(const std::string &path) {
 }
 
 int8_t directory_exists(const std::string &path) {
+  TraceSpan traceSpan("directory_exists", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (!std::filesystem::exists(path)) {
       return INVALID;
     }
@@ -184,9 +223,11 @@ int8_t directory_exists(const std::string &path) {
 }
 
 int8_t file_exists(const std::string &path) {
+  TraceSpan traceSpan("file_exists", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
+    threadIO.stats++;
     if (!std::filesystem::exists(path)) {
       return INVALID;
     }
@@ -199,12 +240,15 @@ int8_t file_exists(const std::string &path) {
 }
 
 void write_to_file(const std::string &path, const std::string &text) {
+  TraceSpan traceSpan("write_to_file", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
     std::ofstream file(path);
     file << text;
     file.close();
+    threadIO.opens++;
+    threadIO.bytesWritten += text.length();
   } catch (...) {
     // Unlock the mutex in case of an exception
     fileMutexMap[path].unlock();
@@ -214,13 +258,16 @@ void write_to_file(const std::string &path, const std::string &text) {
 
 void read_from_file(const std::string &path, std::string &text) {
 
+  TraceSpan traceSpan("read_from_file", path);
   try {
     // Lock the mutex associated with the file
-    std::lock_guard<std::mutex> lock(fileMutexMap[path]);
+    std::lock_guard<std::mutex> lock(lockFileMutex(path), std::adopt_lock);
     std::ifstream file(path);
+    threadIO.opens++;
     if (file.is_open()) {
       std::getline(file, text, '\0');
       file.close();
+      threadIO.bytesRead += text.length();
     }
   } catch (...) {
     // Unlock the mutex in case of an exception
@@ -229,12 +276,12 @@ void read_from_file(const std::string &path, std::string &text) {
   }
 }
 
-int8_t validateUserID(std::string userID) {
-  if (!is_digits(userID) || userID.length() != USER_ID_LENGTH) {
+int8_t validateUserID(std::string_view userID) {
+  if (userID.length() != USER_ID_LENGTH || !is_digits(userID)) {
     return INVALID;
   }
 
-  uint32_t id = (uint32_t)std::stoi(userID);
+  uint32_t id = parseDigits(userID);
   if (id > USER_ID_MAX) {
     return INVALID;
   }
@@ -242,24 +289,24 @@ int8_t validateUserID(std::string userID) {
   return 0;
 }
 
-int8_t validatePassword(std::string password) {
+int8_t validatePassword(std::string_view password) {
 
-  if (password.length() != 8 || !is_alphanumeric(password)) {
+  if (password.length() != PASSWORD_LENGTH || !is_alphanumeric(password)) {
     return INVALID;
   }
 
   return 0;
 }
 
-int8_t validateAuctionID(std::string auctionID) {
-  if (!is_digits(auctionID) || auctionID.length() != AUCTION_ID_LENGTH) {
+int8_t validateAuctionID(std::string_view auctionID) {
+  if (auctionID.length() != AUCTION_ID_LENGTH || !is_digits(auctionID)) {
     return INVALID;
   }
 
   return 0;
 }
 
-int8_t validateBidValue(std::string bidValue) {
+int8_t validateBidValue(std::string_view bidValue) {
   if (!is_digits(bidValue) || bidValue.length() > START_VALUE_MAX) {
     return INVALID;
   }
@@ -267,16 +314,16 @@ int8_t validateBidValue(std::string bidValue) {
   return 0;
 }
 
-int8_t validateAssetFilename(std::string assetFilename) {
-  if (assetFilename.length() > FILENAME_MAX_LENGTH) {
+int8_t validateAssetFilename(std::string_view assetFilename) {
+  if (assetFilename.length() > FILENAME_MAX_LENGTH ||
+      assetFilename.length() < 4) {
     return INVALID;
   }
 
   // test if chars are either alphanumeric or special chars
-  for (char c : assetFilename) {
-    if (!std::isalnum(c) && c != '-' && c != '_' && c != '.') {
-      return INVALID;
-    }
+  if (!has_only(assetFilename,
+                CHAR_DIGIT | CHAR_ALPHA | CHAR_FILENAME_SYMBOL)) {
+    return INVALID;
   }
 
   // check  if there is an extension
@@ -287,15 +334,15 @@ int8_t validateAssetFilename(std::string assetFilename) {
   return 0;
 }
 
-int8_t validateStartValue(std::string startValue) {
+int8_t validateStartValue(std::string_view startValue) {
   if (!is_digits(startValue) || startValue.length() > START_VALUE_MAX ||
-      std::stoi(startValue) <= 0 || std::stoi(startValue) >= 999999) {
+      parseDigits(startValue) == 0 || parseDigits(startValue) >= 999999) {
     return INVALID;
   }
   return 0;
 }
 
-int8_t validateAuctionDuration(std::string auctionDuration) {
+int8_t validateAuctionDuration(std::string_view auctionDuration) {
   if (!is_digits(auctionDuration) ||
       auctionDuration.length() > AUCTION_DURATION_MAX) {
     return INVALID;
@@ -303,7 +350,7 @@ int8_t validateAuctionDuration(std::string auctionDuration) {
   return 0;
 }
 
-int8_t validateAuctionName(std::string name) {
+int8_t validateAuctionName(std::string_view name) {
   if (name.length() > ASSET_NAME_MAX)
     return INVALID;
 
@@ -323,18 +370,6 @@ int8_t validateFileSize(std::string file_path) {
   return 0;
 }
 
-std::string getUserPassword(std::string userID) {
-  std::string passwordPath = USER_DIR;
-  std::string validPassword;
-  try {
-    passwordPath += SLASH + userID + SLASH + userID + PASS_FILE;
-    read_from_file(passwordPath, validPassword);
-  } catch (...) {
-    throw std::exception();
-  }
-  return validPassword;
-}
-
 std::string getCurrentTimeFormated() {
   // Get the current time point
   auto now = std::chrono::system_clock::now();
@@ -571,6 +606,7 @@ std::vector<std::string> splitOnSeparator(std::string __str, char __separator) {
 void sortAuctionBids(
     std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
         &auctionBids) {
+  TraceSpan traceSpan("sortAuctionBids");
   std::sort(
       auctionBids.begin(), auctionBids.end(),
       [](const std::tuple<std::string, uint32_t, std::string, uint32_t> &a,
@@ -609,6 +645,7 @@ std::pair<std::string, uint32_t> getAuctionEndInfo(std::string auctionID) {
 
 std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t>>
 getAuctionBids(std::string auctionID) {
+  TraceSpan traceSpan("getAuctionBids", auctionID);
   // bids format: UID bid_value bid_datetime bid_sec_time
   std::string auctionPath = AUCTION_DIR + SLASH + auctionID;
   std::string auctionBidsPath = auctionPath + BID_DIR;
@@ -616,6 +653,7 @@ getAuctionBids(std::string auctionID) {
       auctionBids;
   for (const auto &entry :
        std::filesystem::directory_iterator(auctionBidsPath)) {
+    threadIO.dirEntries++;
     if (entry.is_regular_file() && entry.path().extension() == TXT_EXT) {
       std::string bidInfo;
       read_from_file(entry.path(), bidInfo);
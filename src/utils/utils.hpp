@@ -7,6 +7,7 @@
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 #include <vector>
 
 #include "constants.hpp"
@@ -85,7 +86,7 @@ void validate_port_number(const std::string &port_number);
  *
  * @return True if the string contains only digits, false otherwise.
  */
-bool is_digits(const std::string &str);
+bool is_digits(std::string_view str);
 
 /**
  * @brief Checks if a string is alphanumeric.
@@ -94,7 +95,7 @@ bool is_digits(const std::string &str);
  *
  * @return True if the string is alphanumeric, false otherwise.
  */
-bool is_alphanumeric(const std::string &str);
+bool is_alphanumeric(std::string_view str);
 
 /**
  * @brief Parses the given string into a vector of arguments.
@@ -180,55 +181,55 @@ void rename_file(const std::string &oldPath, const std::string &newPath);
  * @brief Validates the user ID from the given string.
  *
  */
-int8_t validateUserID(std::string userID);
+int8_t validateUserID(std::string_view userID);
 
 /**
  *
  * @brief Validate the user password from the given string.
  *
  */
-int8_t validatePassword(std::string password);
+int8_t validatePassword(std::string_view password);
 
 /**
  *
  * @brief Validate the auction ID from the given string.
  *
  */
-int8_t validateAuctionID(std::string auctionId);
+int8_t validateAuctionID(std::string_view auctionId);
 
 /**
  *
  * @brief Validate the bid value from the given string.
  *
  */
-int8_t validateBidValue(std::string bidValue);
+int8_t validateBidValue(std::string_view bidValue);
 
 /**
  *
  * @brief Validate the asset filename from the given string.
  */
-int8_t validateAssetFilename(std::string assetFilename);
+int8_t validateAssetFilename(std::string_view assetFilename);
 
 /**
  *
  * @brief Validate the start value from the given string.
  *
  */
-int8_t validateStartValue(std::string startValue);
+int8_t validateStartValue(std::string_view startValue);
 
 /**
  *
  * @brief Validate the auction duration from the given string.
  *
  */
-int8_t validateAuctionDuration(std::string auctionDuration);
+int8_t validateAuctionDuration(std::string_view auctionDuration);
 
 /**
  *
  * @brief Validate the asset name from the given string.
  *
  */
-int8_t validateAuctionName(std::string assetName);
+int8_t validateAuctionName(std::string_view assetName);
 
 /**
  *
@@ -242,14 +243,6 @@ int8_t validateAssetFileSize(uint32_t assetSize);
  */
 int8_t validateFileSize(std::string file_path);
 
-/**
- * @brief Get the User Password object
- *
- * @param userID ID of the user
- * @return std::string
- */
-std::string getUserPassword(std::string userID);
-
 /**
  * @brief Get the current date and time in a string format of 19B.
  *